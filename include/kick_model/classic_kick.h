@@ -28,6 +28,10 @@ public:
 
   virtual Eigen::Vector2d getKickInSelf(const Eigen::Vector2d& ball_pos, bool right_kick) const override;
 
+  /// Noise sources: player direction, kick direction and kick distance
+  virtual int getNbNoiseSources() const override;
+  virtual Eigen::Vector2d getOutcomeFromQuantiles(const Eigen::VectorXd& quantiles) const override;
+
   Json::Value toJson() const override;
   void fromJson(const Json::Value& v, const std::string& dir_name) override;
   std::string getClassName() const override;
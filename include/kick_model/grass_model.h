@@ -21,6 +21,9 @@ public:
   /// Setting the cone offset [deg]
   void setConeOffset(double cone_offset);
 
+  /// Is the reduction invariant when kick_dir is replaced by -kick_dir
+  bool isSymmetric() const;
+
   Json::Value toJson() const override;
   void fromJson(const Json::Value& v, const std::string& dir_name) override;
   std::string getClassName() const override;
@@ -24,6 +24,10 @@ public:
   /// ball_pos is in field referential [m]
   virtual double computeKickDirection(const Eigen::VectorXd& informations, const Eigen::VectorXd& actions) const = 0;
 
+  /// Return the actions leading to the opposite kick direction when the field
+  /// is mirrored along the y-axis, default is to use the opposite of all actions
+  virtual Eigen::VectorXd mirrorActions(const Eigen::VectorXd& actions) const;
+
 protected:
   /// Limits for the actions
   Eigen::MatrixXd action_limits;
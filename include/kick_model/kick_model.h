@@ -6,10 +6,13 @@
 
 #include <Eigen/Core>
 
+#include <memory>
 #include <random>
 
 namespace csa_mdp
 {
+class KickOutcomeTable;
+
 /// Contains both:
 /// - The predictive model for the kick
 /// - The kickable area model
@@ -59,9 +62,22 @@ public:
                                     const Eigen::VectorXd& kick_parameters,
                                     std::default_random_engine* engine = nullptr) const = 0;
 
-  /// Setting the grass model
+  /// Setting the grass model, drops the outcome table since it is not valid anymore
   virtual void setGrassModel(GrassModel grassModel);
 
+  /// Number of independent noise sources used when applying the kick
+  virtual int getNbNoiseSources() const;
+
+  /// Return the outcome of a noisy kick toward direction 0 without grass
+  /// reduction: (distance [m], direction offset [rad])
+  /// - quantiles: one value in ]0,1[ per noise source
+  /// Throws an error if the kick does not support it
+  virtual Eigen::Vector2d getOutcomeFromQuantiles(const Eigen::VectorXd& quantiles) const;
+
+  /// When a table is set, it is used to draw noisy kicks instead of sampling
+  /// the noise distributions
+  void setOutcomeTable(std::shared_ptr<const KickOutcomeTable> table);
+
   Json::Value toJson() const override;
   void fromJson(const Json::Value& v, const std::string& dir_name) override;
 
@@ -87,6 +103,9 @@ protected:
 
   /// Model of the grass
   GrassModel grassModel;
+
+  /// Pre-sampled outcomes of the kick (might be empty)
+  std::shared_ptr<const KickOutcomeTable> outcome_table;
 };
 
 }  // namespace csa_mdp
@@ -20,16 +20,32 @@ public:
 
   /// Setting the grass cone offset [deg]
   /// Ball is slowed when moving toward offset
+  /// Outcome tables are rebuilt if they are used
   void setGrassConeOffset(double offset);
 
+  /// Are all the kicks symmetric with respect to the kick direction
+  bool isSymmetric() const;
+
   Json::Value toJson() const override;
   void fromJson(const Json::Value& v, const std::string& dir_name) override;
   std::string getClassName() const override;
 
 protected:
+  /// Build the outcome tables of all the kicks if nb_outcome_samples > 0
+  void buildOutcomeTables();
+
   GrassModel grassModel;
 
   std::map<std::string, std::unique_ptr<KickModel>> models;
+
+  /// Number of pre-sampled outcomes for each kick, 0 disables the tables
+  int nb_outcome_samples;
+
+  /// Number of bins used for the grass angular table
+  int outcome_grass_resolution;
+
+  /// Seed used to build the tables, if negative, a random seed is used
+  int outcome_seed;
 };
 
 }  // namespace csa_mdp
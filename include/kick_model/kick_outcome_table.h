@@ -0,0 +1,70 @@
+#pragma once
+
+#include "kick_model/grass_model.h"
+
+#include <Eigen/Core>
+
+#include <random>
+#include <vector>
+
+namespace csa_mdp
+{
+class KickModel;
+
+/// Pre-sampled outcomes of a noisy kick
+///
+/// The displacement of the ball after a kick does not depend on the ball
+/// position except for the grass reduction. Outcomes are therefore stored for a
+/// kick toward direction 0 and rotated toward the wished direction when used,
+/// the grass reduction is read from an angular table.
+///
+/// Outcomes are built from stratified quantiles (latin hypercube) over the
+/// noise sources of the kick model.
+class KickOutcomeTable
+{
+public:
+  KickOutcomeTable();
+
+  /// Build the table for the given model
+  /// - nb_samples: number of outcomes stored
+  /// - grass_resolution: number of bins used on [-pi,pi] for the grass table
+  /// - engine: used to shuffle the strata
+  void build(const KickModel& model, const GrassModel& grass, int nb_samples, int grass_resolution,
+             std::default_random_engine* engine);
+
+  /// Number of outcomes stored
+  int size() const;
+
+  /// Draw an outcome from the table
+  /// - ball_pos: field_basis [m]
+  /// - kick_dir: The desired kick direction in the field_basis [rad]
+  /// @return final position of the ball (field_basis [m])
+  Eigen::Vector2d applyKick(const Eigen::Vector2d& ball_pos, double kick_dir, std::default_random_engine* engine) const;
+
+  /// Inverse of the cumulative distribution function of the standard normal law
+  /// p has to be in ]0,1[
+  static double normalQuantile(double p);
+
+private:
+  /// Ball displacement for a kick toward direction 0
+  struct Outcome
+  {
+    /// Displacement along x [m]
+    double dx;
+    /// Displacement along y [m]
+    double dy;
+    /// Offset between the real direction and the wished direction [rad]
+    double dir_offset;
+  };
+
+  /// All the pre-sampled outcomes, stored contiguously
+  std::vector<Outcome> outcomes;
+
+  /// Grass reduction for directions in [-pi,pi], uniformly discretized
+  std::vector<double> grass_factors;
+
+  /// Number of grass bins per radian
+  double grass_bins_per_rad;
+};
+
+}  // namespace csa_mdp
@@ -33,6 +33,11 @@ public:
   /// Return the theta tolerance [rad]
   double getThetaTol() const;
 
+  /// Return the open box of kick states allowing to kick with the given foot.
+  /// Rows are ball_x, ball_y and kick_wished_dir, columns are min and max. The
+  /// interval for kick_wished_dir is not wrapped and might exceed [-pi, pi]
+  Eigen::Matrix<double, 3, 2> getKickBox(bool right_foot) const;
+
   /// Can the robot shoot with any of the foot?
   bool isKickable(const Eigen::Vector3d& state) const;
 
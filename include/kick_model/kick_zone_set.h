@@ -0,0 +1,54 @@
+#pragma once
+
+#include "kick_model/kick_zone.h"
+
+#include <Eigen/Core>
+
+#include <vector>
+
+namespace csa_mdp
+{
+/// A compiled version of a list of KickZone. Each zone is converted to a set of
+/// open axis-aligned boxes in (ball_x, ball_y, kick_wished_dir), with the
+/// direction wrapped in [-pi, pi]: up to two boxes per foot when the tolerance
+/// crosses the discontinuity.
+///
+/// Boxes are stored as a structure of arrays and membership is tested in a
+/// single branchless pass over all boxes. Results match KickZone::isKickable up
+/// to rounding errors on the boundaries of the zones.
+class KickZoneSet
+{
+public:
+  KickZoneSet();
+
+  void clear();
+
+  /// Append the boxes of both feet for the given zone
+  void add(const KickZone& zone);
+
+  /// Number of zones added
+  int nbZones() const;
+
+  /// state: (ball_x, ball_y, kick_wished_dir) in the robot referential
+  bool isKickable(const Eigen::Vector3d& state) const;
+
+  /// Return the index of the first zone allowing to kick from state, -1 if none
+  int getKickableZone(const Eigen::Vector3d& state) const;
+
+private:
+  /// Add a box to the set, theta bounds should already be wrapped
+  void pushBox(int zone_id, const Eigen::Matrix<double, 3, 2>& box, double box_theta_min, double box_theta_max);
+
+  int nb_zones;
+
+  std::vector<double> x_min;
+  std::vector<double> x_max;
+  std::vector<double> y_min;
+  std::vector<double> y_max;
+  std::vector<double> theta_min;
+  std::vector<double> theta_max;
+  /// Index of the zone to which each box belongs
+  std::vector<int> zone_ids;
+};
+
+}  // namespace csa_mdp
@@ -4,7 +4,10 @@
 
 namespace csa_mdp
 {
-/// Simple model which ought to be updated properly
+/// Ball rolling along a straight line while its speed decays exponentially:
+/// v(t) = v(0) * exp(-(1 - decay_rate) * t)
+/// Propagation is exact, therefore two successive calls with dt are
+/// equivalent to a single call with 2*dt
 /// Ball state: [x,y,vx,vy]
 class RollingBallModel : public rhoban_utils::JsonSerializable
 {
@@ -13,11 +16,35 @@ public:
 
   Eigen::Vector4d getNextState(const Eigen::Vector4d& ball_state, double dt) const;
 
+  /// Derivative of getNextState with respect to ball_state, the model being
+  /// linear it does not depend on the state
+  Eigen::Matrix4d getJacobian(double dt) const;
+
+  /// Return true if the ball reaches the line going through 'point' with the
+  /// given normal before stopping. In this case, time and position are filled
+  /// with the moment and the location of the crossing
+  bool getLineIntercept(const Eigen::Vector4d& ball_state, const Eigen::Vector2d& point, const Eigen::Vector2d& normal,
+                        double* time, Eigen::Vector2d* position) const;
+
+  /// Return true if the ball enters the circle before stopping (or is already
+  /// inside). In this case, time and position are filled with the moment and
+  /// the location of the entry
+  bool getCircleIntercept(const Eigen::Vector4d& ball_state, const Eigen::Vector2d& center, double radius,
+                          double* time, Eigen::Vector2d* position) const;
+
   Json::Value toJson() const override;
   void fromJson(const Json::Value& v, const std::string& dir_name) override;
   std::string getClassName() const override;
 
 private:
+  /// Ratio between the distance traveled after t seconds and the initial speed
+  double getTravelFactor(double t) const;
+
+  /// Time required to reach the given travel factor, negative if the ball
+  /// stops before
+  double getTimeFromTravelFactor(double factor) const;
+
+  /// The ratio of the speed kept is exp(-(1-decay_rate)*t)
   double decay_rate;
 };
 
@@ -50,6 +50,11 @@ public:
   /// Perform a single step
   void doStep();
 
+  /// Feed the learner with the provided sample (expressed in the full state
+  /// space), if use_symmetry is enabled, the mirrored sample is also provided
+  void feedSample(const Eigen::VectorXd& state, const Eigen::VectorXd& action, const Eigen::VectorXd& next_state,
+                  double reward);
+
   /// Init the experiment
   virtual void init();
 
@@ -141,6 +146,10 @@ protected:
   std::ofstream time_logs;
   std::ofstream reward_logs;
 
+  /// If enabled, a mirrored sample is added for each sample fed to the
+  /// learner, the problem has to be a SymmetricProblem
+  bool use_symmetry;
+
   /// Which dimensions of the state space are used as input for learning
   std::vector<int> learning_dimensions;
 
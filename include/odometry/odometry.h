@@ -3,6 +3,7 @@
 #include <random>
 #include <Eigen/Dense>
 #include "odometry/odometry_displacement_model.h"
+#include "odometry/odometry_kernel.h"
 #include "odometry/odometry_noise_model.h"
 
 namespace csa_mdp
@@ -38,6 +39,10 @@ public:
   /// models.
   Eigen::VectorXd getNormalization() const;
 
+  /// Return the min and max bounds of the parameters for displacement and
+  /// noise models (one row per parameter)
+  Eigen::MatrixXd getParametersLimits() const;
+
   /// Print current parameters on standart output
   void printParameters() const;
 
@@ -53,6 +58,17 @@ public:
   /// Sample the difference of position in the robot referential
   Eigen::Vector3d getDiffFullStep(const Eigen::Vector3d& deltaPose, std::default_random_engine* engine) const;
 
+  /// Batch version of getDiffFullStep applied on all the columns of deltaPoses
+  /// (3xN), diffs (3xN) has to be allocated. Noise is drawn in the same order
+  /// as successive calls to getDiffFullStep
+  void getDiffsFullStep(const Eigen::MatrixXd& deltaPoses, std::default_random_engine* engine,
+                        Eigen::MatrixXd* diffs) const;
+
+  /// Log-likelihood of measuring the displacement 'measured' when ordering
+  /// deltaPose, angular error is normalized. Dimensions without noise are
+  /// evaluated with a unit variance
+  double getLogLikelihood(const Eigen::Vector3d& deltaPose, const Eigen::Vector3d& measured) const;
+
   /// Return current corrected odometry state [x,y,theta]
   const Eigen::Vector3d& state() const;
 
@@ -67,9 +83,16 @@ public:
   virtual void fromJson(const Json::Value& v, const std::string& dir_name);
 
 private:
+  /// Rebuild the kernel after a modification of the models
+  void updateKernel();
+
   OdometryDisplacementModel _modelDisplacement;
   OdometryNoiseModel _modelNoise;
 
+  /// Specialized version of the models used to sample displacements, it is
+  /// immutable and therefore shared between copies
+  std::shared_ptr<const OdometryKernel> _kernel;
+
   /// If false, the next update() will initialize internal data to match current
   /// input Model state
   bool _isInitialized;
@@ -50,6 +50,9 @@ public:
   /// Return parameter normalization coefficients
   const Eigen::VectorXd& getNormalization() const;
 
+  /// Return the min and max bounds of the parameters (one row per parameter)
+  Eigen::MatrixXd getParametersLimits() const;
+
   /// Correct and return given relative displacement [dX,dY,dTheta] using
   /// current model parameters.
   Eigen::Vector3d displacementCorrection(const Eigen::Vector3d& diff) const;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "odometry/odometry_displacement_model.h"
+#include "odometry/odometry_noise_model.h"
+
+#include <Eigen/Core>
+
+#include <memory>
+#include <random>
+
+namespace csa_mdp
+{
+/// Computes the displacement of the robot for a full step with both the
+/// displacement correction and the noise generation.
+///
+/// Kernels are specialized for each pair of displacement and noise types when
+/// they are built, parameters are then stored in fixed-size arrays and no type
+/// dispatch happens when sampling
+class OdometryKernel
+{
+public:
+  virtual ~OdometryKernel();
+
+  /// Sample the corrected and noisy displacement for the given order, noise is
+  /// disabled if engine is null
+  virtual Eigen::Vector3d getDiff(const Eigen::Vector3d& delta_pose, std::default_random_engine* engine) const = 0;
+
+  /// Batch version of getDiff applied on all the columns of delta_poses (3xN),
+  /// diffs (3xN) has to be allocated. The normal samples of all the columns are
+  /// drawn at once, in the same order as successive calls to getDiff
+  virtual void getDiffs(const Eigen::MatrixXd& delta_poses, std::default_random_engine* engine,
+                        Eigen::MatrixXd* diffs) const = 0;
+
+  /// Build the kernel corresponding to the current types and parameters of the
+  /// models
+  static std::unique_ptr<OdometryKernel> build(const OdometryDisplacementModel& displacement,
+                                               const OdometryNoiseModel& noise);
+};
+
+}  // namespace csa_mdp
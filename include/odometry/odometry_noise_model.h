@@ -47,10 +47,18 @@ public:
   /// Return parameter normalization coefficients
   const Eigen::VectorXd& getNormalization() const;
 
+  /// Return the min and max bounds of the parameters (one row per parameter),
+  /// parameters also have to be strictly positive
+  Eigen::MatrixXd getParametersLimits() const;
+
   /// Generate a gaussian noise over [dX,dY,dTheta] given displacement from
   /// given random engine and using current model parameters.
   Eigen::Vector3d noiseGeneration(const Eigen::Vector3d& diff, std::default_random_engine& engine) const;
 
+  /// Return the variance of the noise generated over [dX,dY,dTheta] for the
+  /// given displacement, noise is independent along each dimension
+  Eigen::Vector3d getVariance(const Eigen::Vector3d& diff) const;
+
   /// Print current parameters on standard output
   void printParameters() const;
 
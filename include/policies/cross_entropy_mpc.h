@@ -0,0 +1,110 @@
+#pragma once
+
+#include "rhoban_csa_mdp/core/policy.h"
+#include "rhoban_csa_mdp/core/problem.h"
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+
+namespace csa_mdp
+{
+/// An anytime model predictive controller for any problem of the factory
+///
+/// Sequences of 'look_ahead' actions (all using 'action_id') are optimized
+/// with the cross-entropy method: at each generation, a population of plans is
+/// sampled from a diagonal gaussian, each plan is evaluated by averaging the
+/// discounted reward of 'rollouts_per_sample' rollouts and the gaussian is
+/// fitted on the best plans.
+///
+/// - Plans are evaluated in parallel, each thread uses its own copy of the
+///   problem, built from the same configuration.
+/// - The best plan of the previous decision, shifted by one step, is used as
+///   the initial mean and as a member of the first population if the state
+///   received is close to the state predicted by the model.
+/// - Generations stop when the time budget is consumed, plans not evaluated
+///   before the deadline are ignored. The first action of the best plan
+///   evaluated is returned.
+///
+/// Decisions requested concurrently are computed one after the other.
+///
+/// The JSON configuration uses the same 'planner' block as LPPI.
+class CrossEntropyMPC : public csa_mdp::Policy
+{
+public:
+  CrossEntropyMPC();
+  ~CrossEntropyMPC();
+
+  Eigen::VectorXd getRawAction(const Eigen::VectorXd& state,
+                               std::default_random_engine* external_engine) const override;
+
+  /// Write the distribution of the time spent in getRawAction, this is also
+  /// done at destruction if 'report_latency' is enabled
+  void writeLatencyReport(std::ostream& out) const;
+
+  std::string getClassName() const override;
+  Json::Value toJson() const override;
+  void fromJson(const Json::Value& v, const std::string& dir_name) override;
+
+private:
+  /// Average discounted reward obtained when applying 'plan' from 'state'
+  /// - plan: one column per step
+  double evaluatePlan(const Problem& model, const Eigen::VectorXd& state, const Eigen::MatrixXd& plan,
+                      std::default_random_engine* engine) const;
+
+  /// One problem per thread, problems are not required to be thread-safe
+  std::vector<std::unique_ptr<csa_mdp::Problem>> problems;
+
+  /// Time allowed for each decision [s], at least one plan per thread is
+  /// evaluated
+  double time_budget;
+
+  /// Number of threads used to evaluate plans
+  int nb_threads;
+
+  /// The action used for all the steps of the plans
+  int action_id;
+
+  /// Length of the plans
+  int look_ahead;
+
+  /// Number of rollouts used to evaluate each plan
+  int rollouts_per_sample;
+
+  /// Discount used to evaluate the plans
+  double discount;
+
+  /// Cross-entropy parameters
+  int nb_generations;
+  int population_size;
+  int best_set_size;
+
+  /// Maximal distance between the state received and the state predicted to
+  /// use the previous plan as initial mean
+  double warm_start_tolerance;
+
+  /// Initial and minimal standard deviation, relative to the size of the
+  /// action space
+  double initial_stddev_ratio;
+  double min_stddev_ratio;
+
+  /// Is the latency report written on the standard output at destruction
+  bool report_latency;
+
+  /// Best plan of the last decision
+  mutable Eigen::MatrixXd previous_plan;
+
+  /// Average successor predicted by the model after the last decision
+  mutable Eigen::VectorXd expected_state;
+
+  /// Duration of all the decisions [s]
+  mutable std::vector<double> latencies;
+
+  /// Protects previous_plan, expected_state and latencies
+  mutable std::mutex mutex;
+
+  /// Held during a whole decision, problems are used by a single decision
+  mutable std::mutex decision_mutex;
+};
+
+}  // namespace csa_mdp
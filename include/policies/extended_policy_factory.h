@@ -0,0 +1,14 @@
+#pragma once
+
+#include "rhoban_csa_mdp/core/policy_factory.h"
+
+namespace csa_mdp
+{
+class ExtendedPolicyFactory : public csa_mdp::PolicyFactory
+{
+public:
+  /// Needs to be called to allow using additionnal Policies
+  static void registerExtraPolicies();
+};
+
+}  // namespace csa_mdp
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "problems/differentiable_problem.h"
+
+#include "rhoban_csa_mdp/core/policy.h"
+#include "rhoban_csa_mdp/core/problem.h"
+
+#include <chrono>
+#include <mutex>
+
+namespace csa_mdp
+{
+/// A model predictive controller using iterative LQR on a DifferentiableProblem
+///
+/// The actions over the next 'horizon' steps are optimized with respect to a
+/// quadratic cost around 'target_state' (weights are diagonal):
+/// sum_t 0.5 * (|x_t - x*|_Q^2 + |u_t|_R^2) + 0.5 * |x_T - x*|_Qf^2
+///
+/// At each iteration, the noise-free dynamics are linearized along the current
+/// trajectory, the LQR problem obtained is solved with a Levenberg-Marquardt
+/// regularization and the resulting feedback policy is applied with a
+/// backtracking line search. Actions are clamped to the limits of the problem.
+/// Differences along 'angular_dims' are normalized in [-pi, pi] in the cost
+/// and its gradient.
+///
+/// Iterations stop when the time budget is consumed. The solution is shifted
+/// by one step and used as the initial guess of the next decision if the state
+/// received matches the state predicted.
+class ILQRPolicy : public csa_mdp::Policy
+{
+public:
+  ILQRPolicy();
+
+  Eigen::VectorXd getRawAction(const Eigen::VectorXd& state,
+                               std::default_random_engine* external_engine) const override;
+
+  /// Optimize the sequence of actions starting from 'state', 'actions' is used
+  /// as initial guess and contains the result. Return the cost of the final
+  /// trajectory
+  double optimize(const Eigen::VectorXd& state, const std::chrono::steady_clock::time_point& deadline,
+                  std::vector<Eigen::VectorXd>* actions) const;
+
+  /// Cost of the trajectory obtained by applying 'actions' from 'state', the
+  /// visited states are stored in 'states' (horizon + 1 elements)
+  double rollout(const Eigen::VectorXd& state, const std::vector<Eigen::VectorXd>& actions,
+                 std::vector<Eigen::VectorXd>* states) const;
+
+  std::string getClassName() const override;
+  Json::Value toJson() const override;
+  void fromJson(const Json::Value& v, const std::string& dir_name) override;
+
+private:
+  /// Compute the feedforward terms k and the feedback gains K, return false if
+  /// the regularized hessian of the actions is not positive definite
+  bool backwardPass(const std::vector<Eigen::VectorXd>& states, const std::vector<Eigen::VectorXd>& actions,
+                    const std::vector<Eigen::MatrixXd>& state_jacobians,
+                    const std::vector<Eigen::MatrixXd>& action_jacobians, double regularization,
+                    std::vector<Eigen::VectorXd>* k, std::vector<Eigen::MatrixXd>* K) const;
+
+  /// Apply u_t = actions_t + alpha * k_t + K_t * (x_t - states_t) and return
+  /// the cost of the new trajectory
+  double forwardPass(const std::vector<Eigen::VectorXd>& states, const std::vector<Eigen::VectorXd>& actions,
+                     const std::vector<Eigen::VectorXd>& k, const std::vector<Eigen::MatrixXd>& K, double alpha,
+                     std::vector<Eigen::VectorXd>* new_states, std::vector<Eigen::VectorXd>* new_actions) const;
+
+  /// Difference between two states, angular dimensions are normalized
+  Eigen::VectorXd getStateDiff(const Eigen::VectorXd& state, const Eigen::VectorXd& reference) const;
+
+  double getStageCost(const Eigen::VectorXd& state, const Eigen::VectorXd& action) const;
+  double getFinalCost(const Eigen::VectorXd& state) const;
+
+  /// Clamp the action inside the limits of the problem
+  Eigen::VectorXd boundAction(const Eigen::VectorXd& action) const;
+
+  std::unique_ptr<csa_mdp::Problem> problem;
+
+  /// Access to the model of the problem
+  const DifferentiableProblem* model;
+
+  /// Number of steps of the trajectories
+  int horizon;
+
+  /// Time allowed for each decision [s], at least one iteration is performed
+  double time_budget;
+
+  /// Maximal number of iterations for each decision (negative: no limit)
+  int max_iterations;
+
+  /// Optimization stops when the cost decreases by less than this value
+  double min_improvement;
+
+  /// Maximal distance between the state received and the state predicted to
+  /// use the previous solution as initial guess
+  double warm_start_tolerance;
+
+  /// Indices of the state dimensions which are angles [rad]
+  std::vector<int> angular_dims;
+
+  Eigen::VectorXd target_state;
+  Eigen::VectorXd state_weights;
+  Eigen::VectorXd final_weights;
+  Eigen::VectorXd action_weights;
+
+  /// Shifted solution of the last decision
+  mutable std::vector<Eigen::VectorXd> previous_actions;
+
+  /// State expected after the last decision
+  mutable Eigen::VectorXd expected_state;
+
+  mutable std::mutex warm_start_mutex;
+};
+
+}  // namespace csa_mdp
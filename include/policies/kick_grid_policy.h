@@ -0,0 +1,67 @@
+#pragma once
+
+#include "rhoban_csa_mdp/core/policy.h"
+
+namespace csa_mdp
+{
+/// A tabular policy for the KickControler problem without players, the state
+/// being (ball_x, ball_y). The field is discretized uniformly and an action and
+/// a value are associated to each cell.
+///
+/// Tables are stored as csv files:
+/// - First line: x_min,x_max,nb_cells_x,y_min,y_max,nb_cells_y
+/// - Then one line per cell: cell_x,cell_y,value,action_id,param_0,...
+class KickGridPolicy : public csa_mdp::Policy
+{
+public:
+  KickGridPolicy();
+
+  Eigen::VectorXd getRawAction(const Eigen::VectorXd& state,
+                               std::default_random_engine* external_engine) const override;
+
+  /// Set the discretization of the field, all cells are reset
+  /// - limits: row 0 is ball_x, row 1 is ball_y
+  void setGrid(const Eigen::MatrixXd& limits, int nb_cells_x, int nb_cells_y);
+
+  int getNbCells() const;
+
+  /// Return the index of the cell containing the ball, positions outside of the
+  /// grid are associated to the closest cell
+  int getCellIndex(double ball_x, double ball_y) const;
+
+  /// Return the center of the given cell (ball_x, ball_y)
+  Eigen::Vector2d getCellCenter(int cell) const;
+
+  /// Return the value associated to the cell containing the ball
+  double getValue(const Eigen::VectorXd& state) const;
+
+  void setCell(int cell, double value, const Eigen::VectorXd& action);
+
+  /// Write the table to the given csv file
+  void save(const std::string& path) const;
+
+  /// Read the table from the given csv file
+  void load(const std::string& path);
+
+  std::string getClassName() const override;
+  Json::Value toJson() const override;
+  void fromJson(const Json::Value& v, const std::string& dir_name) override;
+
+private:
+  /// Path of the csv file containing the table
+  std::string table_path;
+
+  /// row 0 is ball_x, row 1 is ball_y
+  Eigen::MatrixXd limits;
+
+  int nb_cells_x;
+  int nb_cells_y;
+
+  /// Values of the cells, index is cell_x + nb_cells_x * cell_y
+  std::vector<double> values;
+
+  /// Actions of the cells, index is cell_x + nb_cells_x * cell_y
+  std::vector<Eigen::VectorXd> actions;
+};
+
+}  // namespace csa_mdp
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "problems/kick_controler.h"
+
+#include "rhoban_csa_mdp/core/policy.h"
+
+namespace csa_mdp
+{
+/// An online planner for the KickControler problem
+///
+/// Candidate actions are built for every action_id (couple of kicker and kick
+/// option) by discretizing uniformly the parameters of the kick decision model.
+/// Candidates are evaluated by Monte Carlo rollouts of KickControler::getSuccessor
+/// and successive halving is used: at each round, the worst half of the
+/// candidates is dropped and the number of rollouts per candidate is doubled.
+///
+/// If a rollout_policy is provided, the value of non-terminal successors is
+/// estimated by following this policy up to 'horizon' steps.
+class KickLookahead : public csa_mdp::Policy
+{
+public:
+  KickLookahead();
+
+  Eigen::VectorXd getRawAction(const Eigen::VectorXd& state,
+                               std::default_random_engine* external_engine) const override;
+
+  /// Return all the candidate actions
+  std::vector<Eigen::VectorXd> getCandidates() const;
+
+  /// Estimate the value of all candidates for the given state using successive
+  /// halving, return the index of the best candidate
+  int getBestCandidate(const Eigen::VectorXd& state, const std::vector<Eigen::VectorXd>& candidates,
+                       std::default_random_engine* engine) const;
+
+  /// Sample the reward of applying 'action' in 'state'
+  double sampleReward(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
+                      std::default_random_engine* engine) const;
+
+  std::string getClassName() const override;
+  Json::Value toJson() const override;
+  void fromJson(const Json::Value& v, const std::string& dir_name) override;
+
+private:
+  std::unique_ptr<csa_mdp::KickControler> problem;
+
+  /// Policy used to estimate the value of the successors (optional)
+  std::unique_ptr<csa_mdp::Policy> rollout_policy;
+
+  /// Number of values used for each dimension of the kick parameters
+  int nb_values_per_dim;
+
+  /// Number of rollouts per candidate at first round
+  int initial_rollouts;
+
+  /// Maximal number of steps for the rollouts following the kick
+  int horizon;
+
+  /// Discount applied to the value of the successors
+  double discount;
+
+  /// Number of threads used to evaluate candidates
+  int nb_threads;
+};
+
+}  // namespace csa_mdp
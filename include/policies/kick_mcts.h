@@ -0,0 +1,91 @@
+#pragma once
+
+#include "problems/kick_controler.h"
+
+#include "rhoban_csa_mdp/core/policy.h"
+
+#include <chrono>
+
+namespace csa_mdp
+{
+/// A Monte Carlo Tree Search planner for the KickControler problem
+///
+/// - Double progressive widening is used to handle both the continuous
+///   parameters of the kicks and the stochastic transitions: a node visited n
+///   times has at most ceil(k * n^alpha) children.
+/// - Root parallelism: each thread builds its own tree until the time budget is
+///   consumed. Actions at the root are generated from a shared seed in order to
+///   be identical for all trees, statistics of the root actions are merged and
+///   the most visited action is chosen.
+/// - The value of new nodes is estimated with rollouts of a default policy
+///   (OKSeed if no rollout_policy is provided). The action of the rollout policy
+///   is always the first action considered in a node.
+class KickMCTS : public csa_mdp::Policy
+{
+public:
+  KickMCTS();
+  ~KickMCTS();
+
+  Eigen::VectorXd getRawAction(const Eigen::VectorXd& state,
+                               std::default_random_engine* external_engine) const override;
+
+  std::string getClassName() const override;
+  Json::Value toJson() const override;
+  void fromJson(const Json::Value& v, const std::string& dir_name) override;
+
+private:
+  class StateNode;
+  class ActionNode;
+
+  /// Run iterations on the tree until deadline or max_iterations is reached
+  /// - root_seed: seed used to generate the actions of the root
+  void growTree(StateNode* root, unsigned long root_seed, const std::chrono::steady_clock::time_point& deadline,
+                std::default_random_engine* engine) const;
+
+  /// Run one iteration from the given node and return the sampled value
+  /// - actions_engine: engine used to generate new actions in this node
+  double simulate(StateNode* node, int depth, std::default_random_engine* actions_engine,
+                  std::default_random_engine* engine) const;
+
+  /// Generate a new candidate action for the given node
+  Eigen::VectorXd generateAction(const StateNode& node, std::default_random_engine* engine) const;
+
+  /// Estimate the value of a state using the rollout policy
+  double rollout(const Eigen::VectorXd& state, std::default_random_engine* engine) const;
+
+  std::unique_ptr<csa_mdp::KickControler> problem;
+
+  /// Policy used to estimate the value of new nodes
+  std::unique_ptr<csa_mdp::Policy> rollout_policy;
+
+  /// Time allowed for each decision [s]
+  double time_budget;
+
+  /// Maximal number of iterations for each tree (negative: no limit)
+  int max_iterations;
+
+  /// Number of trees built in parallel
+  int nb_threads;
+
+  /// Maximal depth of the tree
+  int max_depth;
+
+  /// Number of steps for the rollouts
+  int rollout_horizon;
+
+  /// Discount factor
+  double discount;
+
+  /// Exploration constant for UCB (should be of the order of the rewards)
+  double exploration;
+
+  /// Progressive widening on actions: ceil(k * n^alpha)
+  double action_widening_k;
+  double action_widening_alpha;
+
+  /// Progressive widening on successors: ceil(k * n^alpha)
+  double state_widening_k;
+  double state_widening_alpha;
+};
+
+}  // namespace csa_mdp
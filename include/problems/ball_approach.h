@@ -1,6 +1,8 @@
 #pragma once
 
 #include "kick_model/kick_zone.h"
+#include "kick_model/kick_zone_set.h"
+#include "problems/symmetric_problem.h"
 
 #include "rhoban_csa_mdp/core/black_box_problem.h"
 
@@ -29,31 +31,68 @@ namespace csa_mdp
 /// - last_step_x
 /// - last_step_y
 /// - last_step_theta
-class BallApproach : public BlackBoxProblem
+///
+/// The problem is symmetric with respect to the x-axis of the robot when the
+/// odometry displacement model does not introduce lateral offsets
+class BallApproach : public BlackBoxProblem, public SymmetricProblem
 {
 public:
+  /// State with a fixed size used by the allocation-free kernel
+  typedef Eigen::Matrix<double, 6, 1> FixedState;
+
   BallApproach();
 
   void clearKickZones();
   void addKickZone(const KickZone& kz);
 
   bool isTerminal(const Eigen::VectorXd& state) const;
+  bool isTerminal(const FixedState& state) const;
 
   double getReward(const Eigen::VectorXd& state, const Eigen::VectorXd& action, const Eigen::VectorXd& dst) const;
+  /// The reward only depends on the state reached
+  double getReward(const FixedState& dst) const;
 
+  /// Dispatch to step
   Problem::Result getSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                                std::default_random_engine* engine) const override;
 
+  /// Allocation-free version of getSuccessor, action does not contain the
+  /// action_id: (d_step_x, d_step_y, d_step_theta). successor might alias state
+  void step(const FixedState& state, const Eigen::Vector3d& action, std::default_random_engine* engine,
+            FixedState* successor, double* reward, bool* terminal) const;
+
+  /// Batch version of getSuccessor applied on all the columns of the inputs
+  /// - states: 6xN, actions: 4xN (first row is ignored)
+  /// - successors (6xN), rewards (N) and terminal (N) have to be allocated
+  /// - strict: if enabled, results are bitwise identical to getSuccessor with
+  ///   the same engine. Otherwise, the odometry noise of all the columns is
+  ///   drawn in a single batch and sin/cos use sinCos (vectorized with AVX2),
+  ///   atan2 and the reward remain scalar
+  /// Noise is drawn in the same order in both modes
+  void getSuccessors(const Eigen::MatrixXd& states, const Eigen::MatrixXd& actions, std::default_random_engine* engine,
+                     Eigen::MatrixXd* successors, Eigen::VectorXd* rewards, Eigen::Array<bool, -1, 1>* terminal,
+                     bool strict = false) const;
+
   Eigen::VectorXd getStartingState(std::default_random_engine* engine) const override;
 
   /// Is the ball kickable
   bool isKickable(const Eigen::VectorXd& state) const;
+  bool isKickable(const FixedState& state) const;
   /// Is the robot colliding with the ball
   bool isColliding(const Eigen::VectorXd& state) const;
+  bool isColliding(const FixedState& state) const;
   /// Is the ball outside of the given limits
   bool isOutOfSpace(const Eigen::VectorXd& state) const;
+  bool isOutOfSpace(const FixedState& state) const;
   /// Can the robot see the ball?
   bool seeBall(const Eigen::VectorXd& state) const;
+  bool seeBall(const FixedState& state) const;
+
+  bool hasSymmetry() const override;
+  /// Opposite values for ball_dir, target_angle, last_step_y and last_step_theta
+  Eigen::VectorXd mirrorState(const Eigen::VectorXd& state) const override;
+  /// Opposite values for dstep_y and dstep_theta
+  Eigen::VectorXd mirrorAction(const Eigen::VectorXd& action) const override;
 
   Json::Value toJson() const override;
   void fromJson(const Json::Value& v, const std::string& dir_name) override;
@@ -91,9 +130,15 @@ protected:
   double max_step_y_diff;
   double max_step_theta_diff;
 
+  /// Copies of the state and action limits used by the kernel
+  Eigen::Matrix<double, 6, 2> fixed_state_limits;
+  Eigen::Matrix<double, 3, 2> fixed_action_limits;
+
   // KICK PROPERTIES
   /// There might be several zones for kicking
   std::vector<KickZone> kick_zones;
+  /// Compiled version of kick_zones used to test if states are kickable
+  KickZoneSet compiled_kick_zones;
 
   /// Reward received when inside a kick position
   double kick_reward;
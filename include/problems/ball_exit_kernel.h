@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+
+namespace csa_mdp
+{
+/// Detects the events ending the motion of the ball from 'src' to 'dst' on the
+/// field: collision with the goalie, goal or exit of the field.
+///
+/// Segments can be processed by batch, in this case the arrays are processed
+/// with AVX2 instructions if available (scalar implementation otherwise).
+/// Processing does not require any allocation.
+class BallExitKernel
+{
+public:
+  /// The event ending the motion of the ball (priority follows order)
+  enum Event : uint8_t
+  {
+    None = 0,
+    GoalieCollision = 1,
+    Goal = 2,
+    Out = 3
+  };
+
+  BallExitKernel();
+
+  /// Set the properties of the field [m]
+  void setField(double field_length, double field_width, double goal_width, double ball_radius);
+
+  /// Set the properties of the goalie [m]
+  void setGoalie(bool use_goalie, double goalie_x, double goalie_y, double goalie_thickness, double goalie_width);
+
+  /// Examine the result of moving the ball from 'src' to 'dst'
+  /// If the ball collides with the goalie or enters the goal, dst is updated
+  Event process(double src_x, double src_y, double* dst_x, double* dst_y) const;
+
+  /// Batch version of process, dst_x and dst_y are updated in place and the
+  /// event of each segment is written in events, (all arrays have size n)
+  void process(int n, const double* src_x, const double* src_y, double* dst_x, double* dst_y, Event* events) const;
+
+private:
+  /// Is the given move colliding the goalie ?
+  /// if colliding: return true and modifies dst_x and dst_y
+  bool isCollidingGoalie(double src_x, double src_y, double* dst_x, double* dst_y) const;
+
+  /// Is the given kick resulting with a goal?
+  /// If goal: return true and modifies dst_x and dst_y
+  bool isGoal(double src_x, double src_y, double* dst_x, double* dst_y) const;
+
+  /// Is the ball outside of the field after the given kick
+  bool isOut(double dst_x, double dst_y) const;
+
+  /// Process segments by groups of 4 using AVX2 instructions (if available)
+  /// Return the number of segments processed
+  int processAVX2(int n, const double* src_x, const double* src_y, double* dst_x, double* dst_y,
+                  Event* events) const;
+
+  /// Update the bounds of the goalie from its properties and the ball radius
+  void updateGoalieBounds();
+
+  /// Is goalie collision activated ?
+  bool use_goalie;
+
+  /// Goalie properties [m]
+  double goalie_x, goalie_y, goalie_thickness, goalie_width;
+
+  /// Ball radius [m]
+  double ball_radius;
+
+  /// Goalie bounds including ball radius [m]
+  double min_goalie_x, max_goalie_x, min_goalie_y, max_goalie_y;
+
+  /// Position of the goal line [m]
+  double goal_line_x;
+
+  /// The ball has to entirely cross this line to enter the goal [m]
+  double goal_limit_x;
+
+  /// Half of the goal width [m]
+  double goal_half_width;
+
+  /// Field bounds including ball radius [m]
+  double min_field_x, max_field_x, min_field_y, max_field_y;
+};
+
+}  // namespace csa_mdp
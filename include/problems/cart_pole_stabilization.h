@@ -1,5 +1,7 @@
 #pragma once
 
+#include "utils/ode_integrator.h"
+
 #include "rhoban_csa_mdp/core/black_box_problem.h"
 
 #include <Eigen/Core>
@@ -38,6 +40,9 @@ public:
 
   CartPoleStabilization();
 
+  /// Update state and action limits according to the parameters
+  void updateLimits();
+
   std::vector<int> getLearningDimensions() const override;
 
   bool isTerminal(const Eigen::VectorXd& state) const;
@@ -59,6 +64,9 @@ protected:
   Eigen::VectorXd getFullSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                                    std::default_random_engine* engine) const;
 
+  /// Derivative of [theta omega] when applying 'torque'
+  Eigen::Vector2d getDerivative(const Eigen::Vector2d& state, double torque) const;
+
   // Entry is dimension 2, output is dimension 2
   Eigen::VectorXd getAngularSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                                       std::default_random_engine* engine) const;
@@ -81,20 +89,20 @@ protected:
 private:
   LearningSpace learning_space;
 
-  // TODO transform those parameters in member variables, accessible through xml
+  /// Integration of the dynamics during a simulation step
+  OdeIntegrator integrator;
 
   // Problem properties
-  static double integration_step;  //[s]
-  static double simulation_step;   //[s] Also called controlStep
-  static double pendulum_mass;     //[kg] Mass of the pendulum
-  static double cart_mass;         //[kg] Mass of the cart
-  static double pendulum_length;   //[m] length of the pendulum
-  static double g;                 //[m/s^2]
+  double simulation_step;  //[s] Also called controlStep
+  double pendulum_mass;    //[kg] Mass of the pendulum
+  double cart_mass;        //[kg] Mass of the cart
+  double pendulum_length;  //[m] length of the pendulum
+  double gravity;          //[m/s^2]
   /// State space parameters
-  static double theta_max;  // Above this values, task is considered as failed
-  static double omega_max;
-  static double action_max;
-  static double noise_max;  // Uniform noise in [-noise_max,+noise_max] is applied at each step
+  double theta_max;  // Above this values, task is considered as failed
+  double omega_max;
+  double action_max;
+  double noise_max;  // Uniform noise in [-noise_max,+noise_max] is applied at each step
 
   LearningSpace loadLearningSpace(const std::string& str);
 };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Eigen/Core>
+
+namespace csa_mdp
+{
+/// Interface for problems with a single action whose transitions are
+/// differentiable once the noise is removed. This allows gradient-based
+/// planners to use the model directly.
+class DifferentiableProblem
+{
+public:
+  virtual ~DifferentiableProblem()
+  {
+  }
+
+  /// Return the successor of 'state' when applying 'action' without noise.
+  /// 'action' contains only the parameters of the action (no action_id).
+  /// If provided, state_jacobian and action_jacobian are filled with the
+  /// derivatives of the successor with respect to state and action
+  virtual Eigen::VectorXd getDeterministicSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
+                                                    Eigen::MatrixXd* state_jacobian,
+                                                    Eigen::MatrixXd* action_jacobian) const = 0;
+};
+
+}  // namespace csa_mdp
@@ -28,6 +28,14 @@ public:
   Problem::Result getSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                                std::default_random_engine* engine) const override;
 
+  /// Batch version of getSuccessor applied on all the columns of the inputs
+  /// - states: 2xN, actions: 2xN
+  /// - successors (2xN), rewards (N) and terminal (N) have to be allocated
+  /// Noise is drawn in the same order as successive calls to getSuccessor with
+  /// the same engine, therefore results only differ by rounding errors
+  void getSuccessors(const Eigen::MatrixXd& states, const Eigen::MatrixXd& actions, std::default_random_engine* engine,
+                     Eigen::MatrixXd* successors, Eigen::VectorXd* rewards, Eigen::Array<bool, -1, 1>* terminal) const;
+
   Eigen::VectorXd getStartingState(std::default_random_engine* engine) const override;
 
   Json::Value toJson() const override;
@@ -35,8 +43,25 @@ public:
   std::string getClassName() const override;
 
 private:
+  /// Acceleration applied during the step, including noise
+  double getAcceleration(double cmd, std::default_random_engine* engine) const;
+
+  /// Shared by isTerminal and getSuccessors
+  bool isTerminal(double pos, double vel) const;
+
+  /// Shared by getReward and getSuccessors
+  double getReward(double pos, double acc, bool terminal) const;
+
   /// Is the state random or is it determinist?
   bool random_start;
+
+  /// Duration of a step [s]
+  double simulation_step;
+
+  /// Exact discretization of the dynamics for a constant acceleration:
+  /// successor = transition * state + input * acc
+  Eigen::Matrix2d transition;
+  Eigen::Vector2d input;
 };
 
 }  // namespace csa_mdp
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "problems/ball_approach.h"
+#include "problems/ball_exit_kernel.h"
+#include "problems/symmetric_problem.h"
 #include "kick_model/kick_decision_model.h"
 #include "kick_model/kick_model_collection.h"
+#include "kick_model/kick_zone_set.h"
+#include "utils/lazy_approximator.h"
 
 #include "rhoban_csa_mdp/core/black_box_problem.h"
 #include "rhoban_csa_mdp/core/policy.h"
@@ -52,9 +56,49 @@ namespace csa_mdp
 /// 6. If *ball_final* is outside of the field, the same process as in 2. is used
 ///
 /// DISCLAIMER: using the simulate_approaches is currently unsupported
-class KickControler : public BlackBoxProblem
+///
+/// SYMMETRY:
+/// When the goalie is centered and the grass does not favor one side, the
+/// problem is symmetric with respect to the x-axis of the field. Approaches are
+/// then required to be approximated (simulate_approaches disabled) without
+/// approach_steps_approximator: the approximator is not guaranteed to be
+/// symmetric and the kicker always targets its left foot position when it is
+/// used.
+class KickControler : public BlackBoxProblem, public SymmetricProblem
 {
 public:
+  /// Approach policy of a player or of a kick option, built once the action
+  /// limits of its owner are known.
+  ///
+  /// Policies might keep a state between calls (e.g. warm start of
+  /// CrossEntropyMPC, memory of ExpertApproach) and their action limits depend
+  /// on the owner, therefore each owner builds its own instance by default.
+  /// If 'share_policy' is set to true along with 'policy', the policy is
+  /// assumed to be stateless and is shared among all the owners of the process
+  /// using the same description and the same action limits (see ConfigCache)
+  class ApproachPolicy
+  {
+  public:
+    ApproachPolicy();
+
+    /// Replace the description if 'policy' is a member of v
+    void tryRead(const Json::Value& v, const std::string& dir_name);
+
+    /// Build the policy from its description, nothing is done if no
+    /// description has been provided
+    void build(const std::vector<Eigen::MatrixXd>& action_limits);
+
+    /// Null if no description has been provided or if build has not been called
+    const csa_mdp::Policy* get() const;
+
+  private:
+    /// Contains the description of the policy in 'policy', null if not provided
+    Json::Value description;
+    std::string dir_name;
+    bool shared;
+    std::shared_ptr<const csa_mdp::Policy> policy;
+  };
+
   /// Several kick options might be available, but each kick options has its own:
   /// - Kick decision model: To choose how parameters of the kick are computed
   /// - Kick model         : To determine the eventual results
@@ -63,19 +107,55 @@ public:
   class KickOption : rhoban_utils::JsonSerializable
   {
   public:
+    /// A kick of the option resolved from the KickModelCollection
+    class CompiledKick
+    {
+    public:
+      /// Wished placement of the robot for a foot with cached trigonometry
+      struct FootPlacement
+      {
+        /// Position of the robot relative to the ball in robot referential [m]
+        double dx, dy;
+        /// Offset between kick direction and robot direction [rad]
+        double theta_offset;
+        double cos_offset, sin_offset;
+      };
+
+      /// Return the desired position for the robot (in field referential), see
+      /// KickZone::getWishedPosInField, cos and sin of kick_dir are provided
+      Eigen::Vector3d getWishedPosInField(const Eigen::Vector2d& ball_pos, double kick_dir, double cos_dir,
+                                          double sin_dir, bool right_foot) const;
+
+      const KickModel* model;
+      const KickZone* zone;
+      /// Index 0 is used for left foot, index 1 for right foot
+      FootPlacement feet[2];
+    };
+
     std::unique_ptr<KickDecisionModel> kick_decision_model;
     std::vector<std::string> kick_model_names;
     BallApproach approach_model;
     /// The policy used for the approach problem
     /// S: (ball_dist, ball_dir, target_angle, last_step_x, last_step_y, last_step_theta)
     /// A: (dstep_x, dstep_y, dstep_theta)
-    std::unique_ptr<csa_mdp::Policy> approach_policy;
+    ApproachPolicy approach_policy;
+
+    /// Kicks in the same order as kick_model_names, filled by compile
+    std::vector<CompiledKick> compiled_kicks;
+    /// Zones of compiled_kicks, in the same order
+    KickZoneSet compiled_zones;
+    /// Is there a single kick available
+    bool single_kick;
+
+    KickOption();
 
     Json::Value toJson() const override;
     void fromJson(const Json::Value& v, const std::string& dir_name) override;
     std::string getClassName() const override;
 
-    void syncKickZones(const KickModelCollection& kmc);
+    /// Resolve the kicks from kmc and synchronize the kick zones of the
+    /// approach model. kmc has to outlive the option
+    void compile(const KickModelCollection& kmc);
   };
 
   /// Each player has its own custom configuration
@@ -89,7 +169,7 @@ public:
     /// Description of the approach problem used when the robot is not kicking
     BallApproach navigation_approach;
     /// Description of the policy used when the robot is not kicking
-    std::unique_ptr<csa_mdp::Policy> approach_policy;
+    ApproachPolicy approach_policy;
 
     Json::Value toJson() const override;
     void fromJson(const Json::Value& v, const std::string& dir_name) override;
@@ -110,8 +190,13 @@ public:
   ///       be more faire between problems with a different number of players.
   ///       e.g: One of the player start at a distance drawn from [0,max_dist]
   ///            and the others start at a random position but above max_dist
+  /// If a bank of starting states has been generated, a state of the bank is
+  /// drawn uniformly instead
   Eigen::VectorXd getStartingState(std::default_random_engine* engine) const override;
 
+  /// Return the pre-generated starting states, empty if the bank is disabled
+  const std::vector<Eigen::VectorXd>& getStartingStatesBank() const;
+
   /// Return the most adapted approach policy for the specified settings,
   const csa_mdp::Policy& getPolicy(int player_id, int kicker_id, int kick_option_id) const;
 
@@ -164,15 +249,37 @@ public:
   /// Get kick direction [rad] (in field basis)
   double getKickDir(const Eigen::VectorXd& state, const Eigen::VectorXd& action) const;
 
+  bool hasSymmetry() const override;
+  /// Opposite values for ball_y and for the y and direction of all players
+  Eigen::VectorXd mirrorState(const Eigen::VectorXd& state) const override;
+  /// Kick parameters are mirrored by the kick decision model
+  Eigen::VectorXd mirrorAction(const Eigen::VectorXd& action) const override;
+
   /// Return the names of kicks allowed for the given kick_option
   const std::vector<std::string>& getAllowedKicks(int kicker_id, int kick_option);
 
+  /// Return a set of actions covering all action_ids, kick parameters being
+  /// discretized uniformly with nb_values_per_dim values for each dimension
+  std::vector<Eigen::VectorXd> getDiscretizedActions(int nb_values_per_dim) const;
+
+  /// Batch version of moveBall for n segments, dst_x and dst_y are updated in
+  /// place, terminal status and reward of each segment are written
+  /// (all arrays have size n)
+  void moveBalls(int n, const double* src_x, const double* src_y, double* dst_x, double* dst_y, bool* terminal,
+                 double* rewards) const;
+
 private:
   /// Return the limits for the field (row1: field_x, row2: field_y)
   Eigen::Matrix<double, 2, 2> getFieldLimits() const;
   /// Return the limits for the field (row1: field_x, row2: field_y, row3: orientation)
   Eigen::Matrix<double, 3, 2> getPlayerLimits() const;
 
+  /// Sample a starting state directly (without using the bank)
+  Eigen::VectorXd sampleStartingState(std::default_random_engine* engine) const;
+
+  /// Generate the bank of starting states from its seed
+  void generateStartingStatesBank();
+
   /// Update state limits and names
   void updateStateLimits();
 
@@ -197,18 +304,11 @@ private:
   /// - reward is updated (a reward is accorded according to the event)
   void moveBall(double src_x, double src_y, double* dst_x, double* dst_y, bool* terminal, double* reward) const;
 
-  /// Is the given kick colliding the goalie ?
-  /// if colliding: return true and modifies dst_x and dst_y
-  bool isCollidingGoalie(double src_x, double src_y, double* dst_x, double* dst_y) const;
+  /// Return the reward associated to the event ending the motion of the ball
+  double getEventReward(BallExitKernel::Event event) const;
 
-  /// Is the given kick resulting with a goal?
-  /// If goal: return true and modifies dst_x and dst_y
-  bool isGoal(double src_x, double src_y, double* dst_x, double* dst_y) const;
-
-  /// Is the ball outside of the field after the given kick
-  /// If ball is outside: return true and modifies dst_x and dst_y
-  /// src is expected to be inside the field
-  bool isOut(double src_x, double src_y, double* dst_x, double* dst_y) const;
+  /// Update the geometry used to detect the end of ball motions
+  void updateBallExitKernel();
 
   /// Is the player inside of the goal area
   bool isGoalArea(double player_x, double player_y) const;
@@ -220,15 +320,22 @@ private:
 
   /// Extract a BallApproach state from the given player state and the given target
   /// Current speeds of the robots are set to [0,0,0]
-  Eigen::VectorXd toBallApproachState(const Eigen::Vector3d& player_state, const Eigen::Vector3d& target) const;
+  BallApproach::FixedState toBallApproachState(const Eigen::Vector3d& player_state,
+                                               const Eigen::Vector3d& target) const;
 
-  /// Return an updated version
-  Eigen::VectorXd toKickControlerState(const Eigen::VectorXd& ba_state, const Eigen::VectorXd& prev_kc_state,
-                                       int player_id, const Eigen::Vector3d& target) const;
+  /// Update the state of the given player in kc_state from its BallApproach state
+  void toKickControlerState(const BallApproach::FixedState& ba_state, int player_id, const Eigen::Vector3d& target,
+                            Eigen::VectorXd* kc_state) const;
 
   /// #INITIAL STATE
   /// Maximal distance allowed from robots to ball in initial position
   double max_initial_dist;
+  /// Number of starting states generated at loading, 0 disables the bank
+  int starting_states_bank_size;
+  /// Seed used to generate the bank, allowing to replay the same states
+  int starting_states_bank_seed;
+  /// Pre-generated starting states
+  std::vector<Eigen::VectorXd> starting_states_bank;
 
   /// #TRANSITION FUNCTION
   /// Which KickOptions are available?
@@ -247,7 +354,7 @@ private:
   ///       be done is to have an approximator for each option (i.e couple
   ///       kick_name and kick_foot). Then this approximator could also be used
   ///       to choose which type of kick and which foot is used to kick.
-  std::unique_ptr<rhoban_fa::FunctionApproximator> approach_steps_approximator;
+  LazyApproximator approach_steps_approximator;
 
   /// Approximation of cartesian speed [m/s] for the robot when
   /// 'simulate_approaches' is false
@@ -298,8 +405,12 @@ private:
   /// Goalie size along y-axis
   double goalie_width;
 
-  /// The collection of available kicks
-  KickModelCollection kmc;
+  /// Detects collisions with the goalie, goals and exits of the field
+  BallExitKernel ball_exit_kernel;
+
+  /// The collection of available kicks, shared by all the problems using the
+  /// same file
+  std::shared_ptr<const KickModelCollection> kmc;
 
   /// #KICK PROPERTIES
   /// Default kicks used when there is no player considered
@@ -1,3 +1,7 @@
+#pragma once
+
+#include "utils/ode_integrator.h"
+
 #include "rhoban_csa_mdp/core/black_box_problem.h"
 
 #include <random>
@@ -35,6 +39,10 @@ public:
     Full
   };
 
+  /// Full states of several environments in struct-of-arrays layout: one row
+  /// per dimension of the full space, one column per environment
+  typedef Eigen::Array<double, 6, Eigen::Dynamic, Eigen::RowMajor> StateArrays;
+
   /// Default configuration is the pilco configuration
   SimulatedCartPole();
 
@@ -49,8 +57,22 @@ public:
   Result getSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                       std::default_random_engine* engine) const override;
 
+  /// Batch version of getSuccessor for full states, applied on all the columns
+  /// - cmds: the command applied on each cart (without action_id)
+  /// - successors might alias states, rewards and terminal are resized
+  /// The noise of all the environments is drawn in a single batch and the
+  /// dynamics are computed with vectorized operations. Only fixed-step
+  /// integrators are supported
+  void getSuccessors(const StateArrays& states, const Eigen::ArrayXd& cmds, std::default_random_engine* engine,
+                     StateArrays* successors, Eigen::ArrayXd* rewards, Eigen::Array<bool, -1, 1>* terminal) const;
+
+  /// Batch version of isTerminal for full states
+  Eigen::Array<bool, -1, 1> areTerminal(const StateArrays& states) const;
+
   Eigen::VectorXd getStartingState(std::default_random_engine* engine) const override;
 
+  const OdeIntegrator& getIntegrator() const;
+
   Json::Value toJson() const override;
   void fromJson(const Json::Value& v, const std::string& dir_name) override;
   std::string getClassName() const override;
@@ -60,6 +82,19 @@ protected:
   Eigen::VectorXd getFullSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                                    std::default_random_engine* engine) const;
 
+  /// Derivative of [cart_pos cart_vel theta omega] when applying 'cmd' on the cart
+  Eigen::Vector4d getDerivative(const Eigen::Vector4d& state, double cmd) const;
+
+  /// [cart_pos cart_vel theta omega] of several environments, one column per
+  /// environment
+  typedef Eigen::Array<double, 4, Eigen::Dynamic, Eigen::RowMajor> DynamicArrays;
+
+  /// One value per environment
+  typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArray;
+
+  /// Batch version of getDerivative
+  DynamicArrays getDerivatives(const DynamicArrays& states, const RowArray& cmds) const;
+
   // Entry is dimension 4, output is dimension 4
   Eigen::VectorXd getAngularSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                                       std::default_random_engine* engine) const;
@@ -100,8 +135,8 @@ private:
   /// Gravity acceleration [m/s^2]
   double gravity;
 
-  /// Duration of an integration step [s]
-  double integration_step;
+  /// Integration of the dynamics during a simulation step
+  OdeIntegrator integrator;
   /// Duration of a simulation step [s] (1 / controlFrequency)
   double simulation_step;
 
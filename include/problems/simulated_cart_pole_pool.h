@@ -0,0 +1,57 @@
+#pragma once
+
+#include "problems/simulated_cart_pole.h"
+
+#include <memory>
+
+namespace csa_mdp
+{
+/// A set of SimulatedCartPole environments stepped together
+///
+/// The full states of the environments are stored in struct-of-arrays layout
+/// and all the environments are stepped with a single call to
+/// SimulatedCartPole::getSuccessors, without any virtual call per environment.
+/// An environment which reached a terminal state keeps its terminal status
+/// until it is reset.
+class SimulatedCartPolePool
+{
+public:
+  /// Environments are initialized with the starting state of the model
+  SimulatedCartPolePool(std::shared_ptr<const SimulatedCartPole> model, int nb_envs);
+
+  int size() const;
+
+  /// Reset all the environments to starting states of the model
+  void reset(std::default_random_engine* engine);
+
+  /// Reset the environments which are terminal, return the number of
+  /// environments reset
+  int resetTerminated(std::default_random_engine* engine);
+
+  /// Full state of an environment (dimension 6)
+  Eigen::VectorXd getState(int env) const;
+  void setState(int env, const Eigen::VectorXd& full_state);
+
+  const SimulatedCartPole::StateArrays& getStates() const;
+
+  /// Apply one command on each environment, terminal environments are also
+  /// stepped
+  void step(const Eigen::ArrayXd& cmds, std::default_random_engine* engine);
+
+  /// Rewards received during the last step
+  const Eigen::ArrayXd& getRewards() const;
+
+  /// Which environments are in a terminal state
+  const Eigen::Array<bool, -1, 1>& getTerminal() const;
+
+private:
+  std::shared_ptr<const SimulatedCartPole> model;
+
+  SimulatedCartPole::StateArrays states;
+
+  Eigen::ArrayXd rewards;
+
+  Eigen::Array<bool, -1, 1> terminal;
+};
+
+}  // namespace csa_mdp
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "problems/differentiable_problem.h"
+
 #include "rhoban_csa_mdp/core/black_box_problem.h"
 
 #include <Eigen/Core>
@@ -30,7 +32,7 @@ namespace csa_mdp
 /// - acc_x
 /// - acc_y
 /// - acc_theta
-class SSLBallApproach : public BlackBoxProblem
+class SSLBallApproach : public BlackBoxProblem, public DifferentiableProblem
 {
 public:
   SSLBallApproach();
@@ -42,6 +44,12 @@ public:
   Problem::Result getSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                                std::default_random_engine* engine) const override;
 
+  /// Jacobians are obtained analytically, they are not defined when the ball
+  /// is exactly at the center of the robot
+  Eigen::VectorXd getDeterministicSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
+                                            Eigen::MatrixXd* state_jacobian,
+                                            Eigen::MatrixXd* action_jacobian) const override;
+
   Eigen::VectorXd getStartingState(std::default_random_engine* engine) const override;
 
   /// Is the ball kickable
@@ -3,10 +3,14 @@
 #include "rhoban_csa_mdp/core/black_box_problem.h"
 
 #include "kick_model/rolling_ball_model.h"
+#include "problems/differentiable_problem.h"
+#include "utils/lazy_approximator.h"
+#include "utils/multilinear_table.h"
 
 #include <Eigen/Core>
 
 #include <functional>
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -30,7 +34,7 @@ namespace csa_mdp
 ///           toward the goal target, robot is moving at a speed similar to
 ///           the ball speed
 /// - Full: The robot starts as in Wide and end as in Finish
-class SSLDynamicBallApproach : public BlackBoxProblem
+class SSLDynamicBallApproach : public BlackBoxProblem, public DifferentiableProblem
 {
 public:
   enum Mode
@@ -40,17 +44,48 @@ public:
     Full
   };
 
+  /// State with a fixed size used by the allocation-free kernel
+  typedef Eigen::Matrix<double, 11, 1> FixedState;
+
   SSLDynamicBallApproach();
 
   std::vector<int> getLearningDimensions() const override;
 
   bool isTerminal(const Eigen::VectorXd& state) const;
+  bool isTerminal(const FixedState& state) const;
 
   double getReward(const Eigen::VectorXd& state, const Eigen::VectorXd& action, const Eigen::VectorXd& dst) const;
+  /// The reward does not depend on the action
+  double getReward(const FixedState& state, const FixedState& dst) const;
 
+  /// Dispatch to step
   Problem::Result getSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                                std::default_random_engine* engine) const override;
 
+  /// Allocation-free version of getSuccessor, action does not contain the
+  /// action_id: (acc_x, acc_y, acc_theta). successor might alias state
+  void step(const FixedState& state, const Eigen::Vector3d& action, std::default_random_engine* engine,
+            FixedState* successor, double* reward, bool* terminal) const;
+
+  /// Batch version of getSuccessor applied on all the columns of the inputs
+  /// - states: 11xN, actions: 4xN (first row is ignored)
+  /// - successors (11xN), rewards (N) and terminal (N) have to be allocated
+  /// - strict: if enabled, results are bitwise identical to successive calls
+  ///   to getSuccessor with the same engine, otherwise the motion is computed
+  ///   with vectorized operations and sinCos
+  /// The noise of all the columns is drawn in a single batch in both modes.
+  /// Drawing itself remains sequential: each sample depends on the state of
+  /// the engine left by the previous one, and rejected samples consume a
+  /// variable number of draws, see ZigguratNormal::fill
+  void getSuccessors(const Eigen::MatrixXd& states, const Eigen::MatrixXd& actions, std::default_random_engine* engine,
+                     Eigen::MatrixXd* successors, Eigen::VectorXd* rewards, Eigen::Array<bool, -1, 1>* terminal,
+                     bool strict = false) const;
+
+  /// Jacobians are obtained analytically
+  Eigen::VectorXd getDeterministicSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
+                                            Eigen::MatrixXd* state_jacobian,
+                                            Eigen::MatrixXd* action_jacobian) const override;
+
   Eigen::VectorXd getStartingState(std::default_random_engine* engine) const override;
 
   Eigen::VectorXd getWideStartingState(std::default_random_engine* engine) const;
@@ -58,15 +93,28 @@ public:
 
   /// Is current state a success (taking Mode into account)
   bool isSuccess(const Eigen::VectorXd& state) const;
+  bool isSuccess(const FixedState& state) const;
 
   /// Is current state inside
   bool isFinishState(const Eigen::VectorXd& state) const;
+  bool isFinishState(const FixedState& state) const;
   /// Is the ball kickable in given state ?
   bool isKickable(const Eigen::VectorXd& state) const;
+  bool isKickable(const FixedState& state) const;
   /// Is the robot colliding with the ball
   bool isColliding(const Eigen::VectorXd& state) const;
+  bool isColliding(const FixedState& state) const;
   /// Is the ball outside of the given limits
   bool isOutOfSpace(const Eigen::VectorXd& state) const;
+  bool isOutOfSpace(const FixedState& state) const;
+
+  /// Value of finish_value for the given state, read from the table when it
+  /// covers the state
+  double getFinishValue(const FixedState& state) const;
+
+  /// Limits of the learning space from which the finish zone can be entered
+  /// in a single step, ignoring noise
+  Eigen::MatrixXd getFinishValueTableLimits() const;
 
   Json::Value toJson() const override;
   void fromJson(const Json::Value& v, const std::string& dir_name) override;
@@ -78,6 +126,28 @@ public:
   void setMaxDist(double dist);
 
 protected:
+  /// Motion of the robot for a step with the provided normal samples for noise
+  /// on (x, y, theta). successor might alias state
+  void stepWithNoise(const FixedState& state, const Eigen::Vector3d& action, const double* noise,
+                     FixedState* successor, double* reward, bool* terminal) const;
+
+  /// Motion part of stepWithNoise, successor might alias state
+  void applyMotion(const FixedState& state, const Eigen::Vector3d& action, const double* noise,
+                   FixedState* successor) const;
+
+  /// Tabulate finish_value according to the parameters in v:
+  /// - resolution: number of points along each learning dimension (int or array)
+  /// - nb_threads: number of threads used to fill the table
+  /// - error_samples: number of random states used to report the error
+  /// - cache_dir: if provided, tables are stored in this directory, identified
+  ///   by a hash of the source of finish_value (path and version of the file,
+  ///   see LazyApproximator::getSourceKey) and of the grid
+  void buildFinishValueTable(const Json::Value& v, const std::string& dir_name);
+
+  /// Common checks of isFinishState and isKickable
+  bool isInZone(const FixedState& state, const Eigen::Vector2d& x_limits, double y_tol,
+                const Eigen::Vector2d& diff_speed_x_limits, double diff_speed_y_max, double speed_theta_max) const;
+
   // STATE LIMITS
   /// The maximal distance to the ball [m]
   double ball_max_dist;
@@ -183,7 +253,10 @@ protected:
   RollingBallModel rolling_ball_model;
 
   /// The value function used to obtain the final reward when state is in 'finish_zone' and mode is 'Wide'
-  std::unique_ptr<rhoban_fa::FunctionApproximator> finish_value;
+  LazyApproximator finish_value;
+
+  /// Optional multilinear approximation of finish_value
+  std::shared_ptr<const MultilinearTable> finish_value_table;
 };
 
 }  // namespace csa_mdp
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Eigen/Core>
+
+namespace csa_mdp
+{
+/// Interface for problems which are invariant under a mirroring of their
+/// states and actions: if applying 'a' in 's' leads to 's2' with reward 'r',
+/// then applying mirror(a) in mirror(s) leads to mirror(s2) with the same
+/// probability and the same reward.
+///
+/// This allows to generate an additional sample for each simulated transition.
+class SymmetricProblem
+{
+public:
+  virtual ~SymmetricProblem()
+  {
+  }
+
+  /// Does the symmetry hold with the current parameters of the problem?
+  virtual bool hasSymmetry() const = 0;
+
+  virtual Eigen::VectorXd mirrorState(const Eigen::VectorXd& state) const = 0;
+
+  /// action(0) is the action_id, it is not modified by the mirroring
+  virtual Eigen::VectorXd mirrorAction(const Eigen::VectorXd& action) const = 0;
+};
+
+}  // namespace csa_mdp
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <sys/stat.h>
+
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace csa_mdp
+{
+/// Identifies the version of the file at the provided path from its
+/// modification time and its size, empty if the file cannot be accessed
+inline std::string getFileVersion(const std::string& path)
+{
+  struct stat file_stat;
+  if (stat(path.c_str(), &file_stat) != 0)
+  {
+    return "";
+  }
+  std::ostringstream version;
+  version << file_stat.st_mtim.tv_sec << "." << file_stat.st_mtim.tv_nsec << ":" << file_stat.st_size;
+  return version.str();
+}
+
+/// A process-wide and thread-safe cache of objects built from configuration
+/// files, allowing several problems to share the same instance instead of
+/// parsing and storing it multiple times.
+///
+/// Since instances are shared, they should not be modified once they have been
+/// loaded, which is enforced by using a const type, e.g.
+/// ConfigCache<const KickModelCollection>
+///
+/// Loading is performed outside of the lock, therefore loaders can use the
+/// cache recursively. If two threads request the same missing entry
+/// simultaneously, both load it but only the first inserted is kept.
+template <typename T>
+class ConfigCache
+{
+public:
+  typedef std::function<std::unique_ptr<T>()> Loader;
+
+  /// Return the object built from the file at the provided path. Entries are
+  /// identified by the canonical path of the file and reloaded if the file has
+  /// been modified since the object was built (see getFileVersion)
+  static std::shared_ptr<T> getFile(const std::string& path, Loader loader)
+  {
+    char resolved[PATH_MAX];
+    std::string version;
+    if (realpath(path.c_str(), resolved) != nullptr)
+    {
+      version = getFileVersion(resolved);
+    }
+    if (version == "")
+    {
+      std::ostringstream oss;
+      oss << "ConfigCache::getFile: failed to access '" << path << "'";
+      throw std::runtime_error(oss.str());
+    }
+    return get(std::string("file:") + resolved, version, loader);
+  }
+
+  /// Return the object associated to the given content, typically the textual
+  /// description of the object and the directory in which it was read.
+  /// The version identifies the state of the files referenced by the content
+  /// (see getFileVersion), the object is reloaded when it changes
+  static std::shared_ptr<T> getContent(const std::string& content, Loader loader, const std::string& version = "")
+  {
+    return get("content:" + content, version, loader);
+  }
+
+  /// Release the references held by the cache
+  static void clear()
+  {
+    std::lock_guard<std::mutex> lock(getMutex());
+    getEntries().clear();
+  }
+
+private:
+  struct Entry
+  {
+    /// Identifies the version of the source used to build the object
+    std::string version;
+    std::shared_ptr<T> value;
+  };
+
+  static std::shared_ptr<T> get(const std::string& key, const std::string& version, Loader loader)
+  {
+    {
+      std::lock_guard<std::mutex> lock(getMutex());
+      auto it = getEntries().find(key);
+      if (it != getEntries().end() && it->second.version == version)
+      {
+        return it->second.value;
+      }
+    }
+    std::shared_ptr<T> value(loader());
+    std::lock_guard<std::mutex> lock(getMutex());
+    Entry& entry = getEntries()[key];
+    if (!entry.value || entry.version != version)
+    {
+      entry.version = version;
+      entry.value = value;
+    }
+    return entry.value;
+  }
+
+  static std::mutex& getMutex()
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  static std::map<std::string, Entry>& getEntries()
+  {
+    static std::map<std::string, Entry> entries;
+    return entries;
+  }
+};
+
+}  // namespace csa_mdp
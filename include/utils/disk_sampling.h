@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include <functional>
+#include <random>
+
+namespace csa_mdp
+{
+/// Draw a point uniformly on the intersection of a disk and a box
+/// - box: row1: x limits, row2: y limits (column1: min, column2: max)
+/// - the center of the disk has to be inside the box
+///
+/// x is drawn by inverting the cumulative area along x (see solveIncreasing),
+/// then y is drawn uniformly on the vertical section at x
+Eigen::Vector2d sampleDiskInBox(const Eigen::Vector2d& center, double radius, const Eigen::Matrix<double, 2, 2>& box,
+                                std::default_random_engine* engine);
+
+/// Find x in [low, high] such that f(x) = target, f being increasing on the
+/// interval with derivative df. Newton iterations start at the middle of the
+/// interval, steps leaving the current bracket or using a null derivative are
+/// replaced by bisection. Iterations stop when the bracket or the last step are
+/// smaller than tol, or after max_iter iterations.
+/// If nb_iter is provided, the number of iterations performed is stored in it
+double solveIncreasing(const std::function<double(double)>& f, const std::function<double(double)>& df,
+                       double target, double low, double high, double tol, int max_iter, int* nb_iter = nullptr);
+
+}  // namespace csa_mdp
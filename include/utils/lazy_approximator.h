@@ -0,0 +1,75 @@
+#pragma once
+
+#include "rhoban_fa/function_approximator.h"
+
+#include "rhoban_utils/serialization/json_serializable.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace csa_mdp
+{
+/// A function approximator which is only read from its binary file on first
+/// access. Approximators read from the same source are shared among the whole
+/// process through ConfigCache, therefore the cost of starting a program does
+/// not depend on the size of the approximators it might use.
+///
+/// Access is thread-safe, once loaded the overhead is a single atomic load
+class LazyApproximator
+{
+public:
+  LazyApproximator();
+
+  /// Defer the loading of the binary file at the provided path
+  void setFile(const std::string& path);
+
+  /// Defer the loading of a binary file described by v (see
+  /// FunctionApproximatorFactory::tryLoadBinaryFromPath)
+  void setBinaryFromPath(const Json::Value& v, const std::string& dir_name);
+
+  /// Remove the source and release the approximator
+  void clear();
+
+  /// Has a source been provided?
+  bool isDefined() const;
+
+  /// Identifies the source and the version of the files it reads (see
+  /// getFileVersion), therefore the key changes if a file is modified in
+  /// place. The approximator is not loaded.
+  /// Throws a std::logic_error if no source has been provided
+  std::string getSourceKey() const;
+
+  /// Return true if the approximator has already been loaded
+  bool isLoaded() const;
+
+  /// Load the approximator if it has not been loaded yet.
+  /// Throws a std::logic_error if no source has been provided
+  const rhoban_fa::FunctionApproximator& get() const;
+
+  const rhoban_fa::FunctionApproximator* operator->() const;
+
+  /// Equivalent to isDefined
+  explicit operator bool() const;
+
+private:
+  typedef std::function<std::shared_ptr<const rhoban_fa::FunctionApproximator>()> Source;
+
+  /// Retrieves the approximator, empty if no source has been provided
+  Source source;
+
+  /// Description of the source, without the version of the files
+  std::string source_id;
+
+  /// Files which might be read by the source
+  std::vector<std::string> source_files;
+
+  mutable std::mutex mutex;
+  mutable std::atomic<bool> loaded;
+  mutable std::shared_ptr<const rhoban_fa::FunctionApproximator> approximator;
+};
+
+}  // namespace csa_mdp
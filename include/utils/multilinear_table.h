@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace csa_mdp
+{
+/// A lookup table storing the values of a function on a regular grid over a
+/// box, values inside the box are obtained by multilinear interpolation.
+///
+/// Dimensions with a single point are sampled at the center of their interval
+/// and the function is considered constant along them.
+class MultilinearTable
+{
+public:
+  typedef std::function<double(const Eigen::VectorXd&)> Function;
+
+  /// limits: Dx2 matrix with min and max along each dimension
+  /// nb_points: number of points of the grid along each dimension (>= 1)
+  MultilinearTable(const Eigen::MatrixXd& limits, const std::vector<int>& nb_points);
+
+  int getDim() const;
+  int getNbValues() const;
+  const Eigen::MatrixXd& getLimits() const;
+  const std::vector<int>& getNbPoints() const;
+
+  /// Return the position of the grid point with the given index
+  Eigen::VectorXd getGridPoint(int index) const;
+
+  /// Evaluate f on all the points of the grid using nb_threads threads.
+  /// f has to be thread-safe
+  void fill(Function f, int nb_threads);
+
+  /// Is the point inside the box covered by the table
+  bool contains(const Eigen::Ref<const Eigen::VectorXd>& point) const;
+
+  /// Interpolated value at the provided point, points outside of the box are
+  /// projected on its boundary
+  double getValue(const Eigen::Ref<const Eigen::VectorXd>& point) const;
+
+  /// Return the maximal and the mean absolute difference between the table and
+  /// f on nb_samples points drawn uniformly in the box
+  void getError(Function f, int nb_samples, std::default_random_engine* engine, double* max_error,
+                double* mean_error) const;
+
+  /// Write the table to a binary file, throws a std::runtime_error on failure
+  void save(const std::string& path) const;
+
+  /// Read values from a binary file. Returns false if the file does not exist
+  /// or if its grid differs from the grid of the table
+  bool tryLoad(const std::string& path);
+
+private:
+  Eigen::MatrixXd limits;
+  std::vector<int> nb_points;
+
+  /// Distance between two points of the grid along each dimension
+  Eigen::VectorXd steps;
+
+  /// Offset between consecutive values along each dimension
+  std::vector<int> strides;
+
+  /// Dimensions with more than one point, the only ones used for interpolation
+  std::vector<int> active_dims;
+
+  /// Values of the function at each point of the grid, first dimension varies
+  /// fastest
+  std::vector<double> values;
+};
+
+}  // namespace csa_mdp
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "rhoban_utils/serialization/json_serializable.h"
+
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace csa_mdp
+{
+/// Integrates autonomous ordinary differential equations dx/dt = f(x) of
+/// fixed dimension over a given duration.
+///
+/// Available methods are:
+/// - Euler: explicit Euler with a fixed step
+/// - RK4: classical Runge-Kutta with a fixed step
+/// - RK45: Dormand-Prince 5(4) with an adaptive step, the local error is kept
+///   below abs_tol + rel_tol * |x| along each dimension
+///
+/// Fixed steps are shortened, if required, in order to cover the duration with
+/// an integer number of equal steps.
+/// Integration relies on fixed-size vectors and does not allocate memory.
+class OdeIntegrator : public rhoban_utils::JsonSerializable
+{
+public:
+  enum class Method
+  {
+    Euler,
+    RK4,
+    RK45
+  };
+
+  OdeIntegrator();
+
+  /// Integrate 'f' from 'x' during 'duration' [s]. 'f' is called as
+  /// f(const Eigen::Matrix<double, N, 1>&) and returns the derivative.
+  /// If 'nb_evaluations' is provided, the number of calls to 'f' is added to it
+  template <int N, typename Derivative>
+  Eigen::Matrix<double, N, 1> integrate(const Eigen::Matrix<double, N, 1>& x, double duration, const Derivative& f,
+                                        int* nb_evaluations = nullptr) const;
+
+  /// Batch version of integrate for fixed-step methods: each column of 'x' is
+  /// an independent state, 'f' is called on all the columns at once and
+  /// returns the derivatives in the same layout. RK45 is not supported
+  template <int N, typename Derivative>
+  Eigen::Array<double, N, Eigen::Dynamic, Eigen::RowMajor>
+  integrateBatch(const Eigen::Array<double, N, Eigen::Dynamic, Eigen::RowMajor>& x, double duration,
+                 const Derivative& f) const;
+
+  Method getMethod() const;
+
+  /// Step used by Euler and RK4 [s]
+  double getStep() const;
+
+  /// Set the method and the step used by fixed-step methods
+  void setFixedStep(Method method, double step);
+
+  std::string getClassName() const override;
+  Json::Value toJson() const override;
+  void fromJson(const Json::Value& v, const std::string& dir_name) override;
+
+private:
+  template <int N, typename Derivative>
+  Eigen::Matrix<double, N, 1> integrateFixed(const Eigen::Matrix<double, N, 1>& x, double duration,
+                                             const Derivative& f, int* nb_evaluations) const;
+
+  template <int N, typename Derivative>
+  Eigen::Matrix<double, N, 1> integrateAdaptive(const Eigen::Matrix<double, N, 1>& x, double duration,
+                                                const Derivative& f, int* nb_evaluations) const;
+
+  Method method;
+
+  /// Step of fixed-step methods [s]
+  double step;
+
+  /// Tolerances of the adaptive method
+  double abs_tol;
+  double rel_tol;
+
+  /// First step tried by the adaptive method [s]
+  double initial_step;
+
+  /// Below this step, the adaptive method accepts steps even if their error
+  /// is too large [s]
+  double min_step;
+};
+
+std::string to_string(OdeIntegrator::Method method);
+OdeIntegrator::Method loadOdeIntegratorMethod(const std::string& str);
+
+template <int N, typename Derivative>
+Eigen::Matrix<double, N, 1> OdeIntegrator::integrate(const Eigen::Matrix<double, N, 1>& x, double duration,
+                                                     const Derivative& f, int* nb_evaluations) const
+{
+  if (method == Method::RK45)
+  {
+    return integrateAdaptive<N>(x, duration, f, nb_evaluations);
+  }
+  return integrateFixed<N>(x, duration, f, nb_evaluations);
+}
+
+template <int N, typename Derivative>
+Eigen::Matrix<double, N, 1> OdeIntegrator::integrateFixed(const Eigen::Matrix<double, N, 1>& x, double duration,
+                                                          const Derivative& f, int* nb_evaluations) const
+{
+  typedef Eigen::Matrix<double, N, 1> Vector;
+  Vector current = x;
+  // Tolerance avoids an additional step due to rounding errors
+  int nb_steps = std::max(1, (int)std::ceil(duration / step - 1e-9));
+  double dt = duration / nb_steps;
+  for (int i = 0; i < nb_steps; i++)
+  {
+    if (method == Method::Euler)
+    {
+      current += dt * f(current);
+    }
+    else
+    {
+      Vector k1 = f(current);
+      Vector k2 = f(current + dt / 2 * k1);
+      Vector k3 = f(current + dt / 2 * k2);
+      Vector k4 = f(current + dt * k3);
+      current += dt / 6 * (k1 + 2 * k2 + 2 * k3 + k4);
+    }
+  }
+  if (nb_evaluations != nullptr)
+  {
+    *nb_evaluations += nb_steps * (method == Method::Euler ? 1 : 4);
+  }
+  return current;
+}
+
+template <int N, typename Derivative>
+Eigen::Array<double, N, Eigen::Dynamic, Eigen::RowMajor>
+OdeIntegrator::integrateBatch(const Eigen::Array<double, N, Eigen::Dynamic, Eigen::RowMajor>& x, double duration,
+                              const Derivative& f) const
+{
+  typedef Eigen::Array<double, N, Eigen::Dynamic, Eigen::RowMajor> Arrays;
+  if (method == Method::RK45)
+  {
+    throw std::logic_error("OdeIntegrator::integrateBatch: adaptive steps are not supported");
+  }
+  Arrays current = x;
+  // Same steps as integrateFixed
+  int nb_steps = std::max(1, (int)std::ceil(duration / step - 1e-9));
+  double dt = duration / nb_steps;
+  for (int i = 0; i < nb_steps; i++)
+  {
+    if (method == Method::Euler)
+    {
+      current += dt * f(current);
+    }
+    else
+    {
+      Arrays k1 = f(current);
+      Arrays k2 = f(current + dt / 2 * k1);
+      Arrays k3 = f(current + dt / 2 * k2);
+      Arrays k4 = f(current + dt * k3);
+      current += dt / 6 * (k1 + 2 * k2 + 2 * k3 + k4);
+    }
+  }
+  return current;
+}
+
+template <int N, typename Derivative>
+Eigen::Matrix<double, N, 1> OdeIntegrator::integrateAdaptive(const Eigen::Matrix<double, N, 1>& x, double duration,
+                                                             const Derivative& f, int* nb_evaluations) const
+{
+  typedef Eigen::Matrix<double, N, 1> Vector;
+  // Dormand-Prince coefficients
+  static constexpr double a21 = 1.0 / 5;
+  static constexpr double a31 = 3.0 / 40, a32 = 9.0 / 40;
+  static constexpr double a41 = 44.0 / 45, a42 = -56.0 / 15, a43 = 32.0 / 9;
+  static constexpr double a51 = 19372.0 / 6561, a52 = -25360.0 / 2187, a53 = 64448.0 / 6561, a54 = -212.0 / 729;
+  static constexpr double a61 = 9017.0 / 3168, a62 = -355.0 / 33, a63 = 46732.0 / 5247, a64 = 49.0 / 176,
+                          a65 = -5103.0 / 18656;
+  static constexpr double b1 = 35.0 / 384, b3 = 500.0 / 1113, b4 = 125.0 / 192, b5 = -2187.0 / 6784, b6 = 11.0 / 84;
+  // Difference between 5th and 4th order weights
+  static constexpr double e1 = 71.0 / 57600, e3 = -71.0 / 16695, e4 = 71.0 / 1920, e5 = -17253.0 / 339200,
+                          e6 = 22.0 / 525, e7 = -1.0 / 40;
+  Vector current = x;
+  // First same as last: k1 of a step is k7 of the previous accepted step
+  Vector k1 = f(current);
+  int evaluations = 1;
+  double elapsed = 0;
+  double dt = std::min(initial_step, duration);
+  while (elapsed < duration)
+  {
+    bool last = elapsed + dt >= duration;
+    if (last)
+    {
+      dt = duration - elapsed;
+    }
+    Vector k2 = f(current + dt * a21 * k1);
+    Vector k3 = f(current + dt * (a31 * k1 + a32 * k2));
+    Vector k4 = f(current + dt * (a41 * k1 + a42 * k2 + a43 * k3));
+    Vector k5 = f(current + dt * (a51 * k1 + a52 * k2 + a53 * k3 + a54 * k4));
+    Vector k6 = f(current + dt * (a61 * k1 + a62 * k2 + a63 * k3 + a64 * k4 + a65 * k5));
+    Vector next = current + dt * (b1 * k1 + b3 * k3 + b4 * k4 + b5 * k5 + b6 * k6);
+    Vector k7 = f(next);
+    evaluations += 6;
+    Vector error = dt * (e1 * k1 + e3 * k3 + e4 * k4 + e5 * k5 + e6 * k6 + e7 * k7);
+    Vector scale = Vector::Constant(abs_tol) + rel_tol * current.cwiseAbs().cwiseMax(next.cwiseAbs());
+    double error_ratio = error.cwiseQuotient(scale).cwiseAbs().maxCoeff();
+    if (error_ratio <= 1 || dt <= min_step)
+    {
+      elapsed = last ? duration : elapsed + dt;
+      current = next;
+      k1 = k7;
+    }
+    // Standard step size control with safety factor
+    double factor = error_ratio > 0 ? 0.9 * std::pow(error_ratio, -0.2) : 5;
+    dt = std::max(min_step, dt * std::min(5.0, std::max(0.2, factor)));
+  }
+  if (nb_evaluations != nullptr)
+  {
+    *nb_evaluations += evaluations;
+  }
+  return current;
+}
+
+}  // namespace csa_mdp
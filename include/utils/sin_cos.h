@@ -0,0 +1,14 @@
+#pragma once
+
+namespace csa_mdp
+{
+/// Compute the sine and the cosine of the n angles of x
+///
+/// With AVX2, angles are processed by groups of 4: they are reduced to
+/// [-pi/4, pi/4] and both functions are approximated by polynomials (fdlibm
+/// kernels), the error is below 1e-15. Groups containing an angle larger than
+/// 1e5 or not finite, remaining angles and builds without AVX2 rely on
+/// std::sin and std::cos.
+void sinCos(int n, const double* x, double* sin_x, double* cos_x);
+
+}  // namespace csa_mdp
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <random>
+
+namespace csa_mdp
+{
+/// Sampling of the standard normal distribution with the ziggurat method of
+/// Marsaglia and Tsang (2000), using 128 layers.
+///
+/// Most samples require a single call to the engine and a comparison, which is
+/// significantly cheaper than std::normal_distribution. Since
+/// std::default_random_engine only provides 31 random bits, the signed integer
+/// used by the method has 31 bits instead of 32.
+class ZigguratNormal
+{
+public:
+  /// Draw a sample from N(0,1)
+  static double sample(std::default_random_engine* engine);
+
+  /// Fill dst with nb_samples independent samples from N(0,1), the engine is
+  /// used exactly as with nb_samples successive calls to sample. Samples are
+  /// not vectorized: std::default_random_engine is a sequential generator and
+  /// the rejection step uses a variable number of draws, vectorizing would
+  /// require independent engines and break this equivalence
+  static void fill(double* dst, int nb_samples, std::default_random_engine* engine);
+
+private:
+  struct Tables
+  {
+    Tables();
+
+    /// Thresholds below which a sample is accepted without further test
+    unsigned int k[128];
+    /// Width of the layers divided by the range of the integers
+    double w[128];
+    /// Density of the normal distribution at the limit of each layer
+    double f[128];
+  };
+
+  static const Tables& getTables();
+
+  static double sample(const Tables& tables, std::default_random_engine* engine);
+
+  /// Handle the samples rejected by the fast test
+  static double sampleSlow(const Tables& tables, int hz, int iz, std::default_random_engine* engine);
+
+  /// Draw a signed integer uniformly in [-2^30, 2^30)
+  static int drawInt(std::default_random_engine* engine);
+
+  /// Draw a double uniformly in (0, 1)
+  static double drawUniform(std::default_random_engine* engine);
+};
+
+}  // namespace csa_mdp
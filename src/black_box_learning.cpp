@@ -1,12 +1,8 @@
 #include "rhoban_csa_mdp/solvers/black_box_learner_factory.h"
 
-#include "policies/expert_approach.h"
-#include "policies/mixed_approach.h"
-#include "policies/ok_seed.h"
+#include "policies/extended_policy_factory.h"
 #include "problems/extended_problem_factory.h"
 
-#include "rhoban_csa_mdp/core/policy_factory.h"
-
 #include "rhoban_random/tools.h"
 
 #include <fenv.h>
@@ -24,9 +20,7 @@ int main(int argc, char** argv)
   // Abort if error are found
   feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
 
-  PolicyFactory::registerExtraBuilder("ExpertApproach", []() { return std::unique_ptr<Policy>(new ExpertApproach); });
-  PolicyFactory::registerExtraBuilder("OKSeed", []() { return std::unique_ptr<Policy>(new OKSeed); });
-  PolicyFactory::registerExtraBuilder("MixedApproach", []() { return std::unique_ptr<Policy>(new MixedApproach); });
+  ExtendedPolicyFactory::registerExtraPolicies();
 
   ExtendedProblemFactory::registerExtraProblems();
 
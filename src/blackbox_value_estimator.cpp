@@ -1,9 +1,9 @@
 #include "rhoban_csa_mdp/solvers/black_box_learner_factory.h"
 
-#include "policies/expert_approach.h"
-#include "policies/mixed_approach.h"
-#include "policies/ok_seed.h"
+#include "policies/extended_policy_factory.h"
 #include "problems/extended_problem_factory.h"
+#include "problems/simulated_cart_pole_pool.h"
+#include "problems/symmetric_problem.h"
 
 #include "rhoban_csa_mdp/core/policy_factory.h"
 #include "rhoban_fa/trainer_factory.h"
@@ -11,6 +11,7 @@
 #include "rhoban_utils/threading/multi_core.h"
 
 #include <fenv.h>
+#include <sstream>
 
 namespace csa_mdp
 {
@@ -18,7 +19,16 @@ class BlackboxValueEstimator : public rhoban_utils::JsonSerializable
 {
 public:
   /// Dummy constructor
-  BlackboxValueEstimator() : nb_samples(1000), evals_per_sample(1), nb_threads(1), horizon(100), discount(1.0)
+  BlackboxValueEstimator()
+    : nb_samples(1000)
+    , evals_per_sample(1)
+    , nb_threads(1)
+    , horizon(100)
+    , discount(1.0)
+    , use_symmetry(false)
+    , nb_symmetry_checks(100)
+    , symmetry_tolerance(1e-6)
+    , batch_simulation(true)
   {
   }
 
@@ -29,8 +39,10 @@ public:
     /// Initializing local variables
     inputs = Eigen::MatrixXd::Zero(input_dims, nb_samples);
     observations = Eigen::MatrixXd::Zero(nb_samples, 1);
+    // When using symmetry, only the first half of the samples is simulated
+    int nb_simulated = use_symmetry ? (nb_samples + 1) / 2 : nb_samples;
     std::vector<std::default_random_engine> engines =
-        rhoban_random::getRandomEngines(std::min(nb_threads, nb_samples), engine);
+        rhoban_random::getRandomEngines(std::min(nb_threads, nb_simulated), engine);
     // The task which has to be performed :
     rhoban_utils::MultiCore::StochasticTask task = [this, &inputs, &observations,
                                                     input_dims](int start_idx, int end_idx,
@@ -41,6 +53,11 @@ public:
       // Sampling initial states
       inputs.block(0, start_idx, input_dims, thread_samples) =
           rhoban_random::getUniformSamplesMatrix(limits, thread_samples, thread_engine);
+      if (cart_pole && batch_simulation)
+      {
+        simulateCartPoles(inputs, start_idx, end_idx, observations, thread_engine);
+        return;
+      }
       for (int idx = start_idx; idx < end_idx; idx++)
       {
         const Eigen::VectorXd& state = inputs.col(idx);
@@ -54,7 +71,85 @@ public:
       }
     };
     // Running computation
-    rhoban_utils::MultiCore::runParallelStochasticTask(task, nb_samples, &engines);
+    rhoban_utils::MultiCore::runParallelStochasticTask(task, nb_simulated, &engines);
+    // Mirrored states have the same value
+    if (use_symmetry)
+    {
+      const SymmetricProblem& symmetric_problem = dynamic_cast<const SymmetricProblem&>(*problem);
+      for (int idx = nb_simulated; idx < nb_samples; idx++)
+      {
+        inputs.col(idx) = symmetric_problem.mirrorState(inputs.col(idx - nb_simulated));
+        observations(idx, 0) = observations(idx - nb_simulated, 0);
+      }
+    }
+  }
+
+  /// Compute the observations of the samples in [start_idx, end_idx) by
+  /// simulating all their rollouts together in a SimulatedCartPolePool
+  void simulateCartPoles(const Eigen::MatrixXd& inputs, int start_idx, int end_idx, Eigen::MatrixXd& observations,
+                         std::default_random_engine* engine) const
+  {
+    int nb_envs = (end_idx - start_idx) * evals_per_sample;
+    SimulatedCartPolePool pool(cart_pole, nb_envs);
+    // Environment 'env' is the evaluation 'env % evals_per_sample' of sample 'start_idx + env / evals_per_sample'
+    for (int env = 0; env < nb_envs; env++)
+    {
+      pool.setState(env, inputs.col(start_idx + env / evals_per_sample));
+    }
+    Eigen::ArrayXd returns = Eigen::ArrayXd::Zero(nb_envs);
+    Eigen::ArrayXd cmds = Eigen::ArrayXd::Zero(nb_envs);
+    // Finished rollouts are reset to avoid simulating diverging states, their commands are ignored
+    Eigen::Array<bool, -1, 1> finished = Eigen::Array<bool, -1, 1>::Zero(nb_envs);
+    double gain = 1;
+    for (int step = 0; step < horizon && !finished.all(); step++)
+    {
+      for (int env = 0; env < nb_envs; env++)
+      {
+        cmds(env) = finished(env) ? 0 : policy->getAction(pool.getState(env), engine)(1);
+      }
+      pool.step(cmds, engine);
+      returns += (!finished).select(gain * pool.getRewards(), 0);
+      finished = finished || pool.getTerminal();
+      pool.resetTerminated(engine);
+      gain *= discount;
+    }
+    for (int idx = start_idx; idx < end_idx; idx++)
+    {
+      observations(idx, 0) = returns.segment((idx - start_idx) * evals_per_sample, evals_per_sample).mean();
+    }
+  }
+
+  /// Throws if the problem is not symmetric or if the policy does not commute
+  /// with the mirroring, i.e. policy(mirror(s)) != mirror(policy(s)) on one of
+  /// 'nb_symmetry_checks' random states. Both actions are computed with
+  /// engines sharing the same seed, stochastic policies can therefore only
+  /// pass if they mirror their noise too.
+  void checkSymmetry() const
+  {
+    const SymmetricProblem* symmetric_problem = dynamic_cast<const SymmetricProblem*>(problem.get());
+    if (symmetric_problem == nullptr || !symmetric_problem->hasSymmetry())
+    {
+      throw std::runtime_error("BlackboxValueEstimator::checkSymmetry: use_symmetry is enabled but problem is not "
+                               "symmetric");
+    }
+    std::default_random_engine engine;
+    Eigen::MatrixXd states =
+        rhoban_random::getUniformSamplesMatrix(problem->getStateLimits(), nb_symmetry_checks, &engine);
+    for (int idx = 0; idx < nb_symmetry_checks; idx++)
+    {
+      Eigen::VectorXd state = states.col(idx);
+      std::default_random_engine engine_a(idx), engine_b(idx);
+      Eigen::VectorXd expected = symmetric_problem->mirrorAction(policy->getAction(state, &engine_a));
+      Eigen::VectorXd received = policy->getAction(symmetric_problem->mirrorState(state), &engine_b);
+      if (expected.rows() != received.rows() || (expected - received).cwiseAbs().maxCoeff() > symmetry_tolerance)
+      {
+        std::ostringstream oss;
+        oss << "BlackboxValueEstimator::checkSymmetry: use_symmetry is enabled but policy is not symmetric: in state "
+            << state.transpose() << ", mirrored action is " << expected.transpose()
+            << " while action in mirrored state is " << received.transpose();
+        throw std::runtime_error(oss.str());
+      }
+    }
   }
 
   std::unique_ptr<rhoban_fa::FunctionApproximator> trainApproximator(std::default_random_engine* engine) const
@@ -77,6 +172,10 @@ public:
     rhoban_utils::tryRead(v, "nb_threads", &nb_threads);
     rhoban_utils::tryRead(v, "horizon", &horizon);
     rhoban_utils::tryRead(v, "discount", &discount);
+    rhoban_utils::tryRead(v, "use_symmetry", &use_symmetry);
+    rhoban_utils::tryRead(v, "nb_symmetry_checks", &nb_symmetry_checks);
+    rhoban_utils::tryRead(v, "symmetry_tolerance", &symmetry_tolerance);
+    rhoban_utils::tryRead(v, "batch_simulation", &batch_simulation);
     // Getting problem (mandatory)
     std::shared_ptr<const Problem> tmp_problem;
     std::string problem_path;
@@ -94,6 +193,12 @@ public:
     {
       throw std::runtime_error("BlackBoxLearner::fromJson: problem is not a BlackBoxProblem");
     }
+    cart_pole = std::dynamic_pointer_cast<const SimulatedCartPole>(problem);
+    // Batch simulation requires a fixed-step integrator
+    if (cart_pole && cart_pole->getIntegrator().getMethod() == OdeIntegrator::Method::RK45)
+    {
+      cart_pole.reset();
+    }
     // Reading approximator (mandatory)
     approximator = rhoban_fa::TrainerFactory().read(v, "approximator", dir_name);
     // Reading policy (mandatory)
@@ -102,6 +207,10 @@ public:
     approximator->setNbThreads(nb_threads);
     // updating action limits for policy
     policy->setActionLimits(problem->getActionsLimits());
+    if (use_symmetry)
+    {
+      checkSymmetry();
+    }
   }
 
   std::string getClassName() const override
@@ -113,6 +222,10 @@ private:
   /// Blackbox problem
   std::shared_ptr<const BlackBoxProblem> problem;
 
+  /// Same as problem if it is a SimulatedCartPole which can be simulated by
+  /// batch, nullptr otherwise
+  std::shared_ptr<const SimulatedCartPole> cart_pole;
+
   /// Approximator used to train function approximator
   std::unique_ptr<rhoban_fa::Trainer> approximator;
 
@@ -136,6 +249,22 @@ private:
 
   /// Discount used for rollouts
   double discount;
+
+  /// If enabled, only half of the samples are simulated and the other half is
+  /// obtained by mirroring them. This requires both the problem and the policy
+  /// to be symmetric, the policy is checked on random states when loading
+  bool use_symmetry;
+
+  /// Number of random states on which the symmetry of the policy is checked
+  int nb_symmetry_checks;
+
+  /// Maximal difference between the mirrored action and the action in the
+  /// mirrored state
+  double symmetry_tolerance;
+
+  /// If enabled and problem is a SimulatedCartPole, the rollouts handled by a
+  /// thread are simulated together in a SimulatedCartPolePool
+  bool batch_simulation;
 };
 
 }  // namespace csa_mdp
@@ -147,9 +276,7 @@ int main()
   // Abort if error are found
   feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
 
-  PolicyFactory::registerExtraBuilder("expert_approach", []() { return std::unique_ptr<Policy>(new ExpertApproach); });
-  PolicyFactory::registerExtraBuilder("OKSeed", []() { return std::unique_ptr<Policy>(new OKSeed); });
-  PolicyFactory::registerExtraBuilder("mixed_approach", []() { return std::unique_ptr<Policy>(new MixedApproach); });
+  ExtendedPolicyFactory::registerExtraPolicies();
 
   ExtendedProblemFactory::registerExtraProblems();
 
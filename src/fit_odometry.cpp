@@ -0,0 +1,216 @@
+#include "odometry/odometry.h"
+
+#include "rhoban_bbo/optimizer_factory.h"
+#include "rhoban_random/tools.h"
+#include "rhoban_utils/threading/multi_core.h"
+
+#include <algorithm>
+#include <fenv.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace csa_mdp
+{
+/// Calibrate the parameters of an odometry model from logs of the robot.
+///
+/// Each log is a csv file containing a sequence of steps with the following
+/// columns (the first line is a header):
+/// order_x, order_y, order_theta, measured_x, measured_y, measured_theta
+/// with displacements expressed in the robot referential at the beginning of
+/// the step [m, m, rad].
+///
+/// The types of the displacement and noise models are taken from the initial
+/// odometry, their parameters are then optimized to maximize the
+/// log-likelihood of the measured displacements over all the logs. Sequences
+/// are evaluated in parallel.
+class OdometryFitter : public rhoban_utils::JsonSerializable
+{
+public:
+  /// A logged step
+  struct Step
+  {
+    Eigen::Vector3d order;
+    Eigen::Vector3d measured;
+  };
+
+  OdometryFitter() : nb_threads(1), output_path("odometry.json")
+  {
+  }
+
+  /// Return the log-likelihood of all the logs for the given odometry
+  double getLogLikelihood(const Odometry& model) const
+  {
+    std::vector<double> sequences_likelihood(sequences.size(), 0.0);
+    rhoban_utils::MultiCore::StochasticTask task = [this, &model, &sequences_likelihood](
+                                                       int start_idx, int end_idx, std::default_random_engine*) {
+      for (int idx = start_idx; idx < end_idx; idx++)
+      {
+        for (const Step& step : sequences[idx])
+        {
+          sequences_likelihood[idx] += model.getLogLikelihood(step.order, step.measured);
+        }
+      }
+    };
+    std::vector<std::default_random_engine> engines = thread_engines;
+    rhoban_utils::MultiCore::runParallelStochasticTask(task, sequences.size(), &engines);
+    double total = 0;
+    for (double likelihood : sequences_likelihood)
+    {
+      total += likelihood;
+    }
+    return total;
+  }
+
+  void run(std::default_random_engine* engine)
+  {
+    thread_engines = rhoban_random::getRandomEngines(std::min(nb_threads, (int)sequences.size()), engine);
+    int nb_steps = 0;
+    for (const std::vector<Step>& sequence : sequences)
+    {
+      nb_steps += sequence.size();
+    }
+    std::cout << "Fitting odometry on " << sequences.size() << " sequences (" << nb_steps << " steps)" << std::endl;
+    std::cout << "Initial log-likelihood: " << getLogLikelihood(odometry) << std::endl;
+    // Parameters outside of the bounds are penalized according to their
+    // distance to the bounds
+    rhoban_bbo::Optimizer::RewardFunc reward = [this](const Eigen::VectorXd& parameters, std::default_random_engine*) {
+      Odometry model = odometry;
+      double error = model.setParameters(parameters);
+      if (error > 0)
+      {
+        return -out_of_bounds_penalty * (1 + error);
+      }
+      return getLogLikelihood(model);
+    };
+    optimizer->setLimits(odometry.getParametersLimits());
+    Eigen::VectorXd best_parameters = optimizer->train(reward, odometry.getParameters(), engine);
+    double error = odometry.setParameters(best_parameters);
+    if (error > 0)
+    {
+      std::ostringstream oss;
+      oss << "OdometryFitter::run: optimizer returned out of bounds parameters: " << best_parameters.transpose();
+      throw std::runtime_error(oss.str());
+    }
+    std::cout << "Final log-likelihood: " << getLogLikelihood(odometry) << std::endl;
+    odometry.printParameters();
+    std::ofstream out(output_path);
+    if (!out.good())
+    {
+      throw std::runtime_error("OdometryFitter::run: failed to open '" + output_path + "'");
+    }
+    out << odometry.toJson().toStyledString();
+  }
+
+  Json::Value toJson() const override
+  {
+    throw std::logic_error("OdometryFitter::toJson: not implemented");
+  }
+
+  void fromJson(const Json::Value& v, const std::string& dir_name) override
+  {
+    rhoban_utils::tryRead(v, "nb_threads", &nb_threads);
+    rhoban_utils::tryRead(v, "output_path", &output_path);
+    // Initial model and optimizer are mandatory
+    odometry.read(v, "odometry", dir_name);
+    optimizer = rhoban_bbo::OptimizerFactory().read(v, "optimizer", dir_name);
+    // Reading logs
+    std::vector<std::string> log_paths = rhoban_utils::readVector<std::string>(v, "logs");
+    if (log_paths.size() == 0)
+    {
+      throw rhoban_utils::JsonParsingError("OdometryFitter::fromJson: logs should not be empty");
+    }
+    sequences.clear();
+    for (const std::string& path : log_paths)
+    {
+      sequences.push_back(readSequence(dir_name + path));
+    }
+  }
+
+  std::string getClassName() const override
+  {
+    return "OdometryFitter";
+  }
+
+private:
+  /// Read the steps from a csv file
+  static std::vector<Step> readSequence(const std::string& path)
+  {
+    std::ifstream in(path);
+    if (!in.good())
+    {
+      throw std::runtime_error("OdometryFitter::readSequence: failed to open '" + path + "'");
+    }
+    std::vector<Step> steps;
+    std::string line;
+    // Skipping header
+    std::getline(in, line);
+    int line_no = 1;
+    while (std::getline(in, line))
+    {
+      line_no++;
+      if (line.find_first_not_of(" \t\r") == std::string::npos)
+      {
+        continue;
+      }
+      std::replace(line.begin(), line.end(), ',', ' ');
+      std::istringstream iss(line);
+      Step step;
+      iss >> step.order.x() >> step.order.y() >> step.order.z() >> step.measured.x() >> step.measured.y() >>
+          step.measured.z();
+      if (iss.fail())
+      {
+        std::ostringstream oss;
+        oss << "OdometryFitter::readSequence: invalid line " << line_no << " in '" << path << "'";
+        throw std::runtime_error(oss.str());
+      }
+      steps.push_back(step);
+    }
+    return steps;
+  }
+
+  /// Reward associated to parameters out of bounds
+  static constexpr double out_of_bounds_penalty = 1e12;
+
+  /// Initial model, contains the best parameters after run
+  Odometry odometry;
+
+  /// The optimizer used to find the parameters
+  std::unique_ptr<rhoban_bbo::Optimizer> optimizer;
+
+  /// Steps of each log
+  std::vector<std::vector<Step>> sequences;
+
+  int nb_threads;
+
+  /// Engines used for parallel evaluation of the sequences (unused by the
+  /// evaluation itself)
+  std::vector<std::default_random_engine> thread_engines;
+
+  /// Where the calibrated odometry is written
+  std::string output_path;
+};
+
+}  // namespace csa_mdp
+
+using namespace csa_mdp;
+
+int main(int argc, char** argv)
+{
+  std::string config_path("OdometryFitter.json");
+  if (argc >= 2)
+  {
+    config_path = argv[1];
+  }
+
+  // Abort if error are found
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+
+  OdometryFitter fitter;
+  fitter.loadFile(config_path);
+
+  std::default_random_engine engine = rhoban_random::getRandomEngine();
+  fitter.run(&engine);
+
+  exit(EXIT_SUCCESS);
+}
@@ -1,5 +1,7 @@
 #include "kick_model/classic_kick.h"
 
+#include "kick_model/kick_outcome_table.h"
+
 #include <math.h>
 
 using namespace rhoban_utils;
@@ -29,6 +31,11 @@ Eigen::Vector2d ClassicKick::applyKick(const Eigen::Vector2d& ball_pos, double k
                                        const Eigen::VectorXd& kick_parameters, std::default_random_engine* engine) const
 {
   (void)kick_parameters;
+  // Pre-sampled outcomes are used when available
+  if (engine != nullptr && outcome_table)
+  {
+    return outcome_table->applyKick(ball_pos, kick_dir, engine);
+  }
   double kick_real_dist = kick_power;
   double kick_real_dir = kick_dir;
   // If engine has been provided, apply noise
@@ -55,6 +62,25 @@ Eigen::Vector2d ClassicKick::applyKick(const Eigen::Vector2d& ball_pos, double k
   return final_pos;
 }
 
+int ClassicKick::getNbNoiseSources() const
+{
+  return 3;
+}
+
+Eigen::Vector2d ClassicKick::getOutcomeFromQuantiles(const Eigen::VectorXd& quantiles) const
+{
+  if (quantiles.rows() != 3)
+  {
+    throw std::logic_error("ClassicKick::getOutcomeFromQuantiles: expecting 3 quantiles");
+  }
+  // Same distributions as in applyKick
+  double theta_tol = 10 * M_PI / 180;
+  double dir_offset = -theta_tol + 2 * theta_tol * quantiles(0);
+  dir_offset += dir_stddev * KickOutcomeTable::normalQuantile(quantiles(1));
+  double dist = kick_power * (1 + rel_dist_stddev * KickOutcomeTable::normalQuantile(quantiles(2)));
+  return Eigen::Vector2d(dist, dir_offset);
+}
+
 Eigen::Vector2d ClassicKick::getKickInSelf(const Eigen::Vector2d& ball_pos, bool right_kick) const
 {
   double kick_dir = right_kick ? right_kick_dir : -right_kick_dir;
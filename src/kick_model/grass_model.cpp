@@ -29,6 +29,16 @@ void GrassModel::setConeOffset(double cone_offset)
   coneOffset = cone_offset;
 }
 
+bool GrassModel::isSymmetric() const
+{
+  if (ratio == 1 || coneWidth <= 0)
+  {
+    return true;
+  }
+  // Cone has to be centered on 0 or 180 [deg]
+  return std::fmod(coneOffset, 180) == 0;
+}
+
 Json::Value GrassModel::toJson() const
 {
   Json::Value v;
@@ -16,4 +16,9 @@ const std::vector<std::string>& KickDecisionModel::getActionsNames() const
   return action_names;
 }
 
+Eigen::VectorXd KickDecisionModel::mirrorActions(const Eigen::VectorXd& actions) const
+{
+  return -actions;
+}
+
 }  // namespace csa_mdp
@@ -1,5 +1,7 @@
 #include "kick_model/kick_model.h"
 
+#include "kick_model/kick_outcome_table.h"
+
 namespace csa_mdp
 {
 KickModel::KickModel() : kick_reward(-10)
@@ -40,6 +42,23 @@ Eigen::Vector2d KickModel::applyKick(const Eigen::Vector2d& ball_pos, double kic
 void KickModel::setGrassModel(GrassModel grassModel_)
 {
   grassModel = grassModel_;
+  outcome_table.reset();
+}
+
+int KickModel::getNbNoiseSources() const
+{
+  return 0;
+}
+
+Eigen::Vector2d KickModel::getOutcomeFromQuantiles(const Eigen::VectorXd& quantiles) const
+{
+  (void)quantiles;
+  throw std::logic_error("KickModel::getOutcomeFromQuantiles: not implemented for '" + getClassName() + "'");
+}
+
+void KickModel::setOutcomeTable(std::shared_ptr<const KickOutcomeTable> table)
+{
+  outcome_table = table;
 }
 
 Json::Value KickModel::toJson() const
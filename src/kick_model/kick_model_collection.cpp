@@ -1,10 +1,14 @@
 #include "kick_model/kick_model_collection.h"
 
 #include "kick_model/kick_model_factory.h"
+#include "kick_model/kick_outcome_table.h"
+
+#include "rhoban_random/tools.h"
 
 namespace csa_mdp
 {
 KickModelCollection::KickModelCollection()
+  : nb_outcome_samples(0), outcome_grass_resolution(3600), outcome_seed(-1)
 {
 }
 
@@ -46,6 +50,11 @@ void KickModelCollection::fromJson(const Json::Value& v, const std::string& dir_
   {
     entry.second->setGrassModel(grassModel);
   }
+
+  rhoban_utils::tryRead(v, "nb_outcome_samples", &nb_outcome_samples);
+  rhoban_utils::tryRead(v, "outcome_grass_resolution", &outcome_grass_resolution);
+  rhoban_utils::tryRead(v, "outcome_seed", &outcome_seed);
+  buildOutcomeTables();
 }
 
 void KickModelCollection::setGrassConeOffset(double offset)
@@ -55,6 +64,36 @@ void KickModelCollection::setGrassConeOffset(double offset)
   {
     entry.second->setGrassModel(grassModel);
   }
+  buildOutcomeTables();
+}
+
+bool KickModelCollection::isSymmetric() const
+{
+  // Noise of the kicks is symmetric, only the grass might break the symmetry
+  return grassModel.isSymmetric();
+}
+
+void KickModelCollection::buildOutcomeTables()
+{
+  if (nb_outcome_samples <= 0)
+  {
+    return;
+  }
+  std::default_random_engine engine;
+  if (outcome_seed >= 0)
+  {
+    engine.seed(outcome_seed);
+  }
+  else
+  {
+    engine = rhoban_random::getRandomEngine();
+  }
+  for (auto& entry : models)
+  {
+    std::shared_ptr<KickOutcomeTable> table(new KickOutcomeTable());
+    table->build(*entry.second, grassModel, nb_outcome_samples, outcome_grass_resolution, &engine);
+    entry.second->setOutcomeTable(table);
+  }
 }
 
 std::string KickModelCollection::getClassName() const
@@ -0,0 +1,126 @@
+#include "kick_model/kick_outcome_table.h"
+
+#include "kick_model/kick_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace csa_mdp
+{
+KickOutcomeTable::KickOutcomeTable() : grass_bins_per_rad(0)
+{
+}
+
+void KickOutcomeTable::build(const KickModel& model, const GrassModel& grass, int nb_samples, int grass_resolution,
+                             std::default_random_engine* engine)
+{
+  if (nb_samples <= 0 || grass_resolution <= 0)
+  {
+    std::ostringstream oss;
+    oss << "KickOutcomeTable::build: invalid sizes: nb_samples=" << nb_samples
+        << ", grass_resolution=" << grass_resolution;
+    throw std::logic_error(oss.str());
+  }
+  // Latin hypercube: each noise source is split in nb_samples strata, strata
+  // are shuffled independently for each source
+  int nb_sources = model.getNbNoiseSources();
+  std::vector<std::vector<int>> strata(nb_sources);
+  for (int source = 0; source < nb_sources; source++)
+  {
+    strata[source].resize(nb_samples);
+    for (int i = 0; i < nb_samples; i++)
+    {
+      strata[source][i] = i;
+    }
+    std::shuffle(strata[source].begin(), strata[source].end(), *engine);
+  }
+  outcomes.resize(nb_samples);
+  Eigen::VectorXd quantiles(nb_sources);
+  for (int i = 0; i < nb_samples; i++)
+  {
+    for (int source = 0; source < nb_sources; source++)
+    {
+      quantiles(source) = (strata[source][i] + 0.5) / nb_samples;
+    }
+    Eigen::Vector2d outcome = model.getOutcomeFromQuantiles(quantiles);
+    double dist = outcome(0);
+    double dir_offset = outcome(1);
+    outcomes[i].dx = dist * cos(dir_offset);
+    outcomes[i].dy = dist * sin(dir_offset);
+    outcomes[i].dir_offset = dir_offset;
+  }
+  // Grass reduction is evaluated at the center of each bin
+  grass_factors.resize(grass_resolution);
+  grass_bins_per_rad = grass_resolution / (2 * M_PI);
+  for (int i = 0; i < grass_resolution; i++)
+  {
+    double dir = -M_PI + (i + 0.5) / grass_bins_per_rad;
+    grass_factors[i] = grass.kickReduction(180 * dir / M_PI);
+  }
+}
+
+int KickOutcomeTable::size() const
+{
+  return outcomes.size();
+}
+
+Eigen::Vector2d KickOutcomeTable::applyKick(const Eigen::Vector2d& ball_pos, double kick_dir,
+                                            std::default_random_engine* engine) const
+{
+  std::uniform_int_distribution<int> index_distrib(0, outcomes.size() - 1);
+  const Outcome& outcome = outcomes[index_distrib(*engine)];
+  // Grass reduction depends on the real direction of the kick
+  double real_dir = kick_dir + outcome.dir_offset;
+  real_dir -= 2 * M_PI * std::floor((real_dir + M_PI) / (2 * M_PI));
+  int bin = std::min((int)((real_dir + M_PI) * grass_bins_per_rad), (int)grass_factors.size() - 1);
+  double factor = grass_factors[bin];
+  double c = cos(kick_dir);
+  double s = sin(kick_dir);
+  return Eigen::Vector2d(ball_pos(0) + factor * (c * outcome.dx - s * outcome.dy),
+                         ball_pos(1) + factor * (s * outcome.dx + c * outcome.dy));
+}
+
+double KickOutcomeTable::normalQuantile(double p)
+{
+  if (p <= 0 || p >= 1)
+  {
+    throw std::logic_error("KickOutcomeTable::normalQuantile: p should be in ]0,1[");
+  }
+  // Rational approximation from P. J. Acklam, followed by one step of Halley's
+  // method to reach full double precision
+  static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                              1.383577518672690e+02,  -3.066479806614716e+01, 2.506628277459239e+00 };
+  static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                              6.680131188771972e+01, -1.328068155288572e+01 };
+  static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                              -2.549732539343734e+00, 4.374664141464968e+00,  2.938163982698783e+00 };
+  static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                              3.754408661907416e+00 };
+  double p_low = 0.02425;
+  double x;
+  if (p < p_low)
+  {
+    double q = sqrt(-2 * log(p));
+    x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+        ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+  }
+  else if (p <= 1 - p_low)
+  {
+    double q = p - 0.5;
+    double r = q * q;
+    x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+        (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+  }
+  else
+  {
+    double q = sqrt(-2 * log(1 - p));
+    x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+        ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+  }
+  double e = 0.5 * std::erfc(-x / M_SQRT2) - p;
+  double u = e * sqrt(2 * M_PI) * exp(x * x / 2);
+  return x - u / (1 + x * u / 2);
+}
+
+}  // namespace csa_mdp
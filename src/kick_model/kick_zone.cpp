@@ -73,6 +73,17 @@ double KickZone::getThetaTol() const
   return kick_theta_tol;
 }
 
+Eigen::Matrix<double, 3, 2> KickZone::getKickBox(bool right_foot) const
+{
+  // Left foot is centered on (kick_y_offset, -kick_theta_offset), see canKickLeftFoot
+  double y_center = right_foot ? -kick_y_offset : kick_y_offset;
+  double theta_center = right_foot ? kick_theta_offset : -kick_theta_offset;
+  Eigen::Matrix<double, 3, 2> box;
+  box << kick_x_min, kick_x_max, y_center - kick_y_tol, y_center + kick_y_tol, theta_center - kick_theta_tol,
+      theta_center + kick_theta_tol;
+  return box;
+}
+
 bool KickZone::isKickable(const Eigen::Vector3d& state) const
 {
   return canKick(true, state) || canKick(false, state);
@@ -131,9 +142,11 @@ Eigen::Vector3d KickZone::convertWorldStateToKickState(const Eigen::Vector2d& ba
   double dx = ball_pos(0) - player_state(0);
   double dy = ball_pos(1) - player_state(1);
   double player_dir = player_state(2);
+  double cos_dir = cos(player_dir);
+  double sin_dir = sin(player_dir);
   Eigen::Vector3d state_in_self;
-  state_in_self(0) = dx * cos(player_dir) + dy * sin(player_dir);
-  state_in_self(1) = -dx * sin(player_dir) + dy * cos(player_dir);
+  state_in_self(0) = dx * cos_dir + dy * sin_dir;
+  state_in_self(1) = -dx * sin_dir + dy * cos_dir;
   state_in_self(2) = kick_dir - player_dir;
   return state_in_self;
 }
@@ -0,0 +1,113 @@
+#include "kick_model/kick_zone_set.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace csa_mdp
+{
+/**
+ * Return the given angle in radian
+ * bounded between -PI and PI
+ */
+static double normalizeAngle(double angle)
+{
+  return angle - 2.0 * M_PI * std::floor((angle + M_PI) / (2.0 * M_PI));
+}
+
+KickZoneSet::KickZoneSet() : nb_zones(0)
+{
+}
+
+void KickZoneSet::clear()
+{
+  nb_zones = 0;
+  x_min.clear();
+  x_max.clear();
+  y_min.clear();
+  y_max.clear();
+  theta_min.clear();
+  theta_max.clear();
+  zone_ids.clear();
+}
+
+void KickZoneSet::add(const KickZone& zone)
+{
+  double inf = std::numeric_limits<double>::infinity();
+  for (bool right_foot : { false, true })
+  {
+    Eigen::Matrix<double, 3, 2> box = zone.getKickBox(right_foot);
+    double half_width = (box(2, 1) - box(2, 0)) / 2;
+    double center = normalizeAngle(box(2, 0) + half_width);
+    double low = center - half_width;
+    double high = center + half_width;
+    if (half_width >= M_PI)
+    {
+      pushBox(nb_zones, box, -inf, inf);
+    }
+    else if (high > M_PI)
+    {
+      pushBox(nb_zones, box, low, inf);
+      pushBox(nb_zones, box, -inf, high - 2 * M_PI);
+    }
+    else if (low < -M_PI)
+    {
+      pushBox(nb_zones, box, low + 2 * M_PI, inf);
+      pushBox(nb_zones, box, -inf, high);
+    }
+    else
+    {
+      pushBox(nb_zones, box, low, high);
+    }
+  }
+  nb_zones++;
+}
+
+int KickZoneSet::nbZones() const
+{
+  return nb_zones;
+}
+
+bool KickZoneSet::isKickable(const Eigen::Vector3d& state) const
+{
+  double x = state(0);
+  double y = state(1);
+  double theta = normalizeAngle(state(2));
+  // Bitwise operators avoid branching and allow vectorization of the loop
+  bool kickable = false;
+  for (size_t idx = 0; idx < zone_ids.size(); idx++)
+  {
+    kickable |= (x > x_min[idx]) & (x < x_max[idx]) & (y > y_min[idx]) & (y < y_max[idx]) &
+                (theta > theta_min[idx]) & (theta < theta_max[idx]);
+  }
+  return kickable;
+}
+
+int KickZoneSet::getKickableZone(const Eigen::Vector3d& state) const
+{
+  double x = state(0);
+  double y = state(1);
+  double theta = normalizeAngle(state(2));
+  int best_zone = nb_zones;
+  for (size_t idx = 0; idx < zone_ids.size(); idx++)
+  {
+    bool inside = (x > x_min[idx]) & (x < x_max[idx]) & (y > y_min[idx]) & (y < y_max[idx]) &
+                  (theta > theta_min[idx]) & (theta < theta_max[idx]);
+    best_zone = std::min(best_zone, inside ? zone_ids[idx] : nb_zones);
+  }
+  return best_zone == nb_zones ? -1 : best_zone;
+}
+
+void KickZoneSet::pushBox(int zone_id, const Eigen::Matrix<double, 3, 2>& box, double box_theta_min,
+                          double box_theta_max)
+{
+  x_min.push_back(box(0, 0));
+  x_max.push_back(box(0, 1));
+  y_min.push_back(box(1, 0));
+  y_max.push_back(box(1, 1));
+  theta_min.push_back(box_theta_min);
+  theta_max.push_back(box_theta_max);
+  zone_ids.push_back(zone_id);
+}
+
+}  // namespace csa_mdp
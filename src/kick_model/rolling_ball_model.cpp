@@ -1,24 +1,119 @@
 #include "kick_model/rolling_ball_model.h"
 
+#include <cmath>
+
 namespace csa_mdp
 {
+/// Below this friction, motion is considered as uniform
+static constexpr double min_friction = 1e-12;
+
 RollingBallModel::RollingBallModel() : decay_rate(0.9)
 {
 }
 
 Eigen::Vector4d RollingBallModel::getNextState(const Eigen::Vector4d& ball_state, double dt) const
 {
-  // Warning: two successives updateBall(dt) is not the same as updateBall(2*dt)
-  const Eigen::Vector2d& ball_pos = ball_state.segment(0, 2);
-  const Eigen::Vector2d& ball_speed = ball_state.segment(2, 2);
-  Eigen::Vector2d next_speed = ball_speed * (1 - (1 - decay_rate) * dt);
-  Eigen::Vector2d avg_speed = (ball_speed + next_speed) / 2;
+  double friction = 1 - decay_rate;
   Eigen::Vector4d result;
-  result.segment(0, 2) = avg_speed * dt + ball_pos;
-  result.segment(2, 2) = next_speed;
+  result.segment<2>(0) = ball_state.segment<2>(0) + ball_state.segment<2>(2) * getTravelFactor(dt);
+  result.segment<2>(2) = ball_state.segment<2>(2) * std::exp(-friction * dt);
   return result;
 }
 
+Eigen::Matrix4d RollingBallModel::getJacobian(double dt) const
+{
+  double friction = 1 - decay_rate;
+  Eigen::Matrix4d jacobian = Eigen::Matrix4d::Identity();
+  jacobian.block<2, 2>(0, 2) = Eigen::Matrix2d::Identity() * getTravelFactor(dt);
+  jacobian.block<2, 2>(2, 2) = Eigen::Matrix2d::Identity() * std::exp(-friction * dt);
+  return jacobian;
+}
+
+bool RollingBallModel::getLineIntercept(const Eigen::Vector4d& ball_state, const Eigen::Vector2d& point,
+                                        const Eigen::Vector2d& normal, double* time, Eigen::Vector2d* position) const
+{
+  double signed_dist = normal.dot(ball_state.segment<2>(0) - point);
+  if (signed_dist == 0)
+  {
+    *time = 0;
+    *position = ball_state.segment<2>(0);
+    return true;
+  }
+  double normal_speed = normal.dot(ball_state.segment<2>(2));
+  // Ball has to move toward the line
+  if (normal_speed == 0 || (signed_dist > 0) == (normal_speed > 0))
+  {
+    return false;
+  }
+  double factor = -signed_dist / normal_speed;
+  double t = getTimeFromTravelFactor(factor);
+  if (t < 0)
+  {
+    return false;
+  }
+  *time = t;
+  *position = ball_state.segment<2>(0) + ball_state.segment<2>(2) * factor;
+  return true;
+}
+
+bool RollingBallModel::getCircleIntercept(const Eigen::Vector4d& ball_state, const Eigen::Vector2d& center,
+                                          double radius, double* time, Eigen::Vector2d* position) const
+{
+  Eigen::Vector2d offset = ball_state.segment<2>(0) - center;
+  const Eigen::Vector2d& speed = ball_state.segment<2>(2);
+  // Solving |offset + speed * factor|^2 = radius^2 for the travel factor
+  double c = offset.squaredNorm() - radius * radius;
+  if (c <= 0)
+  {
+    *time = 0;
+    *position = ball_state.segment<2>(0);
+    return true;
+  }
+  double a = speed.squaredNorm();
+  double b = speed.dot(offset);
+  double discriminant = b * b - a * c;
+  // Ball moves away from the circle or misses it
+  if (b >= 0 || discriminant < 0)
+  {
+    return false;
+  }
+  // Smallest root, written to avoid cancellation
+  double factor = c / (-b + std::sqrt(discriminant));
+  double t = getTimeFromTravelFactor(factor);
+  if (t < 0)
+  {
+    return false;
+  }
+  *time = t;
+  *position = ball_state.segment<2>(0) + speed * factor;
+  return true;
+}
+
+double RollingBallModel::getTravelFactor(double t) const
+{
+  double friction = 1 - decay_rate;
+  if (std::fabs(friction) < min_friction)
+  {
+    return t;
+  }
+  return -std::expm1(-friction * t) / friction;
+}
+
+double RollingBallModel::getTimeFromTravelFactor(double factor) const
+{
+  double friction = 1 - decay_rate;
+  if (std::fabs(friction) < min_friction)
+  {
+    return factor;
+  }
+  // With positive friction, the ball stops after a travel factor of 1/friction
+  if (friction * factor >= 1)
+  {
+    return -1;
+  }
+  return -std::log1p(-friction * factor) / friction;
+}
+
 Json::Value RollingBallModel::toJson() const
 {
   Json::Value v;
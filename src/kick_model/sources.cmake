@@ -9,7 +9,9 @@ set(SOURCES
   kick_model.cpp
   kick_model_collection.cpp
   kick_model_factory.cpp
+  kick_outcome_table.cpp
   kick_zone.cpp
+  kick_zone_set.cpp
   grass_model.cpp
   rolling_ball_model.cpp
 )
@@ -0,0 +1,252 @@
+#include "policies/kick_grid_policy.h"
+#include "problems/extended_problem_factory.h"
+#include "problems/kick_controler.h"
+
+#include "rhoban_random/tools.h"
+#include "rhoban_utils/threading/multi_core.h"
+
+#include <algorithm>
+#include <fenv.h>
+#include <iostream>
+#include <limits>
+
+namespace csa_mdp
+{
+/// Solve the KickControler problem without players by value iteration on a
+/// discretization of the field.
+///
+/// For each couple (cell, action), the transition is estimated once by sampling
+/// successors from the center of the cell, successors are then associated to
+/// the cell containing them. Using the pre-sampled kick outcomes of the
+/// KickModelCollection strongly reduces the cost of this step.
+class KickValueIteration : public rhoban_utils::JsonSerializable
+{
+public:
+  /// Estimated transition for a couple (cell, action)
+  struct Transition
+  {
+    /// Average reward (including terminal rewards)
+    double reward;
+    /// Non-terminal successors and their probabilities
+    std::vector<int> successors;
+    std::vector<double> probabilities;
+  };
+
+  KickValueIteration()
+    : nb_cells_x(90)
+    , nb_cells_y(60)
+    , nb_values_per_dim(31)
+    , samples_per_transition(200)
+    , discount(1.0)
+    , max_iterations(1000)
+    , tolerance(1e-4)
+    , nb_threads(1)
+    , output_path("kick_grid.csv")
+  {
+  }
+
+  /// Estimate all the transitions
+  void computeTransitions(std::default_random_engine* engine)
+  {
+    int nb_cells = grid.getNbCells();
+    int nb_actions = actions.size();
+    transitions = std::vector<Transition>(nb_cells * nb_actions);
+    rhoban_utils::MultiCore::StochasticTask task = [this, nb_actions](int start_idx, int end_idx,
+                                                                      std::default_random_engine* thread_engine) {
+      std::vector<int> successors(samples_per_transition);
+      for (int cell = start_idx; cell < end_idx; cell++)
+      {
+        Eigen::VectorXd state = grid.getCellCenter(cell);
+        for (int action_id = 0; action_id < nb_actions; action_id++)
+        {
+          Transition& transition = transitions[cell * nb_actions + action_id];
+          double total_reward = 0;
+          int nb_successors = 0;
+          for (int sample = 0; sample < samples_per_transition; sample++)
+          {
+            Problem::Result result = problem->getSuccessor(state, actions[action_id], thread_engine);
+            total_reward += result.reward;
+            if (!result.terminal)
+            {
+              successors[nb_successors] = grid.getCellIndex(result.successor(0), result.successor(1));
+              nb_successors++;
+            }
+          }
+          transition.reward = total_reward / samples_per_transition;
+          // Grouping identical successors
+          std::sort(successors.begin(), successors.begin() + nb_successors);
+          for (int idx = 0; idx < nb_successors; idx++)
+          {
+            if (idx == 0 || successors[idx] != successors[idx - 1])
+            {
+              transition.successors.push_back(successors[idx]);
+              transition.probabilities.push_back(0);
+            }
+            transition.probabilities.back() += 1.0 / samples_per_transition;
+          }
+        }
+      }
+    };
+    std::vector<std::default_random_engine> engines =
+        rhoban_random::getRandomEngines(std::min(nb_threads, nb_cells), engine);
+    rhoban_utils::MultiCore::runParallelStochasticTask(task, nb_cells, &engines);
+  }
+
+  /// Return the expected value of applying the given action in the cell
+  double getQValue(int cell, int action_id, const std::vector<double>& values) const
+  {
+    const Transition& transition = transitions[cell * actions.size() + action_id];
+    double future = 0;
+    for (size_t idx = 0; idx < transition.successors.size(); idx++)
+    {
+      future += transition.probabilities[idx] * values[transition.successors[idx]];
+    }
+    return transition.reward + discount * future;
+  }
+
+  /// Run value iteration and fill the grid with values and greedy actions
+  void solve(std::default_random_engine* engine)
+  {
+    int nb_cells = grid.getNbCells();
+    int nb_actions = actions.size();
+    std::vector<double> values(nb_cells, 0.0), new_values(nb_cells, 0.0), diffs(nb_cells, 0.0);
+    std::vector<int> best_actions(nb_cells, 0);
+    std::vector<std::default_random_engine> engines =
+        rhoban_random::getRandomEngines(std::min(nb_threads, nb_cells), engine);
+    rhoban_utils::MultiCore::StochasticTask task = [this, nb_actions, &values, &new_values, &diffs, &best_actions](
+                                                       int start_idx, int end_idx, std::default_random_engine*) {
+      for (int cell = start_idx; cell < end_idx; cell++)
+      {
+        double best_value = std::numeric_limits<double>::lowest();
+        for (int action_id = 0; action_id < nb_actions; action_id++)
+        {
+          double q_value = getQValue(cell, action_id, values);
+          if (q_value > best_value)
+          {
+            best_value = q_value;
+            best_actions[cell] = action_id;
+          }
+        }
+        new_values[cell] = best_value;
+        diffs[cell] = std::fabs(best_value - values[cell]);
+      }
+    };
+    for (int iteration = 0; iteration < max_iterations; iteration++)
+    {
+      rhoban_utils::MultiCore::runParallelStochasticTask(task, nb_cells, &engines);
+      values.swap(new_values);
+      double max_diff = *std::max_element(diffs.begin(), diffs.end());
+      std::cout << "Iteration " << iteration << ": max diff " << max_diff << std::endl;
+      if (max_diff < tolerance)
+        break;
+    }
+    for (int cell = 0; cell < nb_cells; cell++)
+    {
+      grid.setCell(cell, values[cell], actions[best_actions[cell]]);
+    }
+  }
+
+  void run(std::default_random_engine* engine)
+  {
+    computeTransitions(engine);
+    solve(engine);
+    grid.save(output_path);
+  }
+
+  Json::Value toJson() const override
+  {
+    throw std::logic_error("KickValueIteration::toJson: not implemented");
+  }
+
+  void fromJson(const Json::Value& v, const std::string& dir_name) override
+  {
+    rhoban_utils::tryRead(v, "nb_cells_x", &nb_cells_x);
+    rhoban_utils::tryRead(v, "nb_cells_y", &nb_cells_y);
+    rhoban_utils::tryRead(v, "nb_values_per_dim", &nb_values_per_dim);
+    rhoban_utils::tryRead(v, "samples_per_transition", &samples_per_transition);
+    rhoban_utils::tryRead(v, "discount", &discount);
+    rhoban_utils::tryRead(v, "max_iterations", &max_iterations);
+    rhoban_utils::tryRead(v, "tolerance", &tolerance);
+    rhoban_utils::tryRead(v, "nb_threads", &nb_threads);
+    rhoban_utils::tryRead(v, "output_path", &output_path);
+    // Reading problem (mandatory)
+    std::unique_ptr<Problem> tmp_problem = ProblemFactory().read(v, "problem", dir_name);
+    if (dynamic_cast<KickControler*>(tmp_problem.get()) == nullptr)
+    {
+      throw std::runtime_error("KickValueIteration::fromJson: problem is not a KickControler");
+    }
+    problem.reset(dynamic_cast<KickControler*>(tmp_problem.release()));
+    if (problem->getNbPlayers() != 0)
+    {
+      throw std::runtime_error("KickValueIteration::fromJson: only problems without players are supported");
+    }
+    actions = problem->getDiscretizedActions(nb_values_per_dim);
+    grid.setGrid(problem->getStateLimits(), nb_cells_x, nb_cells_y);
+  }
+
+  std::string getClassName() const override
+  {
+    return "KickValueIteration";
+  }
+
+private:
+  std::unique_ptr<KickControler> problem;
+
+  /// The discretization of the field, values and greedy actions
+  KickGridPolicy grid;
+
+  /// All the actions considered
+  std::vector<Eigen::VectorXd> actions;
+
+  /// Transitions indexed by cell * nb_actions + action_id
+  std::vector<Transition> transitions;
+
+  /// Number of cells along each axis
+  int nb_cells_x;
+  int nb_cells_y;
+
+  /// Number of values for each dimension of the kick parameters
+  int nb_values_per_dim;
+
+  /// Number of successors sampled for each couple (cell, action)
+  int samples_per_transition;
+
+  double discount;
+
+  /// Maximal number of iterations of value iteration
+  int max_iterations;
+
+  /// Value iteration stops when the maximal update is below tolerance
+  double tolerance;
+
+  int nb_threads;
+
+  /// Where the value table and the greedy policy are written
+  std::string output_path;
+};
+
+}  // namespace csa_mdp
+
+using namespace csa_mdp;
+
+int main(int argc, char** argv)
+{
+  std::string config_path("KickValueIteration.json");
+  if (argc >= 2)
+  {
+    config_path = argv[1];
+  }
+
+  // Abort if error are found
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+
+  ExtendedProblemFactory::registerExtraProblems();
+
+  KickValueIteration solver;
+  solver.loadFile(config_path);
+
+  std::default_random_engine engine = rhoban_random::getRandomEngine();
+  solver.run(&engine);
+
+  exit(EXIT_SUCCESS);
+}
@@ -1,11 +1,6 @@
 #include "learning_machine/learning_machine_factory.h"
+#include "policies/extended_policy_factory.h"
 #include "problems/extended_problem_factory.h"
-#include "policies/expert_approach.h"
-#include "policies/mixed_approach.h"
-#include "policies/ok_seed.h"
-#include "policies/ssl_dynamic_ball_approach/sdba_mixed_policy.h"
-
-#include "rhoban_csa_mdp/core/policy_factory.h"
 
 using namespace csa_mdp;
 
@@ -18,10 +13,7 @@ int main(int argc, char** argv)
   }
 
   // Registering extra features from csa_mdp
-  PolicyFactory::registerExtraBuilder("ExpertApproach", []() { return std::unique_ptr<Policy>(new ExpertApproach); });
-  PolicyFactory::registerExtraBuilder("MixedApproach", []() { return std::unique_ptr<Policy>(new MixedApproach); });
-  PolicyFactory::registerExtraBuilder("OKSeed", []() { return std::unique_ptr<Policy>(new OKSeed); });
-  PolicyFactory::registerExtraBuilder("SDBAMixedPolicy", []() { return std::unique_ptr<Policy>(new SDBAMixedPolicy); });
+  ExtendedPolicyFactory::registerExtraPolicies();
 
   ExtendedProblemFactory::registerExtraProblems();
 
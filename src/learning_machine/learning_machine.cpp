@@ -1,5 +1,7 @@
 #include "learning_machine/learning_machine.h"
 
+#include "problems/symmetric_problem.h"
+
 #include "rhoban_csa_mdp/core/history.h"
 #include "rhoban_csa_mdp/core/problem_factory.h"
 #include "rhoban_csa_mdp/solvers/learner_factory.h"
@@ -37,6 +39,7 @@ LearningMachine::LearningMachine()
   , save_details(false)
   , save_run_logs(true)
   , save_best_policy(true)
+  , use_symmetry(false)
 {
 }
 
@@ -116,14 +119,30 @@ void LearningMachine::doStep()
   {
     writeRunLog(run_logs, run, step, last_state, cmd, status.reward);
   }
-  csa_mdp::Sample new_sample(getLearningState(last_state), cmd, getLearningState(status.successor), status.reward);
   // Add new sample
-  learner->feed(new_sample);
+  feedSample(last_state, cmd, status.successor, status.reward);
   trajectory_reward += status.reward;
   double disc_reward = status.reward * std::pow(discount, step);
   trajectory_disc_reward += disc_reward;
 }
 
+void LearningMachine::feedSample(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
+                                 const Eigen::VectorXd& next_state, double reward)
+{
+  learner->feed(csa_mdp::Sample(getLearningState(state), action, getLearningState(next_state), reward));
+  if (use_symmetry)
+  {
+    const SymmetricProblem* symmetric_problem = dynamic_cast<const SymmetricProblem*>(problem.get());
+    if (symmetric_problem == nullptr || !symmetric_problem->hasSymmetry())
+    {
+      throw std::logic_error("LearningMachine::feedSample: use_symmetry is enabled but problem is not symmetric");
+    }
+    learner->feed(csa_mdp::Sample(getLearningState(symmetric_problem->mirrorState(state)),
+                                  symmetric_problem->mirrorAction(action),
+                                  getLearningState(symmetric_problem->mirrorState(next_state)), reward));
+  }
+}
+
 void LearningMachine::init()
 {
   learner->setStart();
@@ -151,9 +170,7 @@ void LearningMachine::init()
     std::vector<csa_mdp::Sample> samples = History::getBatch(histories);
     for (const csa_mdp::Sample& s : samples)
     {
-      const csa_mdp::Sample learning_sample(getLearningState(s.state), s.action, getLearningState(s.next_state),
-                                            s.reward);
-      learner->feed(learning_sample);
+      feedSample(s.state, s.action, s.next_state, s.reward);
     }
     std::cout << "\tExperiments loaded" << std::endl;
     learner->internalUpdate();
@@ -389,6 +406,7 @@ Json::Value LearningMachine::toJson() const
   v["save_run_logs"] = save_run_logs;
   v["save_best_policy"] = save_best_policy;
   v["learning_dimensions"] = rhoban_utils::vector2Json(learning_dimensions);
+  v["use_symmetry"] = use_symmetry;
   return v;
 }
 
@@ -434,6 +452,16 @@ void LearningMachine::fromJson(const Json::Value& v, const std::string& dir_name
   rhoban_utils::tryRead(v, "save_run_logs", &save_run_logs);
   rhoban_utils::tryRead(v, "save_best_policy", &save_best_policy);
   rhoban_utils::tryRead(v, "seed_path", &seed_path);
+  rhoban_utils::tryRead(v, "use_symmetry", &use_symmetry);
+  if (use_symmetry)
+  {
+    const SymmetricProblem* symmetric_problem = dynamic_cast<const SymmetricProblem*>(problem.get());
+    if (symmetric_problem == nullptr || !symmetric_problem->hasSymmetry())
+    {
+      throw rhoban_utils::JsonParsingError("LearningMachine::fromJson: use_symmetry is enabled but problem is not "
+                                           "symmetric");
+    }
+  }
   setDiscount(discount);
 }
 
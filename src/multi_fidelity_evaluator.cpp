@@ -0,0 +1,350 @@
+#include "policies/extended_policy_factory.h"
+#include "problems/extended_problem_factory.h"
+
+#include "rhoban_csa_mdp/core/black_box_problem.h"
+#include "rhoban_csa_mdp/core/policy_factory.h"
+#include "rhoban_random/tools.h"
+#include "rhoban_utils/threading/multi_core.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fenv.h>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+namespace csa_mdp
+{
+/// Compare several policies using two versions of the same problem:
+/// - cheap_problem: fast but biased (e.g. KickControler with approximated approaches)
+/// - accurate_problem: slow but unbiased (e.g. KickControler with simulate_approaches)
+///
+/// 1. All policies are screened with nb_screening_rollouts on the cheap problem
+/// 2. The best policies (selection_ratio) are evaluated with nb_paired_rollouts
+///    on both problems, using the same starting state and the same seed for the
+///    cheap and the accurate rollout
+/// 3. The selected policies are screened again with nb_rescreening_rollouts on
+///    the cheap problem. The screening mean cannot be reused: policies are
+///    selected because their screening mean is high, it is therefore biased
+///    upward for the selected policies (winner's curse)
+/// 4. The cheap estimate of the selected policies is debiased using the paired
+///    rollouts as a control variate:
+///      accurate = mean(Y) - beta * (mean(X) - rescreening_mean)
+///    with X the paired cheap rewards, Y the paired accurate rewards and
+///    beta = cov(X,Y) / var(X)
+class MultiFidelityEvaluator : public rhoban_utils::JsonSerializable
+{
+public:
+  /// Results of the evaluation of a policy
+  struct Evaluation
+  {
+    /// Average reward on the cheap problem and its standard error
+    double screening_mean;
+    double screening_stderr;
+    /// Has the policy been evaluated on the accurate problem
+    bool selected;
+    /// Average reward on the independent cheap rollouts of the selected
+    /// policies and its standard error
+    double rescreening_mean;
+    double rescreening_stderr;
+    /// Averages of the paired rollouts
+    double paired_cheap_mean;
+    double paired_accurate_mean;
+    /// Correlation between paired rewards
+    double correlation;
+    double beta;
+    /// Control variate estimate of the accurate reward and its standard error
+    double estimate;
+    double estimate_stderr;
+  };
+
+  MultiFidelityEvaluator()
+    : nb_screening_rollouts(1000)
+    , nb_rescreening_rollouts(1000)
+    , selection_ratio(0.25)
+    , nb_paired_rollouts(50)
+    , horizon(50)
+    , discount(1.0)
+    , nb_threads(1)
+    , output_path("multi_fidelity.csv")
+  {
+  }
+
+  /// Return the rewards of nb_rollouts rollouts of the policy on the cheap
+  /// problem
+  std::vector<double> screen(const Policy& policy, int nb_rollouts, std::default_random_engine* engine) const
+  {
+    std::vector<double> rewards(nb_rollouts);
+    rhoban_utils::MultiCore::StochasticTask task = [this, &policy, &rewards](
+                                                       int start_idx, int end_idx,
+                                                       std::default_random_engine* thread_engine) {
+      for (int idx = start_idx; idx < end_idx; idx++)
+      {
+        Eigen::VectorXd state = cheap_problem->getStartingState(thread_engine);
+        rewards[idx] = cheap_problem->sampleRolloutReward(state, policy, horizon, discount, thread_engine);
+      }
+    };
+    std::vector<std::default_random_engine> engines =
+        rhoban_random::getRandomEngines(std::min(nb_threads, nb_rollouts), engine);
+    rhoban_utils::MultiCore::runParallelStochasticTask(task, nb_rollouts, &engines);
+    return rewards;
+  }
+
+  /// Run nb_paired_rollouts on both problems, rollouts i of both problems use
+  /// the same starting state and the same seed
+  void runPairs(const Policy& policy, std::vector<double>* cheap_rewards, std::vector<double>* accurate_rewards,
+                std::default_random_engine* engine) const
+  {
+    cheap_rewards->resize(nb_paired_rollouts);
+    accurate_rewards->resize(nb_paired_rollouts);
+    rhoban_utils::MultiCore::StochasticTask task = [this, &policy, cheap_rewards, accurate_rewards](
+                                                       int start_idx, int end_idx,
+                                                       std::default_random_engine* thread_engine) {
+      for (int idx = start_idx; idx < end_idx; idx++)
+      {
+        Eigen::VectorXd state = cheap_problem->getStartingState(thread_engine);
+        unsigned long seed = (*thread_engine)();
+        std::default_random_engine cheap_engine(seed), accurate_engine(seed);
+        (*cheap_rewards)[idx] = cheap_problem->sampleRolloutReward(state, policy, horizon, discount, &cheap_engine);
+        (*accurate_rewards)[idx] =
+            accurate_problem->sampleRolloutReward(state, policy, horizon, discount, &accurate_engine);
+      }
+    };
+    std::vector<std::default_random_engine> engines =
+        rhoban_random::getRandomEngines(std::min(nb_threads, nb_paired_rollouts), engine);
+    rhoban_utils::MultiCore::runParallelStochasticTask(task, nb_paired_rollouts, &engines);
+  }
+
+  static double mean(const std::vector<double>& values)
+  {
+    return std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+  }
+
+  /// Unbiased estimate of the covariance
+  static double covariance(const std::vector<double>& x, const std::vector<double>& y)
+  {
+    if (x.size() < 2)
+    {
+      return 0;
+    }
+    double mean_x = mean(x);
+    double mean_y = mean(y);
+    double sum = 0;
+    for (size_t idx = 0; idx < x.size(); idx++)
+    {
+      sum += (x[idx] - mean_x) * (y[idx] - mean_y);
+    }
+    return sum / (x.size() - 1);
+  }
+
+  /// Update the evaluation with the results of the paired rollouts
+  void applyControlVariate(const std::vector<double>& cheap, const std::vector<double>& accurate,
+                           Evaluation* evaluation) const
+  {
+    double var_cheap = covariance(cheap, cheap);
+    double var_accurate = covariance(accurate, accurate);
+    double cov = covariance(cheap, accurate);
+    evaluation->selected = true;
+    evaluation->paired_cheap_mean = mean(cheap);
+    evaluation->paired_accurate_mean = mean(accurate);
+    evaluation->beta = var_cheap > 0 ? cov / var_cheap : 0;
+    evaluation->correlation = (var_cheap > 0 && var_accurate > 0) ? cov / std::sqrt(var_cheap * var_accurate) : 0;
+    evaluation->estimate = evaluation->paired_accurate_mean -
+                           evaluation->beta * (evaluation->paired_cheap_mean - evaluation->rescreening_mean);
+    // Variance of the residuals and of the rescreening mean
+    std::vector<double> residuals(cheap.size());
+    for (size_t idx = 0; idx < cheap.size(); idx++)
+    {
+      residuals[idx] = accurate[idx] - evaluation->beta * cheap[idx];
+    }
+    double rescreening_var = evaluation->rescreening_stderr * evaluation->rescreening_stderr;
+    evaluation->estimate_stderr = std::sqrt(covariance(residuals, residuals) / residuals.size() +
+                                            evaluation->beta * evaluation->beta * rescreening_var);
+  }
+
+  void run(std::default_random_engine* engine)
+  {
+    int nb_policies = policies.size();
+    std::vector<Evaluation> evaluations(nb_policies);
+    // Screening all policies on the cheap problem
+    for (int policy_id = 0; policy_id < nb_policies; policy_id++)
+    {
+      std::vector<double> rewards = screen(*policies[policy_id], nb_screening_rollouts, engine);
+      Evaluation& evaluation = evaluations[policy_id];
+      evaluation.screening_mean = mean(rewards);
+      evaluation.screening_stderr = std::sqrt(covariance(rewards, rewards) / rewards.size());
+      evaluation.selected = false;
+      std::cout << "Policy " << policy_id << ": screening reward " << evaluation.screening_mean << " (+- "
+                << evaluation.screening_stderr << ")" << std::endl;
+    }
+    // Selecting the best policies
+    std::vector<int> order(nb_policies);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&evaluations](int p1, int p2) {
+      return evaluations[p1].screening_mean > evaluations[p2].screening_mean;
+    });
+    int nb_selected = std::min(nb_policies, std::max(1, (int)std::ceil(selection_ratio * nb_policies)));
+    for (int rank = 0; rank < nb_selected; rank++)
+    {
+      int policy_id = order[rank];
+      Evaluation& evaluation = evaluations[policy_id];
+      std::vector<double> rewards = screen(*policies[policy_id], nb_rescreening_rollouts, engine);
+      evaluation.rescreening_mean = mean(rewards);
+      evaluation.rescreening_stderr = std::sqrt(covariance(rewards, rewards) / rewards.size());
+      std::vector<double> cheap, accurate;
+      runPairs(*policies[policy_id], &cheap, &accurate, engine);
+      applyControlVariate(cheap, accurate, &evaluation);
+      std::cout << "Policy " << policy_id << ": estimated reward " << evaluation.estimate << " (+- "
+                << evaluation.estimate_stderr << "), correlation " << evaluation.correlation << std::endl;
+    }
+    writeEvaluations(evaluations);
+  }
+
+  void writeEvaluations(const std::vector<Evaluation>& evaluations) const
+  {
+    std::ofstream out(output_path);
+    if (!out.good())
+    {
+      throw std::runtime_error("MultiFidelityEvaluator::writeEvaluations: failed to open '" + output_path + "'");
+    }
+    out << "policy,screening_mean,screening_stderr,selected,rescreening_mean,rescreening_stderr,paired_cheap_mean,"
+        << "paired_accurate_mean,correlation,beta,estimate,estimate_stderr" << std::endl;
+    for (size_t policy_id = 0; policy_id < evaluations.size(); policy_id++)
+    {
+      const Evaluation& e = evaluations[policy_id];
+      out << policy_id << "," << e.screening_mean << "," << e.screening_stderr << "," << e.selected;
+      if (e.selected)
+      {
+        out << "," << e.rescreening_mean << "," << e.rescreening_stderr << "," << e.paired_cheap_mean << ","
+            << e.paired_accurate_mean << "," << e.correlation << "," << e.beta << "," << e.estimate << ","
+            << e.estimate_stderr << std::endl;
+      }
+      else
+      {
+        out << ",,,,,,," << e.screening_mean << "," << e.screening_stderr << std::endl;
+      }
+    }
+  }
+
+  Json::Value toJson() const override
+  {
+    throw std::logic_error("MultiFidelityEvaluator::toJson: not implemented");
+  }
+
+  void fromJson(const Json::Value& v, const std::string& dir_name) override
+  {
+    rhoban_utils::tryRead(v, "nb_screening_rollouts", &nb_screening_rollouts);
+    nb_rescreening_rollouts = nb_screening_rollouts;
+    rhoban_utils::tryRead(v, "nb_rescreening_rollouts", &nb_rescreening_rollouts);
+    rhoban_utils::tryRead(v, "selection_ratio", &selection_ratio);
+    rhoban_utils::tryRead(v, "nb_paired_rollouts", &nb_paired_rollouts);
+    rhoban_utils::tryRead(v, "horizon", &horizon);
+    rhoban_utils::tryRead(v, "discount", &discount);
+    rhoban_utils::tryRead(v, "nb_threads", &nb_threads);
+    rhoban_utils::tryRead(v, "output_path", &output_path);
+    if (nb_screening_rollouts < 2 || nb_rescreening_rollouts < 2 || nb_paired_rollouts < 2)
+    {
+      throw rhoban_utils::JsonParsingError("MultiFidelityEvaluator::fromJson: at least 2 screening, 2 rescreening "
+                                           "and 2 paired rollouts are required");
+    }
+    // Reading problems (mandatory)
+    cheap_problem = readProblem(v, "cheap_problem", dir_name);
+    accurate_problem = readProblem(v, "accurate_problem", dir_name);
+    if (cheap_problem->stateDims() != accurate_problem->stateDims() ||
+        cheap_problem->getNbActions() != accurate_problem->getNbActions())
+    {
+      throw rhoban_utils::JsonParsingError("MultiFidelityEvaluator::fromJson: cheap_problem and accurate_problem "
+                                           "have different state or action spaces");
+    }
+    // Reading policies (mandatory)
+    const Json::Value& policies_json = v["policies"];
+    if (!policies_json.isArray() || policies_json.size() == 0)
+    {
+      throw rhoban_utils::JsonParsingError("MultiFidelityEvaluator::fromJson: policies should be a non-empty array");
+    }
+    policies.clear();
+    for (Json::ArrayIndex idx = 0; idx < policies_json.size(); idx++)
+    {
+      policies.push_back(PolicyFactory().build(policies_json[idx], dir_name));
+      policies.back()->setActionLimits(cheap_problem->getActionsLimits());
+    }
+  }
+
+  std::string getClassName() const override
+  {
+    return "MultiFidelityEvaluator";
+  }
+
+private:
+  static std::unique_ptr<BlackBoxProblem> readProblem(const Json::Value& v, const std::string& key,
+                                                      const std::string& dir_name)
+  {
+    std::unique_ptr<Problem> tmp_problem = ProblemFactory().read(v, key, dir_name);
+    if (dynamic_cast<BlackBoxProblem*>(tmp_problem.get()) == nullptr)
+    {
+      throw rhoban_utils::JsonParsingError("MultiFidelityEvaluator::fromJson: " + key + " is not a BlackBoxProblem");
+    }
+    return std::unique_ptr<BlackBoxProblem>(dynamic_cast<BlackBoxProblem*>(tmp_problem.release()));
+  }
+
+  /// Fast but biased problem
+  std::unique_ptr<BlackBoxProblem> cheap_problem;
+
+  /// Slow but accurate problem
+  std::unique_ptr<BlackBoxProblem> accurate_problem;
+
+  /// The policies to compare
+  std::vector<std::unique_ptr<Policy>> policies;
+
+  /// Number of rollouts used for each policy on the cheap problem
+  int nb_screening_rollouts;
+
+  /// Number of independent rollouts used for each selected policy on the cheap
+  /// problem to estimate the mean of the control variate (default:
+  /// nb_screening_rollouts)
+  int nb_rescreening_rollouts;
+
+  /// Ratio of the policies evaluated on the accurate problem (at least one
+  /// policy is always evaluated)
+  double selection_ratio;
+
+  /// Number of rollouts performed on each problem for selected policies
+  int nb_paired_rollouts;
+
+  int horizon;
+
+  double discount;
+
+  int nb_threads;
+
+  /// Where the evaluations are written (csv)
+  std::string output_path;
+};
+
+}  // namespace csa_mdp
+
+using namespace csa_mdp;
+
+int main(int argc, char** argv)
+{
+  std::string config_path("MultiFidelityEvaluator.json");
+  if (argc >= 2)
+  {
+    config_path = argv[1];
+  }
+
+  // Abort if error are found
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+
+  ExtendedPolicyFactory::registerExtraPolicies();
+
+  ExtendedProblemFactory::registerExtraProblems();
+
+  MultiFidelityEvaluator evaluator;
+  evaluator.loadFile(config_path);
+
+  std::default_random_engine engine = rhoban_random::getRandomEngine();
+  evaluator.run(&engine);
+
+  exit(EXIT_SUCCESS);
+}
@@ -106,6 +106,7 @@ Odometry::Odometry(OdometryDisplacementModel::Type typeDisplacement, OdometryNoi
   , _corrected()
   , _lastDiff()
 {
+  updateKernel();
   // Ask reset
   reset();
 }
@@ -157,6 +158,7 @@ double Odometry::setParameters(const Eigen::VectorXd& params)
   {
     error += _modelNoise.setParameters(params.segment(sizeDisplacement, sizeNoise));
   }
+  updateKernel();
   return error;
 }
 
@@ -196,6 +198,16 @@ Eigen::VectorXd Odometry::getNormalization() const
   return coefs;
 }
 
+Eigen::MatrixXd Odometry::getParametersLimits() const
+{
+  Eigen::MatrixXd limitsDisplacement = _modelDisplacement.getParametersLimits();
+  Eigen::MatrixXd limitsNoise = _modelNoise.getParametersLimits();
+
+  Eigen::MatrixXd limits(limitsDisplacement.rows() + limitsNoise.rows(), 2);
+  limits << limitsDisplacement, limitsNoise;
+  return limits;
+}
+
 void Odometry::printParameters() const
 {
   _modelDisplacement.printParameters();
@@ -239,14 +251,28 @@ void Odometry::updateFullStep(const Eigen::Vector3d& deltaPose, std::default_ran
 
 Eigen::Vector3d Odometry::getDiffFullStep(const Eigen::Vector3d& deltaPose, std::default_random_engine* engine) const
 {
-  // Apply displacement correction
-  Eigen::Vector3d diff = _modelDisplacement.displacementCorrection(deltaPose);
-  // Apply noise generation if available
-  if (engine != nullptr)
+  return _kernel->getDiff(deltaPose, engine);
+}
+
+void Odometry::getDiffsFullStep(const Eigen::MatrixXd& deltaPoses, std::default_random_engine* engine,
+                                Eigen::MatrixXd* diffs) const
+{
+  _kernel->getDiffs(deltaPoses, engine, diffs);
+}
+
+double Odometry::getLogLikelihood(const Eigen::Vector3d& deltaPose, const Eigen::Vector3d& measured) const
+{
+  Eigen::Vector3d expected = _modelDisplacement.displacementCorrection(deltaPose);
+  Eigen::Vector3d variance = _modelNoise.getVariance(expected);
+  Eigen::Vector3d error = measured - expected;
+  error.z() = AngleBound(error.z());
+  double logLikelihood = 0.0;
+  for (int dim = 0; dim < 3; dim++)
   {
-    diff += _modelNoise.noiseGeneration(diff, *engine);
+    double dimVariance = variance(dim) > 0.0 ? variance(dim) : 1.0;
+    logLikelihood -= 0.5 * (error(dim) * error(dim) / dimVariance + std::log(2.0 * M_PI * dimVariance));
   }
-  return diff;
+  return logLikelihood;
 }
 
 const Eigen::Vector3d& Odometry::state() const
@@ -297,7 +323,13 @@ void Odometry::fromJson(const Json::Value& v, const std::string& dir_name)
 {
   _modelDisplacement.tryRead(v, "displacement", dir_name);
   _modelNoise.tryRead(v, "noise", dir_name);
+  updateKernel();
   reset();
 }
 
+void Odometry::updateKernel()
+{
+  _kernel = OdometryKernel::build(_modelDisplacement, _modelNoise);
+}
+
 }  // namespace csa_mdp
@@ -257,6 +257,13 @@ const Eigen::VectorXd& OdometryDisplacementModel::getNormalization() const
   return _maxBounds;
 }
 
+Eigen::MatrixXd OdometryDisplacementModel::getParametersLimits() const
+{
+  Eigen::MatrixXd limits(_params.size(), 2);
+  limits << _minBounds, _maxBounds;
+  return limits;
+}
+
 Eigen::Vector3d OdometryDisplacementModel::displacementCorrection(const Eigen::Vector3d& diff) const
 {
   Eigen::Vector3d newDiff = diff;
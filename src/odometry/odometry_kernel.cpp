@@ -0,0 +1,260 @@
+#include "odometry/odometry_kernel.h"
+
+#include "utils/ziggurat_normal.h"
+
+#include <array>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace csa_mdp
+{
+typedef OdometryDisplacementModel::Type DisplacementType;
+typedef OdometryNoiseModel::Type NoiseType;
+
+static constexpr int getNbParameters(DisplacementType type)
+{
+  switch (type)
+  {
+    case OdometryDisplacementModel::DisplacementIdentity:
+      return 0;
+    case OdometryDisplacementModel::DisplacementProportionalXY:
+      return 2;
+    case OdometryDisplacementModel::DisplacementProportionalXYA:
+      return 3;
+    case OdometryDisplacementModel::DisplacementLinearSimpleXY:
+      return 4;
+    case OdometryDisplacementModel::DisplacementLinearSimpleXYA:
+      return 6;
+    case OdometryDisplacementModel::DisplacementLinearFullXY:
+      return 8;
+    case OdometryDisplacementModel::DisplacementLinearFullXYA:
+      return 12;
+  }
+  return 0;
+}
+
+static constexpr int getNbParameters(NoiseType type)
+{
+  switch (type)
+  {
+    case OdometryNoiseModel::NoiseDisable:
+      return 0;
+    case OdometryNoiseModel::NoiseConstant:
+    case OdometryNoiseModel::NoiseProportional:
+      return 3;
+    case OdometryNoiseModel::NoiseLinearSimple:
+      return 6;
+    case OdometryNoiseModel::NoiseLinearFull:
+      return 12;
+  }
+  return 0;
+}
+
+OdometryKernel::~OdometryKernel()
+{
+}
+
+/// Formulas are the same as OdometryDisplacementModel::displacementCorrection
+/// and OdometryNoiseModel::noiseGeneration, but each normal sample used by the
+/// noise is drawn from a single batch
+template <DisplacementType D, NoiseType N>
+class SpecializedOdometryKernel : public OdometryKernel
+{
+public:
+  static constexpr int NbDisplacementParams = getNbParameters(D);
+  static constexpr int NbNoiseParams = getNbParameters(N);
+
+  SpecializedOdometryKernel(const Eigen::VectorXd& displacement_params, const Eigen::VectorXd& noise_params)
+  {
+    for (int idx = 0; idx < NbDisplacementParams; idx++)
+    {
+      d[idx] = displacement_params(idx);
+    }
+    for (int idx = 0; idx < NbNoiseParams; idx++)
+    {
+      n[idx] = noise_params(idx);
+    }
+  }
+
+  Eigen::Vector3d getDiff(const Eigen::Vector3d& delta_pose, std::default_random_engine* engine) const override
+  {
+    Eigen::Vector3d diff = getCorrection(delta_pose);
+    if (NbNoiseParams > 0 && engine != nullptr)
+    {
+      // One normal sample is required for each parameter of the noise model
+      std::array<double, NbNoiseParams> s;
+      ZigguratNormal::fill(s.data(), NbNoiseParams, engine);
+      diff += getNoise(diff, s.data());
+    }
+    return diff;
+  }
+
+  void getDiffs(const Eigen::MatrixXd& delta_poses, std::default_random_engine* engine,
+                Eigen::MatrixXd* diffs) const override
+  {
+    int nb_cols = delta_poses.cols();
+    if (delta_poses.rows() != 3 || diffs->rows() != 3 || diffs->cols() != nb_cols)
+    {
+      std::ostringstream oss;
+      oss << "OdometryKernel::getDiffs: invalid dimensions: delta_poses " << delta_poses.rows() << "x" << nb_cols
+          << ", diffs " << diffs->rows() << "x" << diffs->cols();
+      throw std::logic_error(oss.str());
+    }
+    bool noisy = NbNoiseParams > 0 && engine != nullptr;
+    std::vector<double> s(noisy ? NbNoiseParams * nb_cols : 0);
+    if (noisy)
+    {
+      ZigguratNormal::fill(s.data(), s.size(), engine);
+    }
+    for (int col = 0; col < nb_cols; col++)
+    {
+      Eigen::Vector3d diff = getCorrection(delta_poses.col(col));
+      if (noisy)
+      {
+        diff += getNoise(diff, s.data() + col * NbNoiseParams);
+      }
+      diffs->col(col) = diff;
+    }
+  }
+
+private:
+  Eigen::Vector3d getCorrection(const Eigen::Vector3d& diff) const
+  {
+    Eigen::Vector3d new_diff = diff;
+    if constexpr (D == OdometryDisplacementModel::DisplacementProportionalXY)
+    {
+      new_diff.x() = d[0] * diff.x();
+      new_diff.y() = d[1] * diff.y();
+    }
+    else if constexpr (D == OdometryDisplacementModel::DisplacementProportionalXYA)
+    {
+      new_diff.x() = d[0] * diff.x();
+      new_diff.y() = d[1] * diff.y();
+      new_diff.z() = d[2] * diff.z();
+    }
+    else if constexpr (D == OdometryDisplacementModel::DisplacementLinearSimpleXY)
+    {
+      new_diff.x() = d[0] + d[1] * diff.x();
+      new_diff.y() = d[2] + d[3] * diff.y();
+    }
+    else if constexpr (D == OdometryDisplacementModel::DisplacementLinearSimpleXYA)
+    {
+      new_diff.x() = d[0] + d[1] * diff.x();
+      new_diff.y() = d[2] + d[3] * diff.y();
+      new_diff.z() = d[4] + d[5] * diff.z();
+    }
+    else if constexpr (D == OdometryDisplacementModel::DisplacementLinearFullXY)
+    {
+      new_diff.x() = d[0] + d[1] * diff.x() + d[2] * diff.y() + d[3] * diff.z();
+      new_diff.y() = d[4] + d[5] * diff.x() + d[6] * diff.y() + d[7] * diff.z();
+    }
+    else if constexpr (D == OdometryDisplacementModel::DisplacementLinearFullXYA)
+    {
+      new_diff.x() = d[0] + d[1] * diff.x() + d[2] * diff.y() + d[3] * diff.z();
+      new_diff.y() = d[4] + d[5] * diff.x() + d[6] * diff.y() + d[7] * diff.z();
+      new_diff.z() = d[8] + d[9] * diff.x() + d[10] * diff.y() + d[11] * diff.z();
+    }
+    return new_diff;
+  }
+
+  /// s contains one normal sample for each parameter of the noise model
+  Eigen::Vector3d getNoise(const Eigen::Vector3d& diff, const double* s) const
+  {
+    Eigen::Vector3d noise;
+    if constexpr (N == OdometryNoiseModel::NoiseConstant)
+    {
+      noise.x() = n[0] * s[0];
+      noise.y() = n[1] * s[1];
+      noise.z() = n[2] * s[2];
+    }
+    else if constexpr (N == OdometryNoiseModel::NoiseProportional)
+    {
+      noise.x() = n[0] * s[0] * diff.x();
+      noise.y() = n[1] * s[1] * diff.y();
+      noise.z() = n[2] * s[2] * diff.z();
+    }
+    else if constexpr (N == OdometryNoiseModel::NoiseLinearSimple)
+    {
+      noise.x() = n[0] * s[0] + n[1] * s[1] * diff.x();
+      noise.y() = n[2] * s[2] + n[3] * s[3] * diff.y();
+      noise.z() = n[4] * s[4] + n[5] * s[5] * diff.z();
+    }
+    else if constexpr (N == OdometryNoiseModel::NoiseLinearFull)
+    {
+      noise.x() = n[0] * s[0] + n[1] * s[1] * diff.x() + n[2] * s[2] * diff.y() + n[3] * s[3] * diff.z();
+      noise.y() = n[4] * s[4] + n[5] * s[5] * diff.x() + n[6] * s[6] * diff.y() + n[7] * s[7] * diff.z();
+      noise.z() = n[8] * s[8] + n[9] * s[9] * diff.x() + n[10] * s[10] * diff.y() + n[11] * s[11] * diff.z();
+    }
+    else
+    {
+      (void)diff;
+      (void)s;
+      noise.setZero();
+    }
+    return noise;
+  }
+
+  /// Displacement parameters
+  std::array<double, NbDisplacementParams> d;
+  /// Noise parameters
+  std::array<double, NbNoiseParams> n;
+};
+
+/// Resolve the noise type at runtime for a given displacement type
+template <DisplacementType D>
+static std::unique_ptr<OdometryKernel> buildKernel(NoiseType noise_type, const Eigen::VectorXd& displacement_params,
+                                                   const Eigen::VectorXd& noise_params)
+{
+  switch (noise_type)
+  {
+    case OdometryNoiseModel::NoiseDisable:
+      return std::unique_ptr<OdometryKernel>(new SpecializedOdometryKernel<D, OdometryNoiseModel::NoiseDisable>(
+          displacement_params, noise_params));
+    case OdometryNoiseModel::NoiseConstant:
+      return std::unique_ptr<OdometryKernel>(new SpecializedOdometryKernel<D, OdometryNoiseModel::NoiseConstant>(
+          displacement_params, noise_params));
+    case OdometryNoiseModel::NoiseProportional:
+      return std::unique_ptr<OdometryKernel>(new SpecializedOdometryKernel<D, OdometryNoiseModel::NoiseProportional>(
+          displacement_params, noise_params));
+    case OdometryNoiseModel::NoiseLinearSimple:
+      return std::unique_ptr<OdometryKernel>(new SpecializedOdometryKernel<D, OdometryNoiseModel::NoiseLinearSimple>(
+          displacement_params, noise_params));
+    case OdometryNoiseModel::NoiseLinearFull:
+      return std::unique_ptr<OdometryKernel>(new SpecializedOdometryKernel<D, OdometryNoiseModel::NoiseLinearFull>(
+          displacement_params, noise_params));
+  }
+  std::ostringstream oss;
+  oss << "OdometryKernel::build: invalid noise type " << noise_type;
+  throw std::logic_error(oss.str());
+}
+
+std::unique_ptr<OdometryKernel> OdometryKernel::build(const OdometryDisplacementModel& displacement,
+                                                      const OdometryNoiseModel& noise)
+{
+  NoiseType noise_type = noise.getType();
+  const Eigen::VectorXd& d_params = displacement.getParameters();
+  const Eigen::VectorXd& n_params = noise.getParameters();
+  switch (displacement.getType())
+  {
+    case OdometryDisplacementModel::DisplacementIdentity:
+      return buildKernel<OdometryDisplacementModel::DisplacementIdentity>(noise_type, d_params, n_params);
+    case OdometryDisplacementModel::DisplacementProportionalXY:
+      return buildKernel<OdometryDisplacementModel::DisplacementProportionalXY>(noise_type, d_params, n_params);
+    case OdometryDisplacementModel::DisplacementProportionalXYA:
+      return buildKernel<OdometryDisplacementModel::DisplacementProportionalXYA>(noise_type, d_params, n_params);
+    case OdometryDisplacementModel::DisplacementLinearSimpleXY:
+      return buildKernel<OdometryDisplacementModel::DisplacementLinearSimpleXY>(noise_type, d_params, n_params);
+    case OdometryDisplacementModel::DisplacementLinearSimpleXYA:
+      return buildKernel<OdometryDisplacementModel::DisplacementLinearSimpleXYA>(noise_type, d_params, n_params);
+    case OdometryDisplacementModel::DisplacementLinearFullXY:
+      return buildKernel<OdometryDisplacementModel::DisplacementLinearFullXY>(noise_type, d_params, n_params);
+    case OdometryDisplacementModel::DisplacementLinearFullXYA:
+      return buildKernel<OdometryDisplacementModel::DisplacementLinearFullXYA>(noise_type, d_params, n_params);
+  }
+  std::ostringstream oss;
+  oss << "OdometryKernel::build: invalid displacement type " << displacement.getType();
+  throw std::logic_error(oss.str());
+}
+
+}  // namespace csa_mdp
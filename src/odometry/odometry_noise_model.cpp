@@ -178,6 +178,13 @@ const Eigen::VectorXd& OdometryNoiseModel::getNormalization() const
   return _maxBounds;
 }
 
+Eigen::MatrixXd OdometryNoiseModel::getParametersLimits() const
+{
+  Eigen::MatrixXd limits(_params.size(), 2);
+  limits << Eigen::VectorXd::Zero(_params.size()), _maxBounds;
+  return limits;
+}
+
 Eigen::Vector3d OdometryNoiseModel::noiseGeneration(const Eigen::Vector3d& diff,
                                                     std::default_random_engine& engine) const
 {
@@ -226,6 +233,44 @@ Eigen::Vector3d OdometryNoiseModel::noiseGeneration(const Eigen::Vector3d& diff,
   return noise;
 }
 
+Eigen::Vector3d OdometryNoiseModel::getVariance(const Eigen::Vector3d& diff) const
+{
+  // Each term of noiseGeneration is an independent gaussian noise
+  Eigen::Vector3d variance = Eigen::Vector3d::Zero();
+  if (_type == NoiseDisable)
+  {
+    return variance;
+  }
+  else if (_type == NoiseConstant)
+  {
+    variance = _params.array().square();
+  }
+  else if (_type == NoiseProportional)
+  {
+    variance = (_params.array() * diff.array()).square();
+  }
+  else if (_type == NoiseLinearSimple)
+  {
+    for (int dim = 0; dim < 3; dim++)
+    {
+      variance(dim) = std::pow(_params(2 * dim), 2) + std::pow(_params(2 * dim + 1) * diff(dim), 2);
+    }
+  }
+  else if (_type == NoiseLinearFull)
+  {
+    Eigen::Vector4d features(1.0, diff.x(), diff.y(), diff.z());
+    for (int dim = 0; dim < 3; dim++)
+    {
+      variance(dim) = (_params.segment(4 * dim, 4).array() * features.array()).square().sum();
+    }
+  }
+  else
+  {
+    throw std::logic_error("OdometryNoiseModel invalid type");
+  }
+  return variance;
+}
+
 void OdometryNoiseModel::printParameters() const
 {
   if (_type == NoiseDisable)
@@ -1,5 +1,6 @@
 set(SOURCES
   odometry.cpp
+  odometry_kernel.cpp
   odometry_displacement_model.cpp
   odometry_noise_model.cpp
 )
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "policies/extended_policy_factory.h"
+#include "problems/extended_problem_factory.h"
+
+#include "rhoban_csa_mdp/core/black_box_problem.h"
+#include "rhoban_csa_mdp/core/policy_factory.h"
+#include "rhoban_random/tools.h"
+#include "rhoban_utils/threading/multi_core.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fenv.h>
+#include <fstream>
+#include <iostream>
+
+namespace csa_mdp
+{
+/// Evaluate a policy on a grid of parameters of a problem (e.g. the masses of
+/// CartPoleStabilization) in a single process.
+///
+/// - problem: the base configuration, in the format of the ProblemFactory
+/// - parameters: {"name" : [values...], ...}, one problem is built for each
+///   combination by overriding the corresponding entries of the base 'content'
+/// - The rollouts of all the problems are run concurrently, each problem is
+///   an independent instance
+/// - Each thread uses its own instance of the policy, built from the same
+///   configuration, its action limits are those of the base problem. Policies
+///   with an internal state (e.g. warm-started MPC) are therefore never shared
+///   between threads
+class ParameterSweep : public rhoban_utils::JsonSerializable
+{
+public:
+  ParameterSweep() : nb_rollouts(100), horizon(100), discount(1.0), nb_threads(1), output_path("parameter_sweep.csv")
+  {
+  }
+
+  void run(std::default_random_engine* engine)
+  {
+    int nb_points = problems.size();
+    int nb_rollouts_total = nb_points * nb_rollouts;
+    int nb_workers = std::min((int)policies.size(), nb_rollouts_total);
+    std::vector<double> rewards(nb_rollouts_total);
+    // One task per worker, each worker runs a contiguous range of rollouts with its own policy
+    rhoban_utils::MultiCore::StochasticTask task = [this, &rewards, nb_workers, nb_rollouts_total](
+                                                       int start_idx, int end_idx,
+                                                       std::default_random_engine* thread_engine) {
+      for (int worker = start_idx; worker < end_idx; worker++)
+      {
+        Policy& policy = *policies[worker];
+        int first = nb_rollouts_total * worker / nb_workers;
+        int last = nb_rollouts_total * (worker + 1) / nb_workers;
+        for (int idx = first; idx < last; idx++)
+        {
+          const BlackBoxProblem& problem = *problems[idx / nb_rollouts];
+          Eigen::VectorXd state = problem.getStartingState(thread_engine);
+          rewards[idx] = problem.sampleRolloutReward(state, policy, horizon, discount, thread_engine);
+        }
+      }
+    };
+    std::vector<std::default_random_engine> engines = rhoban_random::getRandomEngines(nb_workers, engine);
+    rhoban_utils::MultiCore::runParallelStochasticTask(task, nb_workers, &engines);
+    writeResults(rewards);
+  }
+
+  void writeResults(const std::vector<double>& rewards) const
+  {
+    std::ofstream out(output_path);
+    if (!out.good())
+    {
+      throw std::runtime_error("ParameterSweep::writeResults: failed to open '" + output_path + "'");
+    }
+    for (const std::string& name : parameter_names)
+    {
+      out << name << ",";
+    }
+    out << "mean,stderr" << std::endl;
+    for (size_t point = 0; point < problems.size(); point++)
+    {
+      double sum = 0, sum2 = 0;
+      for (int rollout = 0; rollout < nb_rollouts; rollout++)
+      {
+        double reward = rewards[point * nb_rollouts + rollout];
+        sum += reward;
+        sum2 += reward * reward;
+      }
+      double mean = sum / nb_rollouts;
+      double var = nb_rollouts > 1 ? (sum2 - nb_rollouts * mean * mean) / (nb_rollouts - 1) : 0;
+      double standard_error = std::sqrt(std::max(0.0, var) / nb_rollouts);
+      for (double value : points[point])
+      {
+        out << value << ",";
+      }
+      out << mean << "," << standard_error << std::endl;
+    }
+  }
+
+  Json::Value toJson() const override
+  {
+    throw std::logic_error("ParameterSweep::toJson: not implemented");
+  }
+
+  void fromJson(const Json::Value& v, const std::string& dir_name) override
+  {
+    rhoban_utils::tryRead(v, "nb_rollouts", &nb_rollouts);
+    rhoban_utils::tryRead(v, "horizon", &horizon);
+    rhoban_utils::tryRead(v, "discount", &discount);
+    rhoban_utils::tryRead(v, "nb_threads", &nb_threads);
+    rhoban_utils::tryRead(v, "output_path", &output_path);
+    if (nb_rollouts < 1 || nb_threads < 1)
+    {
+      throw rhoban_utils::JsonParsingError("ParameterSweep::fromJson: nb_rollouts and nb_threads should be strictly "
+                                           "positive");
+    }
+    // Reading grid (mandatory)
+    const Json::Value& parameters = v["parameters"];
+    if (!parameters.isObject() || parameters.size() == 0)
+    {
+      throw rhoban_utils::JsonParsingError("ParameterSweep::fromJson: parameters should be a non-empty object");
+    }
+    parameter_names = parameters.getMemberNames();
+    std::vector<std::vector<double>> values;
+    for (const std::string& name : parameter_names)
+    {
+      values.push_back(rhoban_utils::readVector<double>(parameters, name));
+      if (values.back().size() == 0)
+      {
+        throw rhoban_utils::JsonParsingError("ParameterSweep::fromJson: no values for parameter '" + name + "'");
+      }
+    }
+    // Building all combinations, names are sorted and the last one varies fastest
+    points = { {} };
+    for (const std::vector<double>& parameter_values : values)
+    {
+      std::vector<std::vector<double>> new_points;
+      for (const std::vector<double>& point : points)
+      {
+        for (double value : parameter_values)
+        {
+          new_points.push_back(point);
+          new_points.back().push_back(value);
+        }
+      }
+      points = new_points;
+    }
+    // Building one problem per combination (mandatory)
+    const Json::Value& base = v["problem"];
+    if (!base.isObject() || !base.isMember("class name"))
+    {
+      throw rhoban_utils::JsonParsingError("ParameterSweep::fromJson: 'problem' should contain a 'class name' and a "
+                                           "'content'");
+    }
+    problems.clear();
+    for (const std::vector<double>& point : points)
+    {
+      Json::Value problem_json = base;
+      for (size_t idx = 0; idx < parameter_names.size(); idx++)
+      {
+        problem_json["content"][parameter_names[idx]] = point[idx];
+      }
+      std::unique_ptr<Problem> tmp_problem = ProblemFactory().build(problem_json, dir_name);
+      if (dynamic_cast<BlackBoxProblem*>(tmp_problem.get()) == nullptr)
+      {
+        throw rhoban_utils::JsonParsingError("ParameterSweep::fromJson: problem is not a BlackBoxProblem");
+      }
+      problems.emplace_back(dynamic_cast<BlackBoxProblem*>(tmp_problem.release()));
+    }
+    // Reading policy (mandatory), one instance per thread
+    policies.clear();
+    for (int thread = 0; thread < nb_threads; thread++)
+    {
+      policies.push_back(PolicyFactory().build(v["policy"], dir_name));
+      policies.back()->setActionLimits(problems[0]->getActionsLimits());
+    }
+  }
+
+  std::string getClassName() const override
+  {
+    return "ParameterSweep";
+  }
+
+private:
+  /// One problem for each point of the grid
+  std::vector<std::unique_ptr<BlackBoxProblem>> problems;
+
+  /// Names of the parameters modified
+  std::vector<std::string> parameter_names;
+
+  /// Values of the parameters for each problem
+  std::vector<std::vector<double>> points;
+
+  /// The policy evaluated, one instance per thread
+  std::vector<std::unique_ptr<Policy>> policies;
+
+  /// Number of rollouts for each point of the grid
+  int nb_rollouts;
+
+  int horizon;
+
+  double discount;
+
+  int nb_threads;
+
+  /// Where the results are written (csv)
+  std::string output_path;
+};
+
+}  // namespace csa_mdp
+
+using namespace csa_mdp;
+
+int main(int argc, char** argv)
+{
+  std::string config_path("ParameterSweep.json");
+  if (argc >= 2)
+  {
+    config_path = argv[1];
+  }
+
+  // Abort if error are found
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+
+  ExtendedPolicyFactory::registerExtraPolicies();
+
+  ExtendedProblemFactory::registerExtraProblems();
+
+  ParameterSweep sweep;
+  sweep.loadFile(config_path);
+
+  std::default_random_engine engine = rhoban_random::getRandomEngine();
+  sweep.run(&engine);
+
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,319 @@
+#include "policies/cross_entropy_mpc.h"
+
+#include "rhoban_csa_mdp/core/problem_factory.h"
+#include "rhoban_random/tools.h"
+#include "rhoban_utils/threading/multi_core.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+namespace csa_mdp
+{
+CrossEntropyMPC::CrossEntropyMPC()
+  : time_budget(0.03)
+  , nb_threads(1)
+  , action_id(0)
+  , look_ahead(5)
+  , rollouts_per_sample(5)
+  , discount(0.98)
+  , nb_generations(10)
+  , population_size(100)
+  , best_set_size(10)
+  , warm_start_tolerance(0.1)
+  , initial_stddev_ratio(0.5)
+  , min_stddev_ratio(0.01)
+  , report_latency(false)
+{
+}
+
+CrossEntropyMPC::~CrossEntropyMPC()
+{
+  if (report_latency && latencies.size() > 0)
+  {
+    writeLatencyReport(std::cout);
+  }
+}
+
+Eigen::VectorXd CrossEntropyMPC::getRawAction(const Eigen::VectorXd& state,
+                                              std::default_random_engine* external_engine) const
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> decision_lock(decision_mutex);
+  std::chrono::steady_clock::time_point deadline =
+      start +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_budget));
+  std::default_random_engine engine;
+  if (external_engine == nullptr)
+  {
+    engine = rhoban_random::getRandomEngine();
+    external_engine = &engine;
+  }
+  const Eigen::MatrixXd& limits = problems[0]->getActionLimits(action_id);
+  int action_dims = limits.rows();
+  Eigen::VectorXd action_range = limits.col(1) - limits.col(0);
+  // Initial distribution: shifted plan of the previous decision, if the state is the one expected
+  Eigen::MatrixXd mean;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (expected_state.rows() == state.rows() && (state - expected_state).norm() <= warm_start_tolerance)
+    {
+      mean = previous_plan;
+    }
+  }
+  bool warm_start = mean.rows() == action_dims && mean.cols() == look_ahead;
+  if (!warm_start)
+  {
+    mean = ((limits.col(0) + limits.col(1)) / 2).replicate(1, look_ahead);
+  }
+  Eigen::MatrixXd stddev = (initial_stddev_ratio * action_range).replicate(1, look_ahead);
+  Eigen::MatrixXd min_stddev = (min_stddev_ratio * action_range).replicate(1, look_ahead);
+  Eigen::MatrixXd best_plan = mean;
+  double best_value = std::numeric_limits<double>::lowest();
+  std::vector<Eigen::MatrixXd> population(population_size);
+  std::vector<double> values(population_size);
+  // Not a std::vector<bool>: elements are written concurrently
+  std::vector<int> evaluated(population_size);
+  std::normal_distribution<double> normal(0, 1);
+  for (int generation = 0; generation < nb_generations; generation++)
+  {
+    if (generation > 0 && std::chrono::steady_clock::now() >= deadline)
+    {
+      break;
+    }
+    // Sampling plans inside the action limits
+    for (int sample = 0; sample < population_size; sample++)
+    {
+      Eigen::MatrixXd& plan = population[sample];
+      if (generation == 0 && sample == 0 && warm_start)
+      {
+        plan = mean;
+        continue;
+      }
+      plan = mean;
+      for (int step = 0; step < look_ahead; step++)
+      {
+        for (int dim = 0; dim < action_dims; dim++)
+        {
+          double value = mean(dim, step) + stddev(dim, step) * normal(*external_engine);
+          plan(dim, step) = std::min(limits(dim, 1), std::max(limits(dim, 0), value));
+        }
+      }
+    }
+    // Evaluating plans, thread i uses problem i and handles samples i, i + nb_threads, ...
+    // At the first generation, each thread evaluates at least one plan
+    std::fill(evaluated.begin(), evaluated.end(), 0);
+    rhoban_utils::MultiCore::StochasticTask task = [this, &state, &deadline, &population, &values, &evaluated,
+                                                    generation](int start_idx, int end_idx,
+                                                                std::default_random_engine* thread_engine) {
+      for (int thread_id = start_idx; thread_id < end_idx; thread_id++)
+      {
+        for (int sample = thread_id; sample < population_size; sample += nb_threads)
+        {
+          bool first = generation == 0 && sample == thread_id;
+          if (!first && std::chrono::steady_clock::now() >= deadline)
+          {
+            break;
+          }
+          values[sample] = evaluatePlan(*problems[thread_id], state, population[sample], thread_engine);
+          evaluated[sample] = 1;
+        }
+      }
+    };
+    std::vector<std::default_random_engine> engines = rhoban_random::getRandomEngines(nb_threads, external_engine);
+    rhoban_utils::MultiCore::runParallelStochasticTask(task, nb_threads, &engines);
+    // Ranking evaluated plans
+    std::vector<int> ranks;
+    for (int sample = 0; sample < population_size; sample++)
+    {
+      if (evaluated[sample])
+      {
+        ranks.push_back(sample);
+      }
+    }
+    std::sort(ranks.begin(), ranks.end(), [&values](int a, int b) { return values[a] > values[b]; });
+    if (ranks.size() > 0 && values[ranks[0]] > best_value)
+    {
+      best_value = values[ranks[0]];
+      best_plan = population[ranks[0]];
+    }
+    // Plans evaluated after the deadline are missing: no need for another generation
+    if ((int)ranks.size() < population_size)
+    {
+      break;
+    }
+    // Fitting the distribution on the best plans
+    int nb_best = std::min(best_set_size, (int)ranks.size());
+    mean.setZero();
+    for (int rank = 0; rank < nb_best; rank++)
+    {
+      mean += population[ranks[rank]];
+    }
+    mean /= nb_best;
+    Eigen::MatrixXd variance = Eigen::MatrixXd::Zero(action_dims, look_ahead);
+    for (int rank = 0; rank < nb_best; rank++)
+    {
+      variance += (population[ranks[rank]] - mean).cwiseAbs2();
+    }
+    variance /= nb_best;
+    stddev = variance.cwiseSqrt().cwiseMax(min_stddev);
+  }
+  // Shifting the best plan for the next decision
+  Eigen::MatrixXd next_plan(action_dims, look_ahead);
+  next_plan.leftCols(look_ahead - 1) = best_plan.rightCols(look_ahead - 1);
+  next_plan.col(look_ahead - 1) = best_plan.col(look_ahead - 1);
+  Eigen::VectorXd action(action_dims + 1);
+  action(0) = action_id;
+  action.segment(1, action_dims) = best_plan.col(0);
+  // Average successor, noise is expected to be small with respect to warm_start_tolerance
+  Eigen::VectorXd next_state = Eigen::VectorXd::Zero(state.rows());
+  for (int rollout = 0; rollout < rollouts_per_sample; rollout++)
+  {
+    next_state += problems[0]->getSuccessor(state, action, external_engine).successor;
+  }
+  next_state /= rollouts_per_sample;
+  double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    previous_plan = next_plan;
+    expected_state = next_state;
+    latencies.push_back(latency);
+  }
+  return action;
+}
+
+double CrossEntropyMPC::evaluatePlan(const Problem& model, const Eigen::VectorXd& state, const Eigen::MatrixXd& plan,
+                                     std::default_random_engine* engine) const
+{
+  Eigen::VectorXd action(plan.rows() + 1);
+  action(0) = action_id;
+  double total = 0;
+  for (int rollout = 0; rollout < rollouts_per_sample; rollout++)
+  {
+    Eigen::VectorXd current = state;
+    double gain = 1;
+    for (int step = 0; step < look_ahead; step++)
+    {
+      action.segment(1, plan.rows()) = plan.col(step);
+      Problem::Result result = model.getSuccessor(current, action, engine);
+      total += gain * result.reward;
+      if (result.terminal)
+      {
+        break;
+      }
+      current = result.successor;
+      gain *= discount;
+    }
+  }
+  return total / rollouts_per_sample;
+}
+
+void CrossEntropyMPC::writeLatencyReport(std::ostream& out) const
+{
+  std::vector<double> sorted;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    sorted = latencies;
+  }
+  if (sorted.size() == 0)
+  {
+    out << "CrossEntropyMPC: no decision taken" << std::endl;
+    return;
+  }
+  std::sort(sorted.begin(), sorted.end());
+  auto quantile = [&sorted](double q) { return 1000 * sorted[(int)std::floor(q * (sorted.size() - 1))]; };
+  double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+  int nb_late = sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), time_budget);
+  out << "CrossEntropyMPC: " << sorted.size() << " decisions, latency [ms]: mean " << (1000 * mean) << ", p50 "
+      << quantile(0.5) << ", p90 " << quantile(0.9) << ", p99 " << quantile(0.99) << ", max " << quantile(1.0)
+      << ", " << nb_late << " above budget (" << (1000 * time_budget) << ")" << std::endl;
+}
+
+std::string CrossEntropyMPC::getClassName() const
+{
+  return "CrossEntropyMPC";
+}
+
+Json::Value CrossEntropyMPC::toJson() const
+{
+  Json::Value v = Policy::toJson();
+  v["problem"] = problems[0]->toFactoryJson();
+  v["time_budget"] = time_budget;
+  v["nb_threads"] = nb_threads;
+  v["action_id"] = action_id;
+  v["warm_start_tolerance"] = warm_start_tolerance;
+  v["initial_stddev_ratio"] = initial_stddev_ratio;
+  v["min_stddev_ratio"] = min_stddev_ratio;
+  v["report_latency"] = report_latency;
+  Json::Value& planner = v["planner"];
+  planner["look_ahead"] = look_ahead;
+  planner["rollouts_per_sample"] = rollouts_per_sample;
+  planner["discount"] = discount;
+  planner["optimizer"]["class name"] = "CrossEntropy";
+  planner["optimizer"]["content"]["nb_generations"] = nb_generations;
+  planner["optimizer"]["content"]["population_size"] = population_size;
+  planner["optimizer"]["content"]["best_set_size"] = best_set_size;
+  return v;
+}
+
+void CrossEntropyMPC::fromJson(const Json::Value& v, const std::string& dir_name)
+{
+  rhoban_utils::tryRead(v, "time_budget", &time_budget);
+  rhoban_utils::tryRead(v, "nb_threads", &nb_threads);
+  rhoban_utils::tryRead(v, "action_id", &action_id);
+  rhoban_utils::tryRead(v, "warm_start_tolerance", &warm_start_tolerance);
+  rhoban_utils::tryRead(v, "initial_stddev_ratio", &initial_stddev_ratio);
+  rhoban_utils::tryRead(v, "min_stddev_ratio", &min_stddev_ratio);
+  rhoban_utils::tryRead(v, "report_latency", &report_latency);
+  if (v.isMember("planner"))
+  {
+    const Json::Value& planner = v["planner"];
+    rhoban_utils::tryRead(planner, "look_ahead", &look_ahead);
+    rhoban_utils::tryRead(planner, "rollouts_per_sample", &rollouts_per_sample);
+    rhoban_utils::tryRead(planner, "discount", &discount);
+    if (planner.isMember("optimizer"))
+    {
+      const Json::Value& optimizer = planner["optimizer"];
+      std::string optimizer_name = rhoban_utils::read<std::string>(optimizer, "class name");
+      if (optimizer_name != "CrossEntropy")
+      {
+        throw rhoban_utils::JsonParsingError("CrossEntropyMPC::fromJson: unsupported optimizer '" + optimizer_name +
+                                             "', only 'CrossEntropy' is available");
+      }
+      if (optimizer.isMember("content"))
+      {
+        rhoban_utils::tryRead(optimizer["content"], "nb_generations", &nb_generations);
+        rhoban_utils::tryRead(optimizer["content"], "population_size", &population_size);
+        rhoban_utils::tryRead(optimizer["content"], "best_set_size", &best_set_size);
+      }
+    }
+  }
+  if (nb_threads < 1 || look_ahead < 1 || rollouts_per_sample < 1 || nb_generations < 1 || best_set_size < 1 ||
+      population_size < best_set_size)
+  {
+    throw rhoban_utils::JsonParsingError("CrossEntropyMPC::fromJson: invalid parameters, expecting strictly positive "
+                                         "values and population_size >= best_set_size");
+  }
+  // Each thread uses its own instance of the problem
+  problems.clear();
+  for (int thread_id = 0; thread_id < nb_threads; thread_id++)
+  {
+    problems.push_back(ProblemFactory().build(v["problem"], dir_name));
+  }
+  if (action_id < 0 || action_id >= problems[0]->getNbActions())
+  {
+    std::ostringstream oss;
+    oss << "CrossEntropyMPC::fromJson: invalid action_id " << action_id << ", problem has "
+        << problems[0]->getNbActions() << " actions";
+    throw rhoban_utils::JsonParsingError(oss.str());
+  }
+  // Previous plan is not valid anymore
+  std::lock_guard<std::mutex> lock(mutex);
+  previous_plan = Eigen::MatrixXd();
+  expected_state = Eigen::VectorXd();
+}
+
+}  // namespace csa_mdp
@@ -0,0 +1,37 @@
+#include "policies/extended_policy_factory.h"
+
+#include "policies/cross_entropy_mpc.h"
+#include "policies/expert_approach.h"
+#include "policies/ilqr_policy.h"
+#include "policies/kick_grid_policy.h"
+#include "policies/kick_lookahead.h"
+#include "policies/kick_mcts.h"
+#include "policies/mixed_approach.h"
+#include "policies/ok_seed.h"
+#include "policies/ssl_dynamic_ball_approach/sdba_mixed_policy.h"
+
+namespace csa_mdp
+{
+void ExtendedPolicyFactory::registerExtraPolicies()
+{
+  // Allowing multiple calls without issues
+  static bool performed = false;
+  if (performed)
+    return;
+  performed = true;
+  // Registering extra builders
+  registerExtraBuilder("CrossEntropyMPC", []() { return std::unique_ptr<Policy>(new CrossEntropyMPC); });
+  registerExtraBuilder("ExpertApproach", []() { return std::unique_ptr<Policy>(new ExpertApproach); });
+  registerExtraBuilder("ILQRPolicy", []() { return std::unique_ptr<Policy>(new ILQRPolicy); });
+  registerExtraBuilder("KickGridPolicy", []() { return std::unique_ptr<Policy>(new KickGridPolicy); });
+  registerExtraBuilder("KickLookahead", []() { return std::unique_ptr<Policy>(new KickLookahead); });
+  registerExtraBuilder("KickMCTS", []() { return std::unique_ptr<Policy>(new KickMCTS); });
+  registerExtraBuilder("MixedApproach", []() { return std::unique_ptr<Policy>(new MixedApproach); });
+  registerExtraBuilder("OKSeed", []() { return std::unique_ptr<Policy>(new OKSeed); });
+  registerExtraBuilder("SDBAMixedPolicy", []() { return std::unique_ptr<Policy>(new SDBAMixedPolicy); });
+  // Names used by older configuration files
+  registerExtraBuilder("expert_approach", []() { return std::unique_ptr<Policy>(new ExpertApproach); });
+  registerExtraBuilder("mixed_approach", []() { return std::unique_ptr<Policy>(new MixedApproach); });
+}
+
+}  // namespace csa_mdp
@@ -0,0 +1,317 @@
+#include "policies/ilqr_policy.h"
+
+#include "rhoban_csa_mdp/core/problem_factory.h"
+
+#include <Eigen/Cholesky>
+
+#include <cmath>
+#include <sstream>
+
+namespace csa_mdp
+{
+/// Regularization used at the first iteration
+static constexpr double initial_regularization = 1e-6;
+/// Above this regularization, the solver gives up
+static constexpr double max_regularization = 1e10;
+/// Factor applied to the regularization after each failure or success
+static constexpr double regularization_factor = 10;
+/// Step sizes tried during the line search
+static const double line_search_steps[] = { 1.0, 0.5, 0.25, 0.1, 0.03 };
+
+ILQRPolicy::ILQRPolicy()
+  : model(nullptr)
+  , horizon(30)
+  , time_budget(0.02)
+  , max_iterations(50)
+  , min_improvement(1e-6)
+  , warm_start_tolerance(0.1)
+{
+}
+
+Eigen::VectorXd ILQRPolicy::getRawAction(const Eigen::VectorXd& state,
+                                         std::default_random_engine* external_engine) const
+{
+  (void)external_engine;
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_budget));
+  int action_dims = problem->actionDims(0);
+  std::vector<Eigen::VectorXd> actions;
+  {
+    std::lock_guard<std::mutex> lock(warm_start_mutex);
+    if (previous_actions.size() > 0 && expected_state.rows() == state.rows() &&
+        getStateDiff(state, expected_state).norm() <= warm_start_tolerance)
+    {
+      actions = previous_actions;
+    }
+  }
+  if (actions.size() == 0)
+  {
+    actions = std::vector<Eigen::VectorXd>(horizon, Eigen::VectorXd::Zero(action_dims));
+  }
+  optimize(state, deadline, &actions);
+  // Shifting the solution for the next decision
+  {
+    std::lock_guard<std::mutex> lock(warm_start_mutex);
+    previous_actions.assign(actions.begin() + 1, actions.end());
+    previous_actions.push_back(actions.back());
+    expected_state = model->getDeterministicSuccessor(state, actions[0], nullptr, nullptr);
+  }
+  Eigen::VectorXd result(action_dims + 1);
+  result(0) = 0;
+  result.segment(1, action_dims) = actions[0];
+  return result;
+}
+
+double ILQRPolicy::optimize(const Eigen::VectorXd& state, const std::chrono::steady_clock::time_point& deadline,
+                            std::vector<Eigen::VectorXd>* actions) const
+{
+  if ((int)actions->size() != horizon)
+  {
+    std::ostringstream oss;
+    oss << "ILQRPolicy::optimize: expecting " << horizon << " actions, received " << actions->size();
+    throw std::logic_error(oss.str());
+  }
+  for (Eigen::VectorXd& action : *actions)
+  {
+    action = boundAction(action);
+  }
+  std::vector<Eigen::VectorXd> states, new_states, new_actions;
+  std::vector<Eigen::MatrixXd> state_jacobians(horizon), action_jacobians(horizon);
+  std::vector<Eigen::VectorXd> k(horizon);
+  std::vector<Eigen::MatrixXd> K(horizon);
+  double cost = rollout(state, *actions, &states);
+  double regularization = initial_regularization;
+  for (int iteration = 0; max_iterations < 0 || iteration < max_iterations; iteration++)
+  {
+    if (iteration > 0 && std::chrono::steady_clock::now() >= deadline)
+    {
+      break;
+    }
+    // Linearizing the dynamics along the trajectory
+    for (int t = 0; t < horizon; t++)
+    {
+      model->getDeterministicSuccessor(states[t], (*actions)[t], &state_jacobians[t], &action_jacobians[t]);
+    }
+    // Increasing regularization until the backward pass succeeds
+    while (!backwardPass(states, *actions, state_jacobians, action_jacobians, regularization, &k, &K))
+    {
+      regularization *= regularization_factor;
+      if (regularization > max_regularization)
+      {
+        return cost;
+      }
+    }
+    // Line search
+    bool improved = false;
+    for (double alpha : line_search_steps)
+    {
+      double new_cost = forwardPass(states, *actions, k, K, alpha, &new_states, &new_actions);
+      if (new_cost < cost)
+      {
+        double improvement = cost - new_cost;
+        cost = new_cost;
+        states.swap(new_states);
+        actions->swap(new_actions);
+        improved = true;
+        if (improvement < min_improvement)
+        {
+          return cost;
+        }
+        break;
+      }
+    }
+    if (improved)
+    {
+      regularization = std::max(initial_regularization, regularization / regularization_factor);
+    }
+    else
+    {
+      regularization *= regularization_factor;
+      if (regularization > max_regularization)
+      {
+        break;
+      }
+    }
+  }
+  return cost;
+}
+
+double ILQRPolicy::rollout(const Eigen::VectorXd& state, const std::vector<Eigen::VectorXd>& actions,
+                           std::vector<Eigen::VectorXd>* states) const
+{
+  states->resize(horizon + 1);
+  (*states)[0] = state;
+  double cost = 0;
+  for (int t = 0; t < horizon; t++)
+  {
+    cost += getStageCost((*states)[t], actions[t]);
+    (*states)[t + 1] = model->getDeterministicSuccessor((*states)[t], actions[t], nullptr, nullptr);
+  }
+  return cost + getFinalCost((*states)[horizon]);
+}
+
+bool ILQRPolicy::backwardPass(const std::vector<Eigen::VectorXd>& states, const std::vector<Eigen::VectorXd>& actions,
+                              const std::vector<Eigen::MatrixXd>& state_jacobians,
+                              const std::vector<Eigen::MatrixXd>& action_jacobians, double regularization,
+                              std::vector<Eigen::VectorXd>* k, std::vector<Eigen::MatrixXd>* K) const
+{
+  int action_dims = actions[0].rows();
+  // Derivatives of the value function
+  Eigen::VectorXd vx = final_weights.cwiseProduct(getStateDiff(states[horizon], target_state));
+  Eigen::MatrixXd vxx = final_weights.asDiagonal();
+  for (int t = horizon - 1; t >= 0; t--)
+  {
+    const Eigen::MatrixXd& A = state_jacobians[t];
+    const Eigen::MatrixXd& B = action_jacobians[t];
+    Eigen::VectorXd qx = state_weights.cwiseProduct(getStateDiff(states[t], target_state)) + A.transpose() * vx;
+    Eigen::VectorXd qu = action_weights.cwiseProduct(actions[t]) + B.transpose() * vx;
+    Eigen::MatrixXd qxx = A.transpose() * vxx * A;
+    qxx.diagonal() += state_weights;
+    Eigen::MatrixXd quu = B.transpose() * vxx * B;
+    quu.diagonal() += action_weights + Eigen::VectorXd::Constant(action_dims, regularization);
+    Eigen::MatrixXd qux = B.transpose() * vxx * A;
+    Eigen::LLT<Eigen::MatrixXd> llt(quu);
+    if (llt.info() != Eigen::Success)
+    {
+      return false;
+    }
+    (*k)[t] = -llt.solve(qu);
+    (*K)[t] = -llt.solve(qux);
+    const Eigen::VectorXd& kt = (*k)[t];
+    const Eigen::MatrixXd& Kt = (*K)[t];
+    vx = qx + Kt.transpose() * quu * kt + Kt.transpose() * qu + qux.transpose() * kt;
+    vxx = qxx + Kt.transpose() * quu * Kt + Kt.transpose() * qux + qux.transpose() * Kt;
+    vxx = (vxx + vxx.transpose()) / 2;
+  }
+  return true;
+}
+
+double ILQRPolicy::forwardPass(const std::vector<Eigen::VectorXd>& states, const std::vector<Eigen::VectorXd>& actions,
+                               const std::vector<Eigen::VectorXd>& k, const std::vector<Eigen::MatrixXd>& K,
+                               double alpha, std::vector<Eigen::VectorXd>* new_states,
+                               std::vector<Eigen::VectorXd>* new_actions) const
+{
+  new_states->resize(horizon + 1);
+  new_actions->resize(horizon);
+  (*new_states)[0] = states[0];
+  double cost = 0;
+  for (int t = 0; t < horizon; t++)
+  {
+    const Eigen::VectorXd& x = (*new_states)[t];
+    (*new_actions)[t] = boundAction(actions[t] + alpha * k[t] + K[t] * getStateDiff(x, states[t]));
+    cost += getStageCost(x, (*new_actions)[t]);
+    (*new_states)[t + 1] = model->getDeterministicSuccessor(x, (*new_actions)[t], nullptr, nullptr);
+  }
+  return cost + getFinalCost((*new_states)[horizon]);
+}
+
+Eigen::VectorXd ILQRPolicy::getStateDiff(const Eigen::VectorXd& state, const Eigen::VectorXd& reference) const
+{
+  Eigen::VectorXd diff = state - reference;
+  // The derivative of the normalization is 1, gradients are not modified
+  for (int dim : angular_dims)
+  {
+    diff(dim) = std::remainder(diff(dim), 2 * M_PI);
+  }
+  return diff;
+}
+
+double ILQRPolicy::getStageCost(const Eigen::VectorXd& state, const Eigen::VectorXd& action) const
+{
+  Eigen::VectorXd diff = getStateDiff(state, target_state);
+  return 0.5 * (diff.dot(state_weights.cwiseProduct(diff)) + action.dot(action_weights.cwiseProduct(action)));
+}
+
+double ILQRPolicy::getFinalCost(const Eigen::VectorXd& state) const
+{
+  Eigen::VectorXd diff = getStateDiff(state, target_state);
+  return 0.5 * diff.dot(final_weights.cwiseProduct(diff));
+}
+
+Eigen::VectorXd ILQRPolicy::boundAction(const Eigen::VectorXd& action) const
+{
+  const Eigen::MatrixXd& limits = problem->getActionLimits(0);
+  return action.cwiseMax(limits.col(0)).cwiseMin(limits.col(1));
+}
+
+std::string ILQRPolicy::getClassName() const
+{
+  return "ILQRPolicy";
+}
+
+Json::Value ILQRPolicy::toJson() const
+{
+  Json::Value v = Policy::toJson();
+  v["problem"] = problem->toFactoryJson();
+  v["horizon"] = horizon;
+  v["time_budget"] = time_budget;
+  v["max_iterations"] = max_iterations;
+  v["min_improvement"] = min_improvement;
+  v["warm_start_tolerance"] = warm_start_tolerance;
+  for (int dim : angular_dims)
+  {
+    v["angular_dims"].append(dim);
+  }
+  v["target_state"] = rhoban_utils::vector2Json(target_state);
+  v["state_weights"] = rhoban_utils::vector2Json(state_weights);
+  v["final_weights"] = rhoban_utils::vector2Json(final_weights);
+  v["action_weights"] = rhoban_utils::vector2Json(action_weights);
+  return v;
+}
+
+void ILQRPolicy::fromJson(const Json::Value& v, const std::string& dir_name)
+{
+  problem = ProblemFactory().build(v["problem"], dir_name);
+  model = dynamic_cast<const DifferentiableProblem*>(problem.get());
+  if (model == nullptr || problem->getNbActions() != 1)
+  {
+    throw rhoban_utils::JsonParsingError("ILQRPolicy::fromJson: Expecting 'problem' to be a DifferentiableProblem "
+                                         "with a single action");
+  }
+  rhoban_utils::tryRead(v, "horizon", &horizon);
+  rhoban_utils::tryRead(v, "time_budget", &time_budget);
+  rhoban_utils::tryRead(v, "max_iterations", &max_iterations);
+  rhoban_utils::tryRead(v, "min_improvement", &min_improvement);
+  rhoban_utils::tryRead(v, "warm_start_tolerance", &warm_start_tolerance);
+  if (horizon < 1)
+  {
+    throw rhoban_utils::JsonParsingError("ILQRPolicy::fromJson: horizon should be strictly positive");
+  }
+  // Default weights
+  int state_dims = problem->stateDims();
+  int action_dims = problem->actionDims(0);
+  target_state = Eigen::VectorXd::Zero(state_dims);
+  state_weights = Eigen::VectorXd::Ones(state_dims);
+  action_weights = Eigen::VectorXd::Constant(action_dims, 1e-3);
+  angular_dims.clear();
+  rhoban_utils::tryReadVector(v, "angular_dims", &angular_dims);
+  for (int dim : angular_dims)
+  {
+    if (dim < 0 || dim >= state_dims)
+    {
+      std::ostringstream oss;
+      oss << "ILQRPolicy::fromJson: invalid angular dimension " << dim << ", problem has " << state_dims
+          << " dimensions";
+      throw rhoban_utils::JsonParsingError(oss.str());
+    }
+  }
+  rhoban_utils::tryReadEigen(v, "target_state", &target_state);
+  rhoban_utils::tryReadEigen(v, "state_weights", &state_weights);
+  rhoban_utils::tryReadEigen(v, "action_weights", &action_weights);
+  final_weights = state_weights;
+  rhoban_utils::tryReadEigen(v, "final_weights", &final_weights);
+  if (target_state.rows() != state_dims || state_weights.rows() != state_dims || final_weights.rows() != state_dims ||
+      action_weights.rows() != action_dims)
+  {
+    std::ostringstream oss;
+    oss << "ILQRPolicy::fromJson: invalid dimensions for weights, expecting " << state_dims << " for states and "
+        << action_dims << " for actions";
+    throw rhoban_utils::JsonParsingError(oss.str());
+  }
+  // Previous solution is not valid anymore
+  std::lock_guard<std::mutex> lock(warm_start_mutex);
+  previous_actions.clear();
+}
+
+}  // namespace csa_mdp
@@ -0,0 +1,161 @@
+#include "policies/kick_grid_policy.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace csa_mdp
+{
+/// Split a csv line into numbers
+static std::vector<double> parseCSVLine(const std::string& line)
+{
+  std::vector<double> result;
+  std::istringstream iss(line);
+  std::string token;
+  while (std::getline(iss, token, ','))
+  {
+    result.push_back(std::stod(token));
+  }
+  return result;
+}
+
+KickGridPolicy::KickGridPolicy() : nb_cells_x(0), nb_cells_y(0)
+{
+}
+
+Eigen::VectorXd KickGridPolicy::getRawAction(const Eigen::VectorXd& state,
+                                             std::default_random_engine* external_engine) const
+{
+  (void)external_engine;
+  return actions[getCellIndex(state(0), state(1))];
+}
+
+void KickGridPolicy::setGrid(const Eigen::MatrixXd& new_limits, int new_nb_cells_x, int new_nb_cells_y)
+{
+  if (new_limits.rows() != 2 || new_limits.cols() != 2 || new_nb_cells_x <= 0 || new_nb_cells_y <= 0)
+  {
+    std::ostringstream oss;
+    oss << "KickGridPolicy::setGrid: invalid grid: limits of size " << new_limits.rows() << "x" << new_limits.cols()
+        << " with " << new_nb_cells_x << "x" << new_nb_cells_y << " cells";
+    throw std::logic_error(oss.str());
+  }
+  limits = new_limits;
+  nb_cells_x = new_nb_cells_x;
+  nb_cells_y = new_nb_cells_y;
+  values = std::vector<double>(getNbCells(), 0.0);
+  actions = std::vector<Eigen::VectorXd>(getNbCells());
+}
+
+int KickGridPolicy::getNbCells() const
+{
+  return nb_cells_x * nb_cells_y;
+}
+
+int KickGridPolicy::getCellIndex(double ball_x, double ball_y) const
+{
+  int cell_x = std::floor((ball_x - limits(0, 0)) / (limits(0, 1) - limits(0, 0)) * nb_cells_x);
+  int cell_y = std::floor((ball_y - limits(1, 0)) / (limits(1, 1) - limits(1, 0)) * nb_cells_y);
+  cell_x = std::min(nb_cells_x - 1, std::max(0, cell_x));
+  cell_y = std::min(nb_cells_y - 1, std::max(0, cell_y));
+  return cell_x + nb_cells_x * cell_y;
+}
+
+Eigen::Vector2d KickGridPolicy::getCellCenter(int cell) const
+{
+  int cell_x = cell % nb_cells_x;
+  int cell_y = cell / nb_cells_x;
+  double x = limits(0, 0) + (cell_x + 0.5) * (limits(0, 1) - limits(0, 0)) / nb_cells_x;
+  double y = limits(1, 0) + (cell_y + 0.5) * (limits(1, 1) - limits(1, 0)) / nb_cells_y;
+  return Eigen::Vector2d(x, y);
+}
+
+double KickGridPolicy::getValue(const Eigen::VectorXd& state) const
+{
+  return values[getCellIndex(state(0), state(1))];
+}
+
+void KickGridPolicy::setCell(int cell, double value, const Eigen::VectorXd& action)
+{
+  values[cell] = value;
+  actions[cell] = action;
+}
+
+void KickGridPolicy::save(const std::string& path) const
+{
+  std::ofstream out(path);
+  if (!out.good())
+  {
+    throw std::runtime_error("KickGridPolicy::save: failed to open '" + path + "'");
+  }
+  out.precision(10);
+  out << limits(0, 0) << "," << limits(0, 1) << "," << nb_cells_x << "," << limits(1, 0) << "," << limits(1, 1) << ","
+      << nb_cells_y << std::endl;
+  for (int cell = 0; cell < getNbCells(); cell++)
+  {
+    out << (cell % nb_cells_x) << "," << (cell / nb_cells_x) << "," << values[cell];
+    for (int dim = 0; dim < actions[cell].rows(); dim++)
+    {
+      out << "," << actions[cell](dim);
+    }
+    out << std::endl;
+  }
+}
+
+void KickGridPolicy::load(const std::string& path)
+{
+  std::ifstream in(path);
+  if (!in.good())
+  {
+    throw std::runtime_error("KickGridPolicy::load: failed to open '" + path + "'");
+  }
+  std::string line;
+  std::getline(in, line);
+  std::vector<double> header = parseCSVLine(line);
+  if (header.size() != 6)
+  {
+    throw std::runtime_error("KickGridPolicy::load: invalid header in '" + path + "'");
+  }
+  Eigen::MatrixXd new_limits(2, 2);
+  new_limits << header[0], header[1], header[3], header[4];
+  setGrid(new_limits, (int)header[2], (int)header[5]);
+  int nb_cells_read = 0;
+  while (std::getline(in, line))
+  {
+    if (line == "")
+      continue;
+    std::vector<double> content = parseCSVLine(line);
+    if (content.size() < 4)
+    {
+      throw std::runtime_error("KickGridPolicy::load: invalid line in '" + path + "': '" + line + "'");
+    }
+    int cell = (int)content[0] + nb_cells_x * (int)content[1];
+    Eigen::VectorXd action = Eigen::Map<Eigen::VectorXd>(content.data() + 3, content.size() - 3);
+    setCell(cell, content[2], action);
+    nb_cells_read++;
+  }
+  if (nb_cells_read != getNbCells())
+  {
+    std::ostringstream oss;
+    oss << "KickGridPolicy::load: " << nb_cells_read << " cells read in '" << path << "', expecting " << getNbCells();
+    throw std::runtime_error(oss.str());
+  }
+}
+
+std::string KickGridPolicy::getClassName() const
+{
+  return "KickGridPolicy";
+}
+
+Json::Value KickGridPolicy::toJson() const
+{
+  Json::Value v = Policy::toJson();
+  v["table_path"] = table_path;
+  return v;
+}
+
+void KickGridPolicy::fromJson(const Json::Value& v, const std::string& dir_name)
+{
+  table_path = rhoban_utils::read<std::string>(v, "table_path");
+  load(dir_name + table_path);
+}
+
+}  // namespace csa_mdp
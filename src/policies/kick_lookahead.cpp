@@ -0,0 +1,138 @@
+#include "policies/kick_lookahead.h"
+
+#include "rhoban_csa_mdp/core/policy_factory.h"
+#include "rhoban_csa_mdp/core/problem_factory.h"
+#include "rhoban_random/tools.h"
+#include "rhoban_utils/threading/multi_core.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace csa_mdp
+{
+KickLookahead::KickLookahead()
+  : nb_values_per_dim(9), initial_rollouts(4), horizon(0), discount(1.0), nb_threads(1)
+{
+}
+
+Eigen::VectorXd KickLookahead::getRawAction(const Eigen::VectorXd& state,
+                                            std::default_random_engine* external_engine) const
+{
+  std::default_random_engine engine;
+  if (external_engine == nullptr)
+  {
+    engine = rhoban_random::getRandomEngine();
+    external_engine = &engine;
+  }
+  std::vector<Eigen::VectorXd> candidates = getCandidates();
+  return candidates[getBestCandidate(state, candidates, external_engine)];
+}
+
+std::vector<Eigen::VectorXd> KickLookahead::getCandidates() const
+{
+  return problem->getDiscretizedActions(nb_values_per_dim);
+}
+
+int KickLookahead::getBestCandidate(const Eigen::VectorXd& state, const std::vector<Eigen::VectorXd>& candidates,
+                                    std::default_random_engine* engine) const
+{
+  if (candidates.size() == 0)
+  {
+    throw std::logic_error("KickLookahead::getBestCandidate: no candidates available");
+  }
+  // Rewards are accumulated through the rounds
+  std::vector<double> rewards_sum(candidates.size(), 0.0);
+  std::vector<int> nb_rollouts(candidates.size(), 0);
+  std::vector<int> alive(candidates.size());
+  std::iota(alive.begin(), alive.end(), 0);
+  int round_rollouts = initial_rollouts;
+  while (alive.size() > 1)
+  {
+    // Each thread evaluates its own subset of candidates
+    rhoban_utils::MultiCore::StochasticTask task = [this, &state, &candidates, &alive, &rewards_sum, &nb_rollouts,
+                                                    round_rollouts](int start_idx, int end_idx,
+                                                                    std::default_random_engine* thread_engine) {
+      for (int idx = start_idx; idx < end_idx; idx++)
+      {
+        int candidate = alive[idx];
+        for (int rollout = 0; rollout < round_rollouts; rollout++)
+        {
+          rewards_sum[candidate] += sampleReward(state, candidates[candidate], thread_engine);
+        }
+        nb_rollouts[candidate] += round_rollouts;
+      }
+    };
+    int nb_tasks = alive.size();
+    std::vector<std::default_random_engine> engines =
+        rhoban_random::getRandomEngines(std::min(nb_threads, nb_tasks), engine);
+    rhoban_utils::MultiCore::runParallelStochasticTask(task, nb_tasks, &engines);
+    // Keeping the best half of the candidates
+    std::stable_sort(alive.begin(), alive.end(), [&rewards_sum, &nb_rollouts](int c1, int c2) {
+      return rewards_sum[c1] / nb_rollouts[c1] > rewards_sum[c2] / nb_rollouts[c2];
+    });
+    alive.resize((alive.size() + 1) / 2);
+    round_rollouts *= 2;
+  }
+  return alive[0];
+}
+
+double KickLookahead::sampleReward(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
+                                   std::default_random_engine* engine) const
+{
+  Problem::Result result = problem->getSuccessor(state, action, engine);
+  double reward = result.reward;
+  if (!result.terminal && rollout_policy && horizon > 0)
+  {
+    reward += discount * problem->sampleRolloutReward(result.successor, *rollout_policy, horizon, discount, engine);
+  }
+  return reward;
+}
+
+std::string KickLookahead::getClassName() const
+{
+  return "KickLookahead";
+}
+
+Json::Value KickLookahead::toJson() const
+{
+  Json::Value v = Policy::toJson();
+  v["problem"] = problem->toFactoryJson();
+  if (rollout_policy)
+  {
+    v["rollout_policy"] = rollout_policy->toFactoryJson();
+  }
+  v["nb_values_per_dim"] = nb_values_per_dim;
+  v["initial_rollouts"] = initial_rollouts;
+  v["horizon"] = horizon;
+  v["discount"] = discount;
+  v["nb_threads"] = nb_threads;
+  return v;
+}
+
+void KickLookahead::fromJson(const Json::Value& v, const std::string& dir_name)
+{
+  std::unique_ptr<csa_mdp::Problem> tmp_problem = ProblemFactory().build(v["problem"], dir_name);
+  if (dynamic_cast<KickControler*>(tmp_problem.get()) == nullptr)
+  {
+    throw rhoban_utils::JsonParsingError("KickLookahead::fromJson: Expecting 'problem' of type KickControler");
+  }
+  problem.reset(dynamic_cast<KickControler*>(tmp_problem.release()));
+
+  PolicyFactory().tryRead(v, "rollout_policy", dir_name, &rollout_policy);
+  if (rollout_policy)
+  {
+    rollout_policy->setActionLimits(problem->getActionsLimits());
+  }
+  rhoban_utils::tryRead(v, "nb_values_per_dim", &nb_values_per_dim);
+  rhoban_utils::tryRead(v, "initial_rollouts", &initial_rollouts);
+  rhoban_utils::tryRead(v, "horizon", &horizon);
+  rhoban_utils::tryRead(v, "discount", &discount);
+  rhoban_utils::tryRead(v, "nb_threads", &nb_threads);
+  if (nb_values_per_dim < 1 || initial_rollouts < 1)
+  {
+    throw rhoban_utils::JsonParsingError("KickLookahead::fromJson: nb_values_per_dim and initial_rollouts should "
+                                         "be strictly positive");
+  }
+}
+
+}  // namespace csa_mdp
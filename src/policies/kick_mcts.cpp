@@ -0,0 +1,283 @@
+#include "policies/kick_mcts.h"
+
+#include "policies/ok_seed.h"
+
+#include "rhoban_csa_mdp/core/policy_factory.h"
+#include "rhoban_csa_mdp/core/problem_factory.h"
+#include "rhoban_random/tools.h"
+#include "rhoban_utils/threading/multi_core.h"
+
+#include <cmath>
+#include <limits>
+
+namespace csa_mdp
+{
+class KickMCTS::ActionNode
+{
+public:
+  explicit ActionNode(const Eigen::VectorXd& action) : action(action), visits(0), value_sum(0)
+  {
+  }
+
+  Eigen::VectorXd action;
+  int visits;
+  double value_sum;
+  std::vector<std::unique_ptr<StateNode>> successors;
+};
+
+class KickMCTS::StateNode
+{
+public:
+  StateNode(const Eigen::VectorXd& state, double reward, bool terminal)
+    : state(state), reward(reward), terminal(terminal), visits(0)
+  {
+  }
+
+  Eigen::VectorXd state;
+  /// Reward received when reaching this node
+  double reward;
+  bool terminal;
+  int visits;
+  std::vector<std::unique_ptr<ActionNode>> actions;
+};
+
+KickMCTS::KickMCTS()
+  : time_budget(0.1)
+  , max_iterations(-1)
+  , nb_threads(1)
+  , max_depth(10)
+  , rollout_horizon(20)
+  , discount(1.0)
+  , exploration(50)
+  , action_widening_k(1.0)
+  , action_widening_alpha(0.5)
+  , state_widening_k(1.0)
+  , state_widening_alpha(0.3)
+{
+}
+
+KickMCTS::~KickMCTS()
+{
+}
+
+Eigen::VectorXd KickMCTS::getRawAction(const Eigen::VectorXd& state,
+                                       std::default_random_engine* external_engine) const
+{
+  std::default_random_engine engine;
+  if (external_engine == nullptr)
+  {
+    engine = rhoban_random::getRandomEngine();
+    external_engine = &engine;
+  }
+  // Root actions are generated from the same seed in all the trees
+  unsigned long root_seed = (*external_engine)();
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_budget));
+  // Building one tree per thread
+  std::vector<std::unique_ptr<StateNode>> trees;
+  for (int tree_id = 0; tree_id < nb_threads; tree_id++)
+  {
+    trees.emplace_back(new StateNode(state, 0, false));
+  }
+  rhoban_utils::MultiCore::StochasticTask task = [this, &trees, root_seed, &deadline](
+                                                     int start_idx, int end_idx,
+                                                     std::default_random_engine* thread_engine) {
+    for (int tree_id = start_idx; tree_id < end_idx; tree_id++)
+    {
+      growTree(trees[tree_id].get(), root_seed, deadline, thread_engine);
+    }
+  };
+  std::vector<std::default_random_engine> engines = rhoban_random::getRandomEngines(nb_threads, external_engine);
+  rhoban_utils::MultiCore::runParallelStochasticTask(task, nb_threads, &engines);
+  // Merging root statistics, root action i is the same in all trees
+  std::vector<int> visits;
+  std::vector<double> values;
+  std::vector<const Eigen::VectorXd*> actions;
+  for (const std::unique_ptr<StateNode>& tree : trees)
+  {
+    for (size_t action_id = 0; action_id < tree->actions.size(); action_id++)
+    {
+      if (action_id >= visits.size())
+      {
+        visits.push_back(0);
+        values.push_back(0);
+        actions.push_back(&(tree->actions[action_id]->action));
+      }
+      visits[action_id] += tree->actions[action_id]->visits;
+      values[action_id] += tree->actions[action_id]->value_sum;
+    }
+  }
+  if (actions.size() == 0)
+  {
+    throw std::logic_error("KickMCTS::getRawAction: no action has been explored");
+  }
+  // Choosing the most visited action, ties are broken using the average value
+  int best_id = 0;
+  for (int action_id = 1; action_id < (int)actions.size(); action_id++)
+  {
+    bool more_visits = visits[action_id] > visits[best_id];
+    bool same_visits = visits[action_id] == visits[best_id] && visits[action_id] > 0;
+    if (more_visits || (same_visits && values[action_id] / visits[action_id] > values[best_id] / visits[best_id]))
+    {
+      best_id = action_id;
+    }
+  }
+  return *(actions[best_id]);
+}
+
+void KickMCTS::growTree(StateNode* root, unsigned long root_seed,
+                        const std::chrono::steady_clock::time_point& deadline,
+                        std::default_random_engine* engine) const
+{
+  std::default_random_engine root_engine(root_seed);
+  int iteration = 0;
+  // At least one iteration is performed to ensure that an action is available
+  do
+  {
+    simulate(root, 0, &root_engine, engine);
+    iteration++;
+  } while ((max_iterations < 0 || iteration < max_iterations) && std::chrono::steady_clock::now() < deadline);
+}
+
+double KickMCTS::simulate(StateNode* node, int depth, std::default_random_engine* actions_engine,
+                          std::default_random_engine* engine) const
+{
+  if (depth >= max_depth)
+  {
+    return rollout(node->state, engine);
+  }
+  node->visits++;
+  // Progressive widening on actions
+  int max_actions = std::ceil(action_widening_k * std::pow(node->visits, action_widening_alpha));
+  if ((int)node->actions.size() < max_actions)
+  {
+    node->actions.emplace_back(new ActionNode(generateAction(*node, actions_engine)));
+  }
+  // Choosing action with UCB
+  ActionNode* action_node = nullptr;
+  double best_score = std::numeric_limits<double>::lowest();
+  double log_visits = std::log(node->visits);
+  for (const std::unique_ptr<ActionNode>& candidate : node->actions)
+  {
+    if (candidate->visits == 0)
+    {
+      action_node = candidate.get();
+      break;
+    }
+    double score = candidate->value_sum / candidate->visits +
+                   exploration * std::sqrt(log_visits / candidate->visits);
+    if (score > best_score)
+    {
+      best_score = score;
+      action_node = candidate.get();
+    }
+  }
+  // Progressive widening on successors
+  double value;
+  int max_successors = std::ceil(state_widening_k * std::pow(action_node->visits + 1, state_widening_alpha));
+  if ((int)action_node->successors.size() < max_successors)
+  {
+    Problem::Result result = problem->getSuccessor(node->state, action_node->action, engine);
+    action_node->successors.emplace_back(new StateNode(result.successor, result.reward, result.terminal));
+    value = result.reward;
+    if (!result.terminal)
+    {
+      value += discount * rollout(result.successor, engine);
+    }
+  }
+  else
+  {
+    std::uniform_int_distribution<int> successor_distrib(0, action_node->successors.size() - 1);
+    StateNode* successor = action_node->successors[successor_distrib(*engine)].get();
+    value = successor->reward;
+    if (!successor->terminal)
+    {
+      value += discount * simulate(successor, depth + 1, engine, engine);
+    }
+  }
+  action_node->visits++;
+  action_node->value_sum += value;
+  return value;
+}
+
+Eigen::VectorXd KickMCTS::generateAction(const StateNode& node, std::default_random_engine* engine) const
+{
+  // First action is the one chosen by the rollout policy
+  if (node.actions.size() == 0)
+  {
+    return rollout_policy->getAction(node.state, engine);
+  }
+  const std::vector<Eigen::MatrixXd>& actions_limits = problem->getActionsLimits();
+  std::uniform_int_distribution<int> action_id_distrib(0, actions_limits.size() - 1);
+  int action_id = action_id_distrib(*engine);
+  const Eigen::MatrixXd& limits = actions_limits[action_id];
+  Eigen::VectorXd action(1 + limits.rows());
+  action(0) = action_id;
+  if (limits.rows() > 0)
+  {
+    action.segment(1, limits.rows()) = rhoban_random::getUniformSample(limits, engine);
+  }
+  return action;
+}
+
+double KickMCTS::rollout(const Eigen::VectorXd& state, std::default_random_engine* engine) const
+{
+  return problem->sampleRolloutReward(state, *rollout_policy, rollout_horizon, discount, engine);
+}
+
+std::string KickMCTS::getClassName() const
+{
+  return "KickMCTS";
+}
+
+Json::Value KickMCTS::toJson() const
+{
+  Json::Value v = Policy::toJson();
+  v["problem"] = problem->toFactoryJson();
+  v["rollout_policy"] = rollout_policy->toFactoryJson();
+  v["time_budget"] = time_budget;
+  v["max_iterations"] = max_iterations;
+  v["nb_threads"] = nb_threads;
+  v["max_depth"] = max_depth;
+  v["rollout_horizon"] = rollout_horizon;
+  v["discount"] = discount;
+  v["exploration"] = exploration;
+  v["action_widening_k"] = action_widening_k;
+  v["action_widening_alpha"] = action_widening_alpha;
+  v["state_widening_k"] = state_widening_k;
+  v["state_widening_alpha"] = state_widening_alpha;
+  return v;
+}
+
+void KickMCTS::fromJson(const Json::Value& v, const std::string& dir_name)
+{
+  std::unique_ptr<csa_mdp::Problem> tmp_problem = ProblemFactory().build(v["problem"], dir_name);
+  if (dynamic_cast<KickControler*>(tmp_problem.get()) == nullptr)
+  {
+    throw rhoban_utils::JsonParsingError("KickMCTS::fromJson: Expecting 'problem' of type KickControler");
+  }
+  problem.reset(dynamic_cast<KickControler*>(tmp_problem.release()));
+
+  rollout_policy.reset(new OKSeed());
+  PolicyFactory().tryRead(v, "rollout_policy", dir_name, &rollout_policy);
+  rollout_policy->setActionLimits(problem->getActionsLimits());
+
+  rhoban_utils::tryRead(v, "time_budget", &time_budget);
+  rhoban_utils::tryRead(v, "max_iterations", &max_iterations);
+  rhoban_utils::tryRead(v, "nb_threads", &nb_threads);
+  rhoban_utils::tryRead(v, "max_depth", &max_depth);
+  rhoban_utils::tryRead(v, "rollout_horizon", &rollout_horizon);
+  rhoban_utils::tryRead(v, "discount", &discount);
+  rhoban_utils::tryRead(v, "exploration", &exploration);
+  rhoban_utils::tryRead(v, "action_widening_k", &action_widening_k);
+  rhoban_utils::tryRead(v, "action_widening_alpha", &action_widening_alpha);
+  rhoban_utils::tryRead(v, "state_widening_k", &state_widening_k);
+  rhoban_utils::tryRead(v, "state_widening_alpha", &state_widening_alpha);
+  if (nb_threads < 1)
+  {
+    throw rhoban_utils::JsonParsingError("KickMCTS::fromJson: nb_threads should be strictly positive");
+  }
+}
+
+}  // namespace csa_mdp
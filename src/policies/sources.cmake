@@ -1,9 +1,16 @@
 set(SOURCES
+  extended_policy_factory.cpp
 # For polar approach
   expert_approach.cpp
   mixed_approach.cpp
 # Kick controler
+  kick_grid_policy.cpp
+  kick_lookahead.cpp
+  kick_mcts.cpp
   ok_seed.cpp
+# Model predictive control
+  cross_entropy_mpc.cpp
+  ilqr_policy.cpp
 # SDBA
   ssl_dynamic_ball_approach/sdba_mixed_policy.cpp
 )
@@ -1,6 +1,8 @@
 #include "problems/ball_approach.h"
 
 #include "kick_model/kick_model_collection.h"
+#include "utils/config_cache.h"
+#include "utils/sin_cos.h"
 
 #include "rhoban_utils/angle.h"
 
@@ -58,11 +60,13 @@ BallApproach::BallApproach()
 void BallApproach::clearKickZones()
 {
   kick_zones.clear();
+  compiled_kick_zones.clear();
 }
 
 void BallApproach::addKickZone(const KickZone& kz)
 {
   kick_zones.push_back(kz);
+  compiled_kick_zones.add(kz);
 }
 
 void BallApproach::updateLimits()
@@ -74,6 +78,8 @@ void BallApproach::updateLimits()
       max_step_theta_diff;
   setStateLimits(state_limits);
   setActionLimits({ action_limits });
+  fixed_state_limits = state_limits;
+  fixed_action_limits = action_limits;
 
   // Also ensure names are valid
   setStateNames({ "ball_dist", "ball_dir", "target_angle", "step_x", "step_y", "step_theta" });
@@ -96,18 +102,22 @@ void BallApproach::setOdometry(const Odometry& new_odometry)
 }
 
 bool BallApproach::isTerminal(const Eigen::VectorXd& state) const
+{
+  return isTerminal(FixedState(state));
+}
+
+bool BallApproach::isTerminal(const FixedState& state) const
 {
   bool collision_terminal = (terminal_collisions && isColliding(state));
   bool kick_terminal = false;
   if (kick_terminal_speed_factor > 0 && isKickable(state))
   {
     kick_terminal = true;
-    const Eigen::MatrixXd& action_limits = getActionLimits(0);
     // Check that all orders are below the given threshold
     for (int dim = 0; dim < 3; dim++)
     {
-      double min_value = action_limits(dim, 0) * kick_terminal_speed_factor;
-      double max_value = action_limits(dim, 1) * kick_terminal_speed_factor;
+      double min_value = fixed_action_limits(dim, 0) * kick_terminal_speed_factor;
+      double max_value = fixed_action_limits(dim, 1) * kick_terminal_speed_factor;
       double order_value = state(dim + 3);
       // Are we outside of bound for acceptance?
       if (order_value < min_value || order_value > max_value)
@@ -125,6 +135,11 @@ double BallApproach::getReward(const Eigen::VectorXd& state, const Eigen::Vector
 {
   (void)state;
   (void)action;
+  return getReward(FixedState(dst));
+}
+
+double BallApproach::getReward(const FixedState& dst) const
+{
   if (isColliding(dst))
     return collision_reward;
   if (isKickable(dst))
@@ -149,45 +164,112 @@ Problem::Result BallApproach::getSuccessor(const Eigen::VectorXd& state, const E
         << " invalid dimension for action, expecting 4 and received " << action.rows();
     throw std::runtime_error(oss.str());
   }
+  FixedState next_state;
+  Problem::Result result;
+  step(FixedState(state), Eigen::Vector3d(action.segment(1, 3)), engine, &next_state, &result.reward,
+       &result.terminal);
+  result.successor = next_state;
+  return result;
+}
+
+void BallApproach::step(const FixedState& state, const Eigen::Vector3d& action, std::default_random_engine* engine,
+                        FixedState* successor, double* reward, bool* terminal) const
+{
   // Get the step which will be applied
-  Eigen::VectorXd next_cmd(3);
+  Eigen::Vector3d next_cmd;
   for (int dim = 0; dim < 3; dim++)
   {
     // Ensuring that acceleration is in the bounds
-    const Eigen::MatrixXd& action_limits = getActionLimits(0);
-    double min_acc = action_limits(dim, 0);
-    double max_acc = action_limits(dim, 1);
-    double bounded_action = std::min(max_acc, std::max(min_acc, action(dim + 1)));
+    double min_acc = fixed_action_limits(dim, 0);
+    double max_acc = fixed_action_limits(dim, 1);
+    double bounded_action = std::min(max_acc, std::max(min_acc, action(dim)));
     // Action applies a delta on step
     next_cmd(dim) = bounded_action + state(dim + 3);
     // Ensuring that final action is inside of the bounds
-    const Eigen::MatrixXd& limits = getStateLimits();
-    double min_cmd = limits(dim + 3, 0);
-    double max_cmd = limits(dim + 3, 1);
+    double min_cmd = fixed_state_limits(dim + 3, 0);
+    double max_cmd = fixed_state_limits(dim + 3, 1);
     next_cmd(dim) = std::min(max_cmd, std::max(min_cmd, next_cmd(dim)));
   }
   // Apply a linear modification (from theory to 'reality')
-  Eigen::VectorXd real_move = odometry.getDiffFullStep(next_cmd, engine);
-  // Apply the real move
-  Eigen::VectorXd next_state = state;
+  Eigen::Vector3d real_move = odometry.getDiffFullStep(next_cmd, engine);
   // Apply rotation first
   double delta_theta = real_move(2);
-  next_state(2) = normalizeAngle(state(2) - delta_theta);
-  next_state(1) = normalizeAngle(state(1) - delta_theta);
+  double target_angle = normalizeAngle(state(2) - delta_theta);
+  double ball_dir = normalizeAngle(state(1) - delta_theta);
   // Then, apply translation
-  double ball_x = getBallX(next_state) - real_move(0);
-  double ball_y = getBallY(next_state) - real_move(1);
-  double new_dist = std::sqrt(ball_x * ball_x + ball_y * ball_y);
-  double new_dir = atan2(ball_y, ball_x);
-  next_state(0) = new_dist;
-  next_state(1) = new_dir;
-  // Update cmd
-  next_state.segment(3, 3) = next_cmd;
-  Problem::Result result;
-  result.successor = next_state;
-  result.reward = getReward(state, action, next_state);
-  result.terminal = isTerminal(next_state);
-  return result;
+  double ball_x = cos(ball_dir) * state(0) - real_move(0);
+  double ball_y = sin(ball_dir) * state(0) - real_move(1);
+  // State is not used anymore, successor can be written
+  FixedState& next_state = *successor;
+  next_state(0) = std::sqrt(ball_x * ball_x + ball_y * ball_y);
+  next_state(1) = atan2(ball_y, ball_x);
+  next_state(2) = target_angle;
+  next_state.segment<3>(3) = next_cmd;
+  *reward = getReward(next_state);
+  *terminal = isTerminal(next_state);
+}
+
+void BallApproach::getSuccessors(const Eigen::MatrixXd& states, const Eigen::MatrixXd& actions,
+                                 std::default_random_engine* engine, Eigen::MatrixXd* successors,
+                                 Eigen::VectorXd* rewards, Eigen::Array<bool, -1, 1>* terminal, bool strict) const
+{
+  int n = states.cols();
+  if (states.rows() != 6 || actions.rows() != 4 || actions.cols() != n || successors->rows() != 6 ||
+      successors->cols() != n || rewards->rows() != n || terminal->rows() != n)
+  {
+    std::ostringstream oss;
+    oss << "BallApproach::getSuccessors: invalid dimensions: states " << states.rows() << "x" << states.cols()
+        << ", actions " << actions.rows() << "x" << actions.cols() << ", successors " << successors->rows() << "x"
+        << successors->cols() << ", rewards " << rewards->rows() << ", terminal " << terminal->rows();
+    throw std::logic_error(oss.str());
+  }
+  if (strict)
+  {
+    FixedState successor;
+    for (int col = 0; col < n; col++)
+    {
+      step(states.col(col), actions.block<3, 1>(1, col), engine, &successor, &((*rewards)(col)), &((*terminal)(col)));
+      successors->col(col) = successor;
+    }
+    return;
+  }
+  // Commands: clamping the variation, then the command itself
+  Eigen::ArrayXXd cmd = states.bottomRows<3>().array() +
+                        actions.bottomRows<3>()
+                            .array()
+                            .max(fixed_action_limits.col(0).array().replicate(1, n))
+                            .min(fixed_action_limits.col(1).array().replicate(1, n));
+  cmd = cmd.max(fixed_state_limits.bottomLeftCorner<3, 1>().array().replicate(1, n))
+            .min(fixed_state_limits.bottomRightCorner<3, 1>().array().replicate(1, n));
+  // Odometry of all the columns, noise is drawn in a single batch
+  Eigen::MatrixXd moves(3, n);
+  odometry.getDiffsFullStep(cmd.matrix(), engine, &moves);
+  // Rotation
+  Eigen::ArrayXd target_angle = states.row(2).transpose().array() - moves.row(2).transpose().array();
+  Eigen::ArrayXd ball_dir = states.row(1).transpose().array() - moves.row(2).transpose().array();
+  target_angle -= 2.0 * M_PI * ((target_angle + M_PI) / (2.0 * M_PI)).floor();
+  ball_dir -= 2.0 * M_PI * ((ball_dir + M_PI) / (2.0 * M_PI)).floor();
+  // Translation
+  Eigen::ArrayXd sin_dir(n), cos_dir(n);
+  sinCos(n, ball_dir.data(), sin_dir.data(), cos_dir.data());
+  Eigen::ArrayXd ball_dist = states.row(0).transpose().array();
+  Eigen::ArrayXd ball_x = cos_dir * ball_dist - moves.row(0).transpose().array();
+  Eigen::ArrayXd ball_y = sin_dir * ball_dist - moves.row(1).transpose().array();
+  successors->row(0) = (ball_x.square() + ball_y.square()).sqrt().matrix().transpose();
+  // No vectorized atan2 is available
+  for (int col = 0; col < n; col++)
+  {
+    (*successors)(1, col) = std::atan2(ball_y(col), ball_x(col));
+  }
+  successors->row(2) = target_angle.matrix().transpose();
+  successors->bottomRows<3>() = cmd.matrix();
+  // Rewards and terminal status
+  for (int col = 0; col < n; col++)
+  {
+    FixedState successor = successors->col(col);
+    (*rewards)(col) = getReward(successor);
+    (*terminal)(col) = isTerminal(successor);
+  }
 }
 
 Eigen::VectorXd BallApproach::getStartingState(std::default_random_engine* engine) const
@@ -211,27 +293,29 @@ Eigen::VectorXd BallApproach::getStartingState(std::default_random_engine* engin
 
 bool BallApproach::isKickable(const Eigen::VectorXd& state) const
 {
-  if (kick_zones.size() == 0)
+  return isKickable(FixedState(state));
+}
+
+bool BallApproach::isKickable(const FixedState& state) const
+{
+  if (compiled_kick_zones.nbZones() == 0)
   {
     throw std::logic_error("BallApproach::isKickable: No kick zones");
   }
 
-  Eigen::Vector3d ball_state;
-  ball_state << getBallX(state), getBallY(state), state(2);
-  for (const KickZone& zone : kick_zones)
-  {
-    if (zone.isKickable(ball_state))
-    {
-      return true;
-    }
-  }
-  return false;
+  Eigen::Vector3d ball_state(cos(state(1)) * state(0), sin(state(1)) * state(0), state(2));
+  return compiled_kick_zones.isKickable(ball_state);
 }
 
 bool BallApproach::isColliding(const Eigen::VectorXd& state) const
 {
-  double ball_x = getBallX(state);
-  double ball_y = getBallY(state);
+  return isColliding(FixedState(state));
+}
+
+bool BallApproach::isColliding(const FixedState& state) const
+{
+  double ball_x = cos(state(1)) * state(0);
+  double ball_y = sin(state(1)) * state(0);
   bool x_ko = ball_x > -collision_x_back && ball_x < collision_x_front;
   bool y_ko = std::fabs(ball_y) < collision_y;
   return x_ko && y_ko;
@@ -239,10 +323,14 @@ bool BallApproach::isColliding(const Eigen::VectorXd& state) const
 
 bool BallApproach::isOutOfSpace(const Eigen::VectorXd& state) const
 {
-  const Eigen::MatrixXd& space_limits = getStateLimits();
-  for (int dim = 0; dim < state.rows(); dim++)
+  return isOutOfSpace(FixedState(state));
+}
+
+bool BallApproach::isOutOfSpace(const FixedState& state) const
+{
+  for (int dim = 0; dim < 6; dim++)
   {
-    if (state(dim) < space_limits(dim, 0) || state(dim) > space_limits(dim, 1))
+    if (state(dim) < fixed_state_limits(dim, 0) || state(dim) > fixed_state_limits(dim, 1))
     {
       return true;
     }
@@ -251,11 +339,48 @@ bool BallApproach::isOutOfSpace(const Eigen::VectorXd& state) const
 }
 
 bool BallApproach::seeBall(const Eigen::VectorXd& state) const
+{
+  return seeBall(FixedState(state));
+}
+
+bool BallApproach::seeBall(const FixedState& state) const
 {
   double angle = state(1);
   return angle < viewing_angle && angle > -viewing_angle;
 }
 
+bool BallApproach::hasSymmetry() const
+{
+  // Noise models are all symmetric, but some displacement models contain offsets
+  switch (odometry.getDisplacementType())
+  {
+    case OdometryDisplacementModel::DisplacementIdentity:
+    case OdometryDisplacementModel::DisplacementProportionalXY:
+    case OdometryDisplacementModel::DisplacementProportionalXYA:
+      return true;
+    default:
+      return false;
+  }
+}
+
+Eigen::VectorXd BallApproach::mirrorState(const Eigen::VectorXd& state) const
+{
+  Eigen::VectorXd mirrored = state;
+  for (int dim : { 1, 2, 4, 5 })
+  {
+    mirrored(dim) = -state(dim);
+  }
+  return mirrored;
+}
+
+Eigen::VectorXd BallApproach::mirrorAction(const Eigen::VectorXd& action) const
+{
+  Eigen::VectorXd mirrored = action;
+  mirrored(2) = -action(2);
+  mirrored(3) = -action(3);
+  return mirrored;
+}
+
 Json::Value BallApproach::toJson() const
 {
   throw std::logic_error("BallApproach::toJson: not implemented");
@@ -269,7 +394,15 @@ void BallApproach::fromJson(const Json::Value& v, const std::string& dir_name)
   // If coefficients have been properly read, use them
   if (odometry_path != "")
   {
-    odometry.loadFile(dir_name + odometry_path);
+    // Parsed odometry files are shared between all the problems
+    std::string full_path = dir_name + odometry_path;
+    std::shared_ptr<const Odometry> cached_odometry =
+        ConfigCache<const Odometry>::getFile(full_path, [&full_path]() {
+          std::unique_ptr<Odometry> loaded(new Odometry());
+          loaded->loadFile(full_path);
+          return std::unique_ptr<const Odometry>(std::move(loaded));
+        });
+    odometry = *cached_odometry;
   }
   // Read kicks
   auto kick_zone_builder = [](const Json::Value& v, const std::string& dir_name) {
@@ -311,13 +444,23 @@ void BallApproach::fromJson(const Json::Value& v, const std::string& dir_name)
 
   if (kick_zone_names.size() > 0)
   {
-    KickModelCollection kmc;
-    kmc.loadFile();
+    std::string kmc_path = "KickModelCollection.json";
+    std::shared_ptr<const KickModelCollection> kmc =
+        ConfigCache<const KickModelCollection>::getFile(kmc_path, [&kmc_path]() {
+          std::unique_ptr<KickModelCollection> loaded(new KickModelCollection());
+          loaded->loadFile(kmc_path);
+          return std::unique_ptr<const KickModelCollection>(std::move(loaded));
+        });
     for (const std::string& name : kick_zone_names)
     {
-      kick_zones.push_back(kmc.getKickModel(name).getKickZone());
+      kick_zones.push_back(kmc->getKickModel(name).getKickZone());
     }
   }
+  compiled_kick_zones.clear();
+  for (const KickZone& zone : kick_zones)
+  {
+    compiled_kick_zones.add(zone);
+  }
 
   // Update limits according to the new parameters
   updateLimits();
@@ -0,0 +1,287 @@
+#include "problems/ball_exit_kernel.h"
+
+#include <cmath>
+#include <limits>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace csa_mdp
+{
+BallExitKernel::BallExitKernel()
+  : use_goalie(false), goalie_x(0), goalie_y(0), goalie_thickness(0), goalie_width(0), ball_radius(0)
+{
+  setField(0, 0, 0, 0);
+}
+
+void BallExitKernel::setField(double field_length, double field_width, double goal_width, double ball_radius_)
+{
+  ball_radius = ball_radius_;
+  goal_line_x = field_length / 2;
+  goal_limit_x = field_length / 2 + ball_radius;
+  goal_half_width = goal_width / 2;
+  min_field_x = -field_length / 2 - ball_radius;
+  max_field_x = field_length / 2 + ball_radius;
+  min_field_y = -field_width / 2 - ball_radius;
+  max_field_y = field_width / 2 + ball_radius;
+  updateGoalieBounds();
+}
+
+void BallExitKernel::setGoalie(bool use_goalie_, double goalie_x_, double goalie_y_, double goalie_thickness_,
+                               double goalie_width_)
+{
+  use_goalie = use_goalie_;
+  goalie_x = goalie_x_;
+  goalie_y = goalie_y_;
+  goalie_thickness = goalie_thickness_;
+  goalie_width = goalie_width_;
+  updateGoalieBounds();
+}
+
+void BallExitKernel::updateGoalieBounds()
+{
+  min_goalie_x = goalie_x - goalie_thickness / 2 - ball_radius;
+  max_goalie_x = goalie_x + goalie_thickness / 2 + ball_radius;
+  min_goalie_y = goalie_y - goalie_width / 2 - ball_radius;
+  max_goalie_y = goalie_y + goalie_width / 2 + ball_radius;
+}
+
+BallExitKernel::Event BallExitKernel::process(double src_x, double src_y, double* dst_x, double* dst_y) const
+{
+  if (use_goalie && isCollidingGoalie(src_x, src_y, dst_x, dst_y))
+  {
+    return Event::GoalieCollision;
+  }
+  else if (isGoal(src_x, src_y, dst_x, dst_y))
+  {
+    return Event::Goal;
+  }
+  else if (isOut(*dst_x, *dst_y))
+  {
+    return Event::Out;
+  }
+  return Event::None;
+}
+
+void BallExitKernel::process(int n, const double* src_x, const double* src_y, double* dst_x, double* dst_y,
+                             Event* events) const
+{
+  int start = processAVX2(n, src_x, src_y, dst_x, dst_y, events);
+  for (int i = start; i < n; i++)
+  {
+    events[i] = process(src_x[i], src_y[i], dst_x + i, dst_y + i);
+  }
+}
+
+bool BallExitKernel::isCollidingGoalie(double src_x, double src_y, double* dst_x, double* dst_y) const
+{
+  double dx = *dst_x - src_x;
+  double dy = *dst_y - src_y;
+  // 1: If both points are above or below specific values, collision is not possible
+  bool below_x = src_x < min_goalie_x && *dst_x < min_goalie_x;
+  bool above_x = src_x > max_goalie_x && *dst_x > max_goalie_x;
+  bool below_y = src_y < min_goalie_y && *dst_y < min_goalie_y;
+  bool above_y = src_y > max_goalie_y && *dst_y > max_goalie_y;
+  if (below_x || above_x || below_y || above_y)
+    return false;
+  // 2: Special case, ball moving laterally: spot first collision (mandatory)
+  if (dx == 0)
+  {
+    double dist_to_min = std::fabs(src_y - min_goalie_y);
+    double dist_to_max = std::fabs(src_y - max_goalie_y);
+    *dst_y = dist_to_min < dist_to_max ? min_goalie_y : max_goalie_y;
+    return true;
+  }
+  // 3: Computing trajectories under the form a*x + b
+  double a = dy / dx;
+  double b = src_y - a * src_x;
+  // 4: Testing the 4 sides of the goalie and keeping the closest collision to 'src'
+  double best_dist2 = std::numeric_limits<double>::max();
+  bool found = false;
+  double best_x = 0, best_y = 0;
+  for (int side = 0; side < 4; side++)
+  {
+    double tmp_x, tmp_y;
+    bool valid;
+    if (side < 2)
+    {
+      tmp_x = side == 0 ? min_goalie_x : max_goalie_x;
+      tmp_y = a * tmp_x + b;
+      valid = tmp_y > min_goalie_y && tmp_y < max_goalie_y;
+    }
+    else
+    {
+      if (a == 0)
+        continue;
+      tmp_y = side == 2 ? min_goalie_y : max_goalie_y;
+      tmp_x = (tmp_y - b) / a;
+      valid = tmp_x > min_goalie_x && tmp_x < max_goalie_x;
+    }
+    if (!valid)
+      continue;
+    double cdx = tmp_x - src_x;
+    double cdy = tmp_y - src_y;
+    double dist2 = cdx * cdx + cdy * cdy;
+    if (dist2 < best_dist2)
+    {
+      best_dist2 = dist2;
+      best_x = tmp_x;
+      best_y = tmp_y;
+      found = true;
+    }
+  }
+  // 5: If no collision has been found return false
+  if (!found)
+    return false;
+  *dst_x = best_x;
+  *dst_y = best_y;
+  return true;
+}
+
+bool BallExitKernel::isGoal(double src_x, double src_y, double* dst_x, double* dst_y) const
+{
+  double dx = *dst_x - src_x;
+  // Impossible to score a goal by kicking backward or if ball did not entirely cross the line
+  if (dx <= 0 || *dst_x < goal_limit_x)
+    return false;
+  // Finding equation a*x +b;
+  double dy = *dst_y - src_y;
+  double a = dy / dx;
+  double b = src_y - a * src_x;
+  // Finding intersection with goal line
+  double intercept_y = a * goal_line_x + b;
+  if (std::fabs(intercept_y) >= goal_half_width)
+    return false;
+  // Set x to a given limit without changing trajectory
+  *dst_x = goal_limit_x;
+  *dst_y = a * goal_limit_x + b;
+  return true;
+}
+
+bool BallExitKernel::isOut(double dst_x, double dst_y) const
+{
+  return (dst_x < min_field_x || dst_y < min_field_y || dst_x > max_field_x || dst_y > max_field_y);
+}
+
+#ifdef __AVX2__
+int BallExitKernel::processAVX2(int n, const double* src_x, const double* src_y, double* dst_x, double* dst_y,
+                                Event* events) const
+{
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d sign_mask = _mm256_set1_pd(-0.0);
+  const __m256d g_min_x = _mm256_set1_pd(min_goalie_x);
+  const __m256d g_max_x = _mm256_set1_pd(max_goalie_x);
+  const __m256d g_min_y = _mm256_set1_pd(min_goalie_y);
+  const __m256d g_max_y = _mm256_set1_pd(max_goalie_y);
+  const __m256d line_x = _mm256_set1_pd(goal_line_x);
+  const __m256d limit_x = _mm256_set1_pd(goal_limit_x);
+  const __m256d half_width = _mm256_set1_pd(goal_half_width);
+  const __m256d f_min_x = _mm256_set1_pd(min_field_x);
+  const __m256d f_max_x = _mm256_set1_pd(max_field_x);
+  const __m256d f_min_y = _mm256_set1_pd(min_field_y);
+  const __m256d f_max_y = _mm256_set1_pd(max_field_y);
+  const __m256d goalie_enabled = use_goalie ? _mm256_castsi256_pd(_mm256_set1_epi64x(-1)) : zero;
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m256d sx = _mm256_loadu_pd(src_x + i);
+    __m256d sy = _mm256_loadu_pd(src_y + i);
+    __m256d ex = _mm256_loadu_pd(dst_x + i);
+    __m256d ey = _mm256_loadu_pd(dst_y + i);
+    __m256d dx = _mm256_sub_pd(ex, sx);
+    __m256d dy = _mm256_sub_pd(ey, sy);
+    // Lines equations a*x+b, divisions by zero are avoided to keep floating
+    // point exceptions silent, affected lanes are handled separately
+    __m256d dx_zero = _mm256_cmp_pd(dx, zero, _CMP_EQ_OQ);
+    __m256d a = _mm256_div_pd(dy, _mm256_blendv_pd(dx, one, dx_zero));
+    __m256d b = _mm256_sub_pd(sy, _mm256_mul_pd(a, sx));
+    // 1: Goalie collision
+    __m256d rejected = _mm256_or_pd(
+        _mm256_or_pd(_mm256_and_pd(_mm256_cmp_pd(sx, g_min_x, _CMP_LT_OQ), _mm256_cmp_pd(ex, g_min_x, _CMP_LT_OQ)),
+                     _mm256_and_pd(_mm256_cmp_pd(sx, g_max_x, _CMP_GT_OQ), _mm256_cmp_pd(ex, g_max_x, _CMP_GT_OQ))),
+        _mm256_or_pd(_mm256_and_pd(_mm256_cmp_pd(sy, g_min_y, _CMP_LT_OQ), _mm256_cmp_pd(ey, g_min_y, _CMP_LT_OQ)),
+                     _mm256_and_pd(_mm256_cmp_pd(sy, g_max_y, _CMP_GT_OQ), _mm256_cmp_pd(ey, g_max_y, _CMP_GT_OQ))));
+    __m256d a_zero = _mm256_cmp_pd(a, zero, _CMP_EQ_OQ);
+    __m256d safe_a = _mm256_blendv_pd(a, one, a_zero);
+    __m256d best_d2 = _mm256_set1_pd(std::numeric_limits<double>::max());
+    __m256d best_x = ex;
+    __m256d best_y = ey;
+    __m256d found = zero;
+    for (int side = 0; side < 4; side++)
+    {
+      __m256d cx, cy, valid;
+      if (side < 2)
+      {
+        cx = side == 0 ? g_min_x : g_max_x;
+        cy = _mm256_add_pd(_mm256_mul_pd(a, cx), b);
+        valid = _mm256_and_pd(_mm256_cmp_pd(cy, g_min_y, _CMP_GT_OQ), _mm256_cmp_pd(cy, g_max_y, _CMP_LT_OQ));
+      }
+      else
+      {
+        cy = side == 2 ? g_min_y : g_max_y;
+        cx = _mm256_div_pd(_mm256_sub_pd(cy, b), safe_a);
+        valid = _mm256_and_pd(_mm256_cmp_pd(cx, g_min_x, _CMP_GT_OQ), _mm256_cmp_pd(cx, g_max_x, _CMP_LT_OQ));
+        valid = _mm256_andnot_pd(a_zero, valid);
+      }
+      __m256d cdx = _mm256_sub_pd(cx, sx);
+      __m256d cdy = _mm256_sub_pd(cy, sy);
+      __m256d d2 = _mm256_add_pd(_mm256_mul_pd(cdx, cdx), _mm256_mul_pd(cdy, cdy));
+      __m256d better = _mm256_and_pd(valid, _mm256_cmp_pd(d2, best_d2, _CMP_LT_OQ));
+      best_d2 = _mm256_blendv_pd(best_d2, d2, better);
+      best_x = _mm256_blendv_pd(best_x, cx, better);
+      best_y = _mm256_blendv_pd(best_y, cy, better);
+      found = _mm256_or_pd(found, valid);
+    }
+    // Special case, ball moving laterally
+    __m256d dist_to_min = _mm256_andnot_pd(sign_mask, _mm256_sub_pd(sy, g_min_y));
+    __m256d dist_to_max = _mm256_andnot_pd(sign_mask, _mm256_sub_pd(sy, g_max_y));
+    __m256d lateral_y = _mm256_blendv_pd(g_max_y, g_min_y, _mm256_cmp_pd(dist_to_min, dist_to_max, _CMP_LT_OQ));
+    best_x = _mm256_blendv_pd(best_x, ex, dx_zero);
+    best_y = _mm256_blendv_pd(best_y, lateral_y, dx_zero);
+    __m256d collision = _mm256_and_pd(goalie_enabled, _mm256_andnot_pd(rejected, _mm256_or_pd(dx_zero, found)));
+    // 2: Goal
+    __m256d forward = _mm256_and_pd(_mm256_cmp_pd(dx, zero, _CMP_GT_OQ), _mm256_cmp_pd(ex, limit_x, _CMP_GE_OQ));
+    __m256d intercept_y = _mm256_add_pd(_mm256_mul_pd(a, line_x), b);
+    __m256d inside = _mm256_cmp_pd(_mm256_andnot_pd(sign_mask, intercept_y), half_width, _CMP_LT_OQ);
+    __m256d goal = _mm256_andnot_pd(collision, _mm256_and_pd(forward, inside));
+    __m256d goal_y = _mm256_add_pd(_mm256_mul_pd(a, limit_x), b);
+    // 3: Out of the field (tested on the original destination)
+    __m256d out = _mm256_or_pd(
+        _mm256_or_pd(_mm256_cmp_pd(ex, f_min_x, _CMP_LT_OQ), _mm256_cmp_pd(ey, f_min_y, _CMP_LT_OQ)),
+        _mm256_or_pd(_mm256_cmp_pd(ex, f_max_x, _CMP_GT_OQ), _mm256_cmp_pd(ey, f_max_y, _CMP_GT_OQ)));
+    out = _mm256_andnot_pd(_mm256_or_pd(collision, goal), out);
+    // Writing results
+    __m256d res_x = _mm256_blendv_pd(_mm256_blendv_pd(ex, limit_x, goal), best_x, collision);
+    __m256d res_y = _mm256_blendv_pd(_mm256_blendv_pd(ey, goal_y, goal), best_y, collision);
+    _mm256_storeu_pd(dst_x + i, res_x);
+    _mm256_storeu_pd(dst_y + i, res_y);
+    int collision_bits = _mm256_movemask_pd(collision);
+    int goal_bits = _mm256_movemask_pd(goal);
+    int out_bits = _mm256_movemask_pd(out);
+    for (int lane = 0; lane < 4; lane++)
+    {
+      int bit = 1 << lane;
+      events[i + lane] = (collision_bits & bit) ? Event::GoalieCollision :
+                                                  (goal_bits & bit) ? Event::Goal :
+                                                                      (out_bits & bit) ? Event::Out : Event::None;
+    }
+  }
+  return i;
+}
+#else
+int BallExitKernel::processAVX2(int n, const double* src_x, const double* src_y, double* dst_x, double* dst_y,
+                                Event* events) const
+{
+  (void)n;
+  (void)src_x;
+  (void)src_y;
+  (void)dst_x;
+  (void)dst_y;
+  (void)events;
+  return 0;
+}
+#endif
+
+}  // namespace csa_mdp
@@ -6,37 +6,32 @@
 
 namespace csa_mdp
 {
-// Above this threshold, trial is a failure
-double CartPoleStabilization::theta_max = M_PI / 2;  //[rad]
-// While this limit is not directly given in the article, this value
-// is used for n_{dttheta} (page 5 bottom right colum)
-double CartPoleStabilization::omega_max = 2;  //[rad/s]
-// limit of allowed actions
-double CartPoleStabilization::action_max = 50;  //[N]
-double CartPoleStabilization::noise_max = 10;   //[N]
-
-double CartPoleStabilization::integration_step = 0.001;  // Information are required here
-double CartPoleStabilization::simulation_step = 0.1;
-double CartPoleStabilization::pendulum_mass = 2.0;
-double CartPoleStabilization::cart_mass = 6.0;
-double CartPoleStabilization::pendulum_length = 0.5;
-double CartPoleStabilization::g = 9.8;
-
-CartPoleStabilization::CartPoleStabilization() : learning_space(LearningSpace::Angular)
+CartPoleStabilization::CartPoleStabilization()
+  : learning_space(LearningSpace::Angular)
+  , simulation_step(0.1)
+  , pendulum_mass(2.0)
+  , cart_mass(6.0)
+  , pendulum_length(0.5)
+  , gravity(9.8)
+  // Above this threshold, trial is a failure
+  , theta_max(M_PI / 2)
+  // While this limit is not directly given in the article, this value
+  // is used for n_{dttheta} (page 5 bottom right colum)
+  , omega_max(2)
+  // limit of allowed actions
+  , action_max(50)
+  , noise_max(10)
 {
-  Eigen::MatrixXd state_limits = Eigen::MatrixXd(4, 2);
-  state_limits(0, 0) = -theta_max;
-  state_limits(0, 1) = theta_max;
-  state_limits(1, 0) = -omega_max;
-  state_limits(1, 1) = omega_max;
-  state_limits(2, 0) = -1;
-  state_limits(2, 1) = 1;
-  state_limits(3, 0) = -1;
-  state_limits(3, 1) = 1;
-  Eigen::MatrixXd action_limits = Eigen::MatrixXd(1, 2);
-  action_limits(0, 0) = -action_max;
-  action_limits(0, 1) = action_max;
+  // Information are required here
+  integrator.setFixedStep(OdeIntegrator::Method::Euler, 0.001);
+  updateLimits();
+}
 
+void CartPoleStabilization::updateLimits()
+{
+  Eigen::MatrixXd state_limits(4, 2), action_limits(1, 2);
+  state_limits << -theta_max, theta_max, -omega_max, omega_max, -1, 1, -1, 1;
+  action_limits << -action_max, action_max;
   setStateLimits(state_limits);
   setActionLimits({ action_limits });
   setStateNames({ "theta", "omega", "cos(theta)", "sin(theta)" });
@@ -111,27 +106,26 @@ Eigen::VectorXd CartPoleStabilization::getFullSuccessor(const Eigen::VectorXd& s
   // Adding noise to action
   double noisy_action = action(1) + noise_distribution(*engine);
   // Integrating action with the system dynamics
-  double elapsed = 0;
-  Eigen::VectorXd current_state = state;
-  while (elapsed < simulation_step)
-  {
-    double dt = std::min(simulation_step - elapsed, integration_step);
-    double th = current_state(0);
-    double dt_th = current_state(1);
-    double dt_th2 = dt_th * dt_th;
-    double alpha = 1 / (pendulum_mass + cart_mass);
-    double acc = (g * sin(th) - alpha * pendulum_mass * pendulum_length * dt_th2 * sin(2 * th) / 2 -
-                  alpha * cos(th) * noisy_action) /
-                 (4 * pendulum_length / 3 - alpha * pendulum_mass * pendulum_length * std::pow(cos(th), 2));
-    Eigen::VectorXd next_state(4);
-    next_state(0) = th + dt * dt_th;
-    next_state(1) = dt_th + dt * acc;
-    next_state(2) = cos(next_state(0));
-    next_state(3) = sin(next_state(0));
-    elapsed += dt;
-    current_state = next_state;
-  }
-  return current_state;
+  auto derivative = [this, noisy_action](const Eigen::Vector2d& x) { return getDerivative(x, noisy_action); };
+  Eigen::Vector2d dynamic_state = integrator.integrate<2>(state.segment(0, 2), simulation_step, derivative);
+  Eigen::VectorXd next_state(4);
+  next_state.segment(0, 2) = dynamic_state;
+  next_state(2) = cos(next_state(0));
+  next_state(3) = sin(next_state(0));
+  return next_state;
+}
+
+Eigen::Vector2d CartPoleStabilization::getDerivative(const Eigen::Vector2d& state, double torque) const
+{
+  double th = state(0);
+  double dt_th = state(1);
+  double dt_th2 = dt_th * dt_th;
+  double cos_th = cos(th);
+  double alpha = 1 / (pendulum_mass + cart_mass);
+  double acc = (gravity * sin(th) - alpha * pendulum_mass * pendulum_length * dt_th2 * sin(2 * th) / 2 -
+                alpha * cos_th * torque) /
+               (4 * pendulum_length / 3 - alpha * pendulum_mass * pendulum_length * cos_th * cos_th);
+  return Eigen::Vector2d(dt_th, acc);
 }
 
 Eigen::VectorXd CartPoleStabilization::getAngularSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
@@ -216,17 +210,50 @@ Json::Value CartPoleStabilization::toJson() const
 {
   Json::Value v;
   v["learning_space"] = to_string(learning_space);
+  v["simulation_step"] = simulation_step;
+  v["pendulum_mass"] = pendulum_mass;
+  v["cart_mass"] = cart_mass;
+  v["pendulum_length"] = pendulum_length;
+  v["gravity"] = gravity;
+  v["theta_max"] = theta_max;
+  v["omega_max"] = omega_max;
+  v["action_max"] = action_max;
+  v["noise_max"] = noise_max;
+  v["integrator"] = integrator.toJson();
   return v;
 }
 void CartPoleStabilization::fromJson(const Json::Value& v, const std::string& dir_name)
 {
-  (void)dir_name;
   std::string learning_space_str;
   rhoban_utils::tryRead(v, "learning_space", &learning_space_str);
   if (learning_space_str != "")
   {
     learning_space = loadLearningSpace(learning_space_str);
   }
+  rhoban_utils::tryRead(v, "simulation_step", &simulation_step);
+  rhoban_utils::tryRead(v, "pendulum_mass", &pendulum_mass);
+  rhoban_utils::tryRead(v, "cart_mass", &cart_mass);
+  rhoban_utils::tryRead(v, "pendulum_length", &pendulum_length);
+  rhoban_utils::tryRead(v, "gravity", &gravity);
+  rhoban_utils::tryRead(v, "theta_max", &theta_max);
+  rhoban_utils::tryRead(v, "omega_max", &omega_max);
+  rhoban_utils::tryRead(v, "action_max", &action_max);
+  rhoban_utils::tryRead(v, "noise_max", &noise_max);
+  if (simulation_step <= 0 || pendulum_mass <= 0 || cart_mass < 0 || pendulum_length <= 0 || theta_max <= 0 ||
+      omega_max <= 0 || action_max < 0 || noise_max < 0)
+  {
+    throw rhoban_utils::JsonParsingError("CartPoleStabilization::fromJson: invalid physical parameters or limits");
+  }
+  // 'integration_step' is a shortcut for explicit Euler with the given step
+  if (v.isMember("integration_step"))
+  {
+    integrator.setFixedStep(OdeIntegrator::Method::Euler, rhoban_utils::read<double>(v, "integration_step"));
+  }
+  if (v.isMember("integrator"))
+  {
+    integrator.fromJson(v["integrator"], dir_name);
+  }
+  updateLimits();
 }
 
 std::string CartPoleStabilization::getClassName() const
@@ -6,8 +6,10 @@
 
 namespace csa_mdp
 {
-DoubleIntegrator::DoubleIntegrator(Version version_) : version(version_), random_start(false)
+DoubleIntegrator::DoubleIntegrator(Version version_) : version(version_), random_start(false), simulation_step(0.5)
 {
+  transition << 1, simulation_step, 0, 1;
+  input << simulation_step * simulation_step / 2, simulation_step;
   Eigen::MatrixXd state_limits(2, 2), action_limits(1, 2);
   switch (version)
   {
@@ -26,26 +28,32 @@ DoubleIntegrator::DoubleIntegrator(Version version_) : version(version_), random
 }
 
 bool DoubleIntegrator::isTerminal(const Eigen::VectorXd& state) const
+{
+  return isTerminal(state(0), state(1));
+}
+
+bool DoubleIntegrator::isTerminal(double pos, double vel) const
 {
   if (version == Weinstein2012)
     return false;  // No terminal state
-  for (int i = 0; i < 2; i++)
-  {
-    if (state(i) < getStateLimits()(i, 0) || state(i) > getStateLimits()(i, 1))
-      return true;
-  }
-  return false;
+  const Eigen::MatrixXd& limits = getStateLimits();
+  return pos < limits(0, 0) || pos > limits(0, 1) || vel < limits(1, 0) || vel > limits(1, 1);
 }
 
 double DoubleIntegrator::getReward(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                                    const Eigen::VectorXd& dst) const
 {
-  if (isTerminal(dst))
+  return getReward(state(0), action(0), isTerminal(dst));
+}
+
+double DoubleIntegrator::getReward(double pos, double acc, bool terminal) const
+{
+  if (terminal)
   {
     return -50;
   }
-  double posCost = state(0) * state(0);
-  double accCost = action(0) * action(0);
+  double posCost = pos * pos;
+  double accCost = acc * acc;
   return -(posCost + accCost);
 }
 
@@ -60,35 +68,48 @@ Problem::Result DoubleIntegrator::getSuccessor(const Eigen::VectorXd& state, con
     throw std::runtime_error(oss.str());
   }
 
-  std::uniform_real_distribution<double> noise_distribution;
-  if (version == Weinstein2012)
+  Problem::Result result;
+  result.successor = transition * state + input * getAcceleration(action(1), engine);
+  result.reward = getReward(state, action, result.successor);
+  result.terminal = isTerminal(result.successor);
+  return result;
+}
+
+void DoubleIntegrator::getSuccessors(const Eigen::MatrixXd& states, const Eigen::MatrixXd& actions,
+                                     std::default_random_engine* engine, Eigen::MatrixXd* successors,
+                                     Eigen::VectorXd* rewards, Eigen::Array<bool, -1, 1>* terminal) const
+{
+  int n = states.cols();
+  if (states.rows() != 2 || actions.rows() != 2 || actions.cols() != n || successors->rows() != 2 ||
+      successors->cols() != n || rewards->rows() != n || terminal->rows() != n)
   {
-    noise_distribution = std::uniform_real_distribution<double>(-0.1, 0.1);
+    std::ostringstream oss;
+    oss << "DoubleIntegrator::getSuccessors: invalid dimensions: states " << states.rows() << "x" << states.cols()
+        << ", actions " << actions.rows() << "x" << actions.cols() << ", successors " << successors->rows() << "x"
+        << successors->cols() << ", rewards " << rewards->rows() << ", terminal " << terminal->rows();
+    throw std::logic_error(oss.str());
   }
-  double integrationStep = 0.05;
-  double simulationStep = 0.5;
-  double elapsed = 0;
-  double acc = action(1);
-  if (version == Version::Weinstein2012)
+  Eigen::RowVectorXd acc(n);
+  for (int col = 0; col < n; col++)
   {
-    acc += noise_distribution(*engine);
+    acc(col) = getAcceleration(actions(1, col), engine);
   }
-  Eigen::VectorXd currentState = state;
-  while (elapsed < simulationStep)
+  successors->noalias() = transition * states + input * acc;
+  for (int col = 0; col < n; col++)
   {
-    double dt = std::min(simulationStep - elapsed, integrationStep);
-    Eigen::Vector2d nextState;
-    double vel = currentState(1);
-    nextState(0) = currentState(0) + dt * vel;
-    nextState(1) = currentState(1) + dt * acc;
-    elapsed += dt;
-    currentState = nextState;
+    (*terminal)(col) = isTerminal((*successors)(0, col), (*successors)(1, col));
+    (*rewards)(col) = getReward(states(0, col), actions(0, col), (*terminal)(col));
   }
-  Problem::Result result;
-  result.successor = currentState;
-  result.reward = getReward(state, action, currentState);
-  result.terminal = isTerminal(currentState);
-  return result;
+}
+
+double DoubleIntegrator::getAcceleration(double cmd, std::default_random_engine* engine) const
+{
+  if (version == Weinstein2012)
+  {
+    std::uniform_real_distribution<double> noise_distribution(-0.1, 0.1);
+    return cmd + noise_distribution(*engine);
+  }
+  return cmd;
 }
 
 Eigen::VectorXd DoubleIntegrator::getStartingState(std::default_random_engine* engine) const
@@ -5,8 +5,9 @@
 #include "kick_model/kick_model_factory.h"
 
 #include "rhoban_csa_mdp/core/policy_factory.h"
-#include "rhoban_fa/function_approximator_factory.h"
 #include "rhoban_random/tools.h"
+#include "utils/config_cache.h"
+#include "utils/disk_sampling.h"
 
 using namespace rhoban_utils;
 
@@ -18,6 +19,59 @@ static double normalizeAngle(double angle)
 
 namespace csa_mdp
 {
+KickControler::ApproachPolicy::ApproachPolicy() : shared(false)
+{
+}
+
+void KickControler::ApproachPolicy::tryRead(const Json::Value& v, const std::string& policy_dir)
+{
+  if (!v.isMember("policy"))
+  {
+    return;
+  }
+  description = Json::Value();
+  description["policy"] = v["policy"];
+  dir_name = policy_dir;
+  shared = false;
+  rhoban_utils::tryRead(v, "share_policy", &shared);
+  policy.reset();
+}
+
+void KickControler::ApproachPolicy::build(const std::vector<Eigen::MatrixXd>& action_limits)
+{
+  if (description.isNull())
+  {
+    return;
+  }
+  auto loader = [this, &action_limits]() {
+    std::unique_ptr<Policy> result = PolicyFactory().read(description, "policy", dir_name);
+    result->setActionLimits(action_limits);
+    return std::unique_ptr<const Policy>(std::move(result));
+  };
+  if (!shared)
+  {
+    policy = loader();
+    return;
+  }
+  std::ostringstream key;
+  key.precision(17);
+  key << dir_name << std::endl << description["policy"].toStyledString();
+  for (const Eigen::MatrixXd& limits : action_limits)
+  {
+    key << limits << std::endl;
+  }
+  policy = ConfigCache<const Policy>::getContent(key.str(), loader);
+}
+
+const Policy* KickControler::ApproachPolicy::get() const
+{
+  return policy.get();
+}
+
+KickControler::KickOption::KickOption() : single_kick(false)
+{
+}
+
 Json::Value KickControler::KickOption::toJson() const
 {
   throw std::logic_error("KickControler::KickOption::toJson: not implemented");
@@ -28,7 +82,7 @@ void KickControler::KickOption::fromJson(const Json::Value& v, const std::string
   kick_decision_model = KickDecisionModelFactory().read(v, "kick_decision_model", dir_name);
   approach_model.tryRead(v, "approach_model", dir_name);
   // Replace approach_policy if found
-  PolicyFactory().tryRead(v, "policy", dir_name, &approach_policy);
+  approach_policy.tryRead(v, dir_name);
   // Reading kick_model from name if found
   kick_model_names = rhoban_utils::readVector<std::string>(v, "kick_model_names");
 }
@@ -38,13 +92,48 @@ std::string KickControler::KickOption::getClassName() const
   return "kick_controler_kick_option";
 }
 
-void KickControler::KickOption::syncKickZones(const KickModelCollection& kmc)
+void KickControler::KickOption::compile(const KickModelCollection& kmc)
 {
+  if (kick_model_names.size() == 0)
+  {
+    throw std::logic_error("KickControler::KickOption::compile: no kick_model_names for kick_option");
+  }
   approach_model.clearKickZones();
+  compiled_kicks.clear();
+  compiled_zones.clear();
   for (const std::string& name : kick_model_names)
   {
-    approach_model.addKickZone(kmc.getKickModel(name).getKickZone());
+    CompiledKick kick;
+    kick.model = &(kmc.getKickModel(name));
+    kick.zone = &(kick.model->getKickZone());
+    for (bool right_foot : { false, true })
+    {
+      Eigen::Vector3d wished_state = kick.zone->getWishedPos(right_foot);
+      CompiledKick::FootPlacement& foot = kick.feet[right_foot ? 1 : 0];
+      foot.dx = -wished_state(0);
+      foot.dy = -wished_state(1);
+      foot.theta_offset = wished_state(2);
+      foot.cos_offset = cos(wished_state(2));
+      foot.sin_offset = sin(wished_state(2));
+    }
+    compiled_kicks.push_back(kick);
+    compiled_zones.add(*kick.zone);
+    approach_model.addKickZone(*kick.zone);
   }
+  single_kick = compiled_kicks.size() == 1;
+}
+
+Eigen::Vector3d KickControler::KickOption::CompiledKick::getWishedPosInField(const Eigen::Vector2d& ball_pos,
+                                                                            double kick_dir, double cos_dir,
+                                                                            double sin_dir, bool right_foot) const
+{
+  const FootPlacement& foot = feet[right_foot ? 1 : 0];
+  // cos and sin of robot_dir = kick_dir + offset
+  double cos_robot = cos_dir * foot.cos_offset - sin_dir * foot.sin_offset;
+  double sin_robot = sin_dir * foot.cos_offset + cos_dir * foot.sin_offset;
+  double wished_x = ball_pos(0) + foot.dx * cos_robot - foot.dy * sin_robot;
+  double wished_y = ball_pos(1) + foot.dx * sin_robot + foot.dy * cos_robot;
+  return Eigen::Vector3d(wished_x, wished_y, kick_dir + foot.theta_offset);
 }
 
 Json::Value KickControler::Player::toJson() const
@@ -57,7 +146,7 @@ void KickControler::Player::fromJson(const Json::Value& v, const std::string& di
   name = rhoban_utils::read<std::string>(v, "name");
   navigation_approach.tryRead(v, "approach_model", dir_name);
   // Replace approach_policy if found
-  PolicyFactory().tryRead(v, "policy", dir_name, &approach_policy);
+  approach_policy.tryRead(v, dir_name);
   // Reading kick options
   kick_options.clear();
   rhoban_utils::checkMember(v, "kick_options");
@@ -111,7 +200,10 @@ KickControler::KickControler()
   , kick_dist_ratio(0.85)
   , intercept_dist(0.75)
   , use_opposite_placing(false)
+  , starting_states_bank_size(0)
+  , starting_states_bank_seed(0)
 {
+  updateBallExitKernel();
 }
 
 Problem::Result KickControler::getSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
@@ -193,35 +285,31 @@ Problem::Result KickControler::getSuccessor(const Eigen::VectorXd& state, const
   // T4.0: Find the kick which need to be applied
   //       (or return if none can be applied)
   //       if no players are available, then only one kick should be available
-  if (kick_option.kick_model_names.size() == 0)
-  {
-    throw std::logic_error("no kick_model_names for current kick_option");
-  }
-  std::string kick_name;
+  const KickOption::CompiledKick* kick = nullptr;
   if (kicker_id == -1)
   {
-    if (kick_option.kick_model_names.size() > 1)
+    if (!kick_option.single_kick)
     {
       // Another choice could be to choose name randomly
       throw std::logic_error("With no players, kick_model only support a single kick_model_name");
     }
-    kick_name = kick_option.kick_model_names[0];
+    kick = &(kick_option.compiled_kicks[0]);
   }
   else
   {
     const Eigen::Vector3d& kicker_state = getPlayerState(result.successor, kicker_id);
     // Actualise kick_dir to use the real position of the ball now, in order to match evaluation in runSteps
     kick_dir = kdm.computeKickDirection(ball_real, decision_actions);
-    for (const std::string& name : kick_option.kick_model_names)
+    // State of the ball in the kicker referential does not depend on the kick zone
+    Eigen::Vector3d kick_state =
+        kick_option.compiled_kicks[0].zone->convertWorldStateToKickState(ball_real, kicker_state, kick_dir);
+    // First kick allowing to shoot from the current state
+    int kick_idx = kick_option.compiled_zones.getKickableZone(kick_state);
+    if (kick_idx >= 0)
     {
-      const KickZone& kick_zone = kmc.getKickModel(name).getKickZone();
-      if (kick_zone.isKickable(ball_real, kicker_state, kick_dir))
-      {
-        kick_name = name;
-        break;
-      }
+      kick = &(kick_option.compiled_kicks[kick_idx]);
     }
-    if (kick_name == "")
+    if (kick == nullptr)
     {
       std::ostringstream oss;
       oss << "No kick terminal in KickControler::getSuccessor()" << std::endl;
@@ -231,7 +319,7 @@ Problem::Result KickControler::getSuccessor(const Eigen::VectorXd& state, const
       throw std::logic_error(oss.str());
     }
   }
-  const KickModel& kick_model = kmc.getKickModel(kick_name);
+  const KickModel& kick_model = *(kick->model);
   // T4.1: Apply kick with noise
   double ball_final_x, ball_final_y;
   double kick_reward;
@@ -274,26 +362,50 @@ Problem::Result KickControler::getSuccessor(const Eigen::VectorXd& state, const
 }
 
 Eigen::VectorXd KickControler::getStartingState(std::default_random_engine* engine) const
+{
+  if (starting_states_bank.size() > 0)
+  {
+    // The index is drawn from the engine rather than from a shared counter, the
+    // states received only depend on the seed of the engine and not on the
+    // scheduling of the threads sharing the problem
+    std::uniform_int_distribution<size_t> index_distrib(0, starting_states_bank.size() - 1);
+    return starting_states_bank[index_distrib(*engine)];
+  }
+  return sampleStartingState(engine);
+}
+
+const std::vector<Eigen::VectorXd>& KickControler::getStartingStatesBank() const
+{
+  return starting_states_bank;
+}
+
+Eigen::VectorXd KickControler::sampleStartingState(std::default_random_engine* engine) const
 {
   Eigen::VectorXd state(2 + 3 * players.size());
   // Getting ball position
-  Eigen::VectorXd ball_pos = rhoban_random::getUniformSample(getFieldLimits(), engine);
+  Eigen::Vector2d ball_pos = rhoban_random::getUniformSample(getFieldLimits(), engine);
   state.segment(0, 2) = ball_pos;
-  // Sampling player position
+  // Sampling player position at a distance below max_initial_dist from the ball
+  std::uniform_real_distribution<double> dir_distrib(-M_PI, M_PI);
   for (size_t player = 0; player < players.size(); player++)
   {
     int start_idx = 2 + player * 3;
-    // Ensuring that distance from players to ball is below max_initial_dist
-    bool valid = false;
-    while (!valid)
-    {
-      state.segment(start_idx, 3) = rhoban_random::getUniformSample(getPlayerLimits(), engine);
-      valid = (state.segment(start_idx, 2) - ball_pos).norm() < max_initial_dist;
-    }
+    state.segment(start_idx, 2) = sampleDiskInBox(ball_pos, max_initial_dist, getFieldLimits(), engine);
+    state(start_idx + 2) = dir_distrib(*engine);
   }
   return state;
 }
 
+void KickControler::generateStartingStatesBank()
+{
+  starting_states_bank.clear();
+  std::default_random_engine engine(starting_states_bank_seed);
+  for (int idx = 0; idx < starting_states_bank_size; idx++)
+  {
+    starting_states_bank.push_back(sampleStartingState(&engine));
+  }
+}
+
 const csa_mdp::Policy& KickControler::getPolicy(int player_id, int kicker_id, int kick_option_id) const
 {
   const Player& player = *(players[player_id]);
@@ -301,12 +413,12 @@ const csa_mdp::Policy& KickControler::getPolicy(int player_id, int kicker_id, in
   if (player_id == kicker_id)
   {
     const KickOption& ko = *(player.kick_options[kick_option_id]);
-    if (ko.approach_policy)
-      return *(ko.approach_policy);
+    if (ko.approach_policy.get())
+      return *(ko.approach_policy.get());
   }
   // Otherwise, use custom player approach policy if provided
-  if (player.approach_policy)
-    return *(player.approach_policy);
+  if (player.approach_policy.get())
+    return *(player.approach_policy.get());
   // If none policy has been found, throw an explicit error
   std::ostringstream oss;
   oss << "KickControler::getPolicy: no policy found for player " << player_id << "(kicker_id: " << kicker_id
@@ -325,7 +437,7 @@ void KickControler::runSteps(int max_steps, const Eigen::VectorXd& action, int k
   std::uniform_real_distribution<double> failure_distrib(0, 1);
   const KickOption& kick_option = *(players[kicker_id]->kick_options[kick_option_id]);
   // Step 1: gather all players states according to their ball_approach
-  std::vector<Problem::Result> approach_status;
+  std::vector<BallApproach::FixedState> approach_states;
   std::vector<Eigen::Vector3d> targets;
   for (int player_id = 0; player_id < (int)players.size(); player_id++)
   {
@@ -333,15 +445,14 @@ void KickControler::runSteps(int max_steps, const Eigen::VectorXd& action, int k
     Eigen::Vector3d player_state, target;
     player_state = getPlayerState(status->successor, player_id);
     target = getTarget(status->successor, action, player_id, kicker_id, kick_option_id);
-    // Build player_status
-    Problem::Result player_status;
-    player_status.successor = toBallApproachState(player_state, target);
-    player_status.reward = 0;
-    player_status.terminal = false;
     // Storing necessary values
-    approach_status.push_back(player_status);
+    approach_states.push_back(toBallApproachState(player_state, target));
     targets.push_back(target);
   }
+  // Buffer used to provide the approach state to the policies
+  Eigen::VectorXd policy_input(6);
+  double approach_reward;
+  bool approach_terminal;
   // Step 2: Simulate until one of these conditions is filled
   // - Max steps is reached
   // - kicker is enabled and has reached target
@@ -359,31 +470,31 @@ void KickControler::runSteps(int max_steps, const Eigen::VectorXd& action, int k
         continue;
       // Import policy
       const csa_mdp::Policy& policy = getPolicy(player_id, kicker_id, kick_option_id);
-      // Get action
-      Eigen::VectorXd pa_action = policy.getAction(approach_status[player_id].successor, engine);
-      // TODO: avoid code duplication between kickers and non kickers
-      if (player_id == kicker_id)
-      {
-        if (!kicker_enabled)
-          continue;  // Skip kicker if disabled
-        const BallApproach& model = kick_option.approach_model;
-        // Simulate approach action
-        approach_status[player_id] = model.getSuccessor(approach_status[player_id].successor, pa_action, engine);
-        // Update 'reached target'
-        reached_target[player_id] = model.isKickable(approach_status[player_id].successor);
-      }
-      else
+      // Get action, even for a disabled kicker: policies might use the engine
+      // and skipping the call would change the random sequence of the episode
+      policy_input = approach_states[player_id];
+      Eigen::VectorXd pa_action = policy.getAction(policy_input, engine);
+      // Skip kicker if disabled
+      if (player_id == kicker_id && !kicker_enabled)
+        continue;
+      if (pa_action.rows() != 4)
       {
-        // Retrieve model
-        const BallApproach& model = players[player_id]->navigation_approach;
-        // Simulate approach action
-        approach_status[player_id] = model.getSuccessor(approach_status[player_id].successor, pa_action, engine);
-        // Update 'reached target'
-        reached_target[player_id] = model.isKickable(approach_status[player_id].successor);
+        std::ostringstream oss;
+        oss << "KickControler::runSteps: invalid dimension for approach action, expecting 4 and received "
+            << pa_action.rows();
+        throw std::runtime_error(oss.str());
       }
+      // Retrieve model
+      const BallApproach& model =
+          player_id == kicker_id ? kick_option.approach_model : players[player_id]->navigation_approach;
+      // Simulate approach action
+      BallApproach::FixedState& approach_state = approach_states[player_id];
+      model.step(approach_state, pa_action.segment<3>(1), engine, &approach_state, &approach_reward,
+                 &approach_terminal);
+      // Update 'reached target'
+      reached_target[player_id] = model.isKickable(approach_state);
       // Update global status
-      status->successor =
-          toKickControlerState(approach_status[player_id].successor, status->successor, player_id, targets[player_id]);
+      toKickControlerState(approach_state, player_id, targets[player_id], &(status->successor));
       // Checking if player is inside the goal area
       Eigen::Vector3d player_state = getPlayerState(status->successor, player_id);
       if (isGoalArea(player_state(0), player_state(1)))
@@ -404,7 +515,7 @@ void KickControler::runSteps(int max_steps, const Eigen::VectorXd& action, int k
     oss << "KickControler::performApproach: kickable state not reached after " << max_steps << std::endl
         << "kicker: " << kicker_id << std::endl
         << "kick_option: " << kick_option_id << std::endl
-        << "state: " << approach_status[kicker_id].successor.transpose() << std::endl;
+        << "state: " << approach_states[kicker_id].transpose() << std::endl;
     throw std::runtime_error(oss.str());
   }
   // Use failure reward if approach failed
@@ -433,14 +544,15 @@ void KickControler::approximateKickerApproach(const Eigen::Vector2d& ball_real_p
   // Importing variables
   Eigen::Vector3d kicker_state = getPlayerState(status->successor, kicker_id);
   const KickOption& kick_option = *(players[kicker_id]->kick_options[kick_option_id]);
-  if (kick_option.kick_model_names.size() != 1)
+  if (!kick_option.single_kick)
   {
     throw std::logic_error("Cannot approximateKickerApproach for problems with multiple kicks available");
   }
-  std::string kick_name = kick_option.kick_model_names[0];
-  const KickModel& kick_model = kmc.getKickModel(kick_name);
-  const KickZone& kick_zone = kick_model.getKickZone();
+  const KickOption::CompiledKick& kick = kick_option.compiled_kicks[0];
+  const KickModel& kick_model = *(kick.model);
   double kick_wished_dir = getKickDir(status->successor, action);
+  double cos_dir = cos(kick_wished_dir);
+  double sin_dir = sin(kick_wished_dir);
   // Compute target and time for kicker (best between left and right)
   double min_time = std::numeric_limits<double>::max();
   Eigen::Vector3d kicker_target;
@@ -455,7 +567,7 @@ void KickControler::approximateKickerApproach(const Eigen::Vector2d& ball_real_p
     // Getting Use kicking left position as next position for the robot:
     // approach_steps_approximator does not provide enough information to choose
     // the side
-    kicker_target = kick_zone.getWishedPosInField(ball_real_pos, kick_wished_dir, false);
+    kicker_target = kick.getWishedPosInField(ball_real_pos, kick_wished_dir, cos_dir, sin_dir, false);
   }
   // In case there is no approach_steps_approximator, use cartesian_speed and
   // angular_speed to determine how much time will be spent
@@ -463,7 +575,8 @@ void KickControler::approximateKickerApproach(const Eigen::Vector2d& ball_real_p
   {
     for (bool use_right_foot : { true, false })
     {
-      Eigen::Vector3d target = kick_zone.getWishedPosInField(ball_real_pos, kick_wished_dir, use_right_foot);
+      Eigen::Vector3d target =
+          kick.getWishedPosInField(ball_real_pos, kick_wished_dir, cos_dir, sin_dir, use_right_foot);
       double time = getApproximatedTime(kicker_state, target);
       if (time < min_time)
       {
@@ -587,12 +700,11 @@ Eigen::Vector3d KickControler::getTarget(const Eigen::VectorXd& state, const Eig
   // Importing basic kick properties
   const KickOption& ko = *(players[kicker_id]->kick_options[kick_option]);
   const KickDecisionModel& kdm = *(ko.kick_decision_model);
-  if (ko.kick_model_names.size() != 1)
+  if (!ko.single_kick)
   {
     throw std::logic_error("KickControler::getTarget: only single kick types are supported");
   }
-  std::string kick_name = (ko.kick_model_names[0]);
-  const KickModel& km = kmc.getKickModel(kick_name);
+  const KickModel& km = *(ko.compiled_kicks[0].model);
   int kick_dims = kdm.getActionsLimits().rows();
   // Renaming variables to improve readability
   Eigen::Vector2d ball = state.segment(0, 2);
@@ -618,8 +730,8 @@ Eigen::Vector3d KickControler::getTarget(const Eigen::VectorXd& state, const Eig
   return target;
 }
 
-Eigen::VectorXd KickControler::toBallApproachState(const Eigen::Vector3d& player_state,
-                                                   const Eigen::Vector3d& target) const
+BallApproach::FixedState KickControler::toBallApproachState(const Eigen::Vector3d& player_state,
+                                                            const Eigen::Vector3d& target) const
 {
   // Computing basic properties
   double ball_x_field = target(0);
@@ -636,16 +748,15 @@ Eigen::VectorXd KickControler::toBallApproachState(const Eigen::Vector3d& player
   double ball_dir_robot = normalizeAngle(ball_dir_field - player_theta);
   double kick_theta_robot = normalizeAngle(kick_theta_field - player_theta);
   // Building the input for the approach problem (initial speed is 0)
-  Eigen::VectorXd pa_state = Eigen::VectorXd::Zero(6);
+  BallApproach::FixedState pa_state = BallApproach::FixedState::Zero();
   pa_state(0) = ball_dist;
   pa_state(1) = ball_dir_robot;
   pa_state(2) = kick_theta_robot;
   return pa_state;
 }
 
-Eigen::VectorXd KickControler::toKickControlerState(const Eigen::VectorXd& pa_state,
-                                                    const Eigen::VectorXd& prev_kc_state, int player_id,
-                                                    const Eigen::Vector3d& target) const
+void KickControler::toKickControlerState(const BallApproach::FixedState& pa_state, int player_id,
+                                         const Eigen::Vector3d& target, Eigen::VectorXd* kc_state) const
 {
   // Getting basic data
   double ball_dist = pa_state(0);
@@ -658,11 +769,9 @@ Eigen::VectorXd KickControler::toKickControlerState(const Eigen::VectorXd& pa_st
   double robot_theta_field = normalizeAngle(kick_theta_field - target_angle);
   double robot2ball_theta_field = normalizeAngle(ball_dir_robot + robot_theta_field);
   // Filling state
-  Eigen::VectorXd kc_state = prev_kc_state;
-  kc_state(2 + 3 * player_id) = ball_x - ball_dist * cos(robot2ball_theta_field);
-  kc_state(3 + 3 * player_id) = ball_y - ball_dist * sin(robot2ball_theta_field);
-  kc_state(4 + 3 * player_id) = robot_theta_field;
-  return kc_state;
+  (*kc_state)(2 + 3 * player_id) = ball_x - ball_dist * cos(robot2ball_theta_field);
+  (*kc_state)(3 + 3 * player_id) = ball_y - ball_dist * sin(robot2ball_theta_field);
+  (*kc_state)(4 + 3 * player_id) = robot_theta_field;
 }
 
 Json::Value KickControler::toJson() const
@@ -674,6 +783,8 @@ void KickControler::fromJson(const Json::Value& v, const std::string& dir_name)
 {
   rhoban_utils::tryRead(v, "simulate_approaches", &simulate_approaches);
   rhoban_utils::tryRead(v, "max_initial_dist", &max_initial_dist);
+  rhoban_utils::tryRead(v, "starting_states_bank_size", &starting_states_bank_size);
+  rhoban_utils::tryRead(v, "starting_states_bank_seed", &starting_states_bank_seed);
   rhoban_utils::tryRead(v, "cartesian_speed", &cartesian_speed);
   rhoban_utils::tryRead(v, "angular_speed", &angular_speed);
   rhoban_utils::tryRead(v, "step_initial_stddev", &step_initial_stddev);
@@ -698,7 +809,11 @@ void KickControler::fromJson(const Json::Value& v, const std::string& dir_name)
 
   /// Reading optional path
   std::string kmc_path = rhoban_utils::read<std::string>(v, "kmc_path");
-  kmc.loadFile(kmc_path);
+  kmc = ConfigCache<const KickModelCollection>::getFile(kmc_path, [&kmc_path]() {
+    std::unique_ptr<KickModelCollection> loaded(new KickModelCollection());
+    loaded->loadFile(kmc_path);
+    return std::unique_ptr<const KickModelCollection>(std::move(loaded));
+  });
 
   // TODO: improve format, currently very verbose and redundant
   checkMember(v, "players");
@@ -714,7 +829,7 @@ void KickControler::fromJson(const Json::Value& v, const std::string& dir_name)
     p->fromJson(players_json[idx], dir_name);
     for (size_t kick_id = 0; kick_id < p->kick_options.size(); kick_id++)
     {
-      p->kick_options[kick_id]->syncKickZones(kmc);
+      p->kick_options[kick_id]->compile(*kmc);
     }
     players.push_back(std::move(p));
   }
@@ -728,11 +843,12 @@ void KickControler::fromJson(const Json::Value& v, const std::string& dir_name)
     {
       throw rhoban_utils::JsonParsingError("KickControler::fromJson: kick_options should be an array");
     }
-    for (Json::ArrayIndex idx = 0; idx < players_json.size(); idx++)
+    for (Json::ArrayIndex idx = 0; idx < kick_options_json.size(); idx++)
     {
       std::unique_ptr<KickOption> ko(new KickOption());
       // no default values for approach_model
       ko->fromJson(kick_options_json[idx], dir_name);
+      ko->compile(*kmc);
       kick_options.push_back(std::move(ko));
     }
   }
@@ -743,7 +859,11 @@ void KickControler::fromJson(const Json::Value& v, const std::string& dir_name)
   rhoban_utils::tryRead(v, "approach_approximator_path", &approach_approximator_path);
   if (approach_approximator_path != "")
   {
-    rhoban_fa::FunctionApproximatorFactory().loadFromFile(approach_approximator_path, approach_steps_approximator);
+    approach_steps_approximator.setFile(approach_approximator_path);
+  }
+  else
+  {
+    approach_steps_approximator.clear();
   }
 
   // Consistency check
@@ -751,10 +871,16 @@ void KickControler::fromJson(const Json::Value& v, const std::string& dir_name)
   {
     throw std::runtime_error("KickControler::fromJson: no players is incompatible with enabling simulated approaches");
   }
+  if (max_initial_dist <= 0)
+  {
+    throw rhoban_utils::JsonParsingError("KickControler::fromJson: max_initial_dist should be strictly positive");
+  }
 
   updateStateLimits();
   updateApproachesLimits();
   updateActionsLimits();
+  updateBallExitKernel();
+  generateStartingStatesBank();
 }
 
 std::string KickControler::getClassName() const
@@ -805,6 +931,46 @@ const std::vector<std::string>& KickControler::getAllowedKicks(int kicker_id, in
   return players[kicker_id]->kick_options[kick_option]->kick_model_names;
 }
 
+std::vector<Eigen::VectorXd> KickControler::getDiscretizedActions(int nb_values_per_dim) const
+{
+  std::vector<Eigen::VectorXd> actions;
+  const std::vector<Eigen::MatrixXd>& actions_limits = getActionsLimits();
+  for (int action_id = 0; action_id < (int)actions_limits.size(); action_id++)
+  {
+    const Eigen::MatrixXd& limits = actions_limits[action_id];
+    int dims = limits.rows();
+    // Number of points of the grid: nb_values_per_dim^dims
+    int nb_points = 1;
+    for (int dim = 0; dim < dims; dim++)
+    {
+      nb_points *= nb_values_per_dim;
+    }
+    for (int point = 0; point < nb_points; point++)
+    {
+      Eigen::VectorXd action(1 + dims);
+      action(0) = action_id;
+      int remainder = point;
+      for (int dim = 0; dim < dims; dim++)
+      {
+        int value_idx = remainder % nb_values_per_dim;
+        remainder /= nb_values_per_dim;
+        double min = limits(dim, 0);
+        double max = limits(dim, 1);
+        if (nb_values_per_dim == 1)
+        {
+          action(1 + dim) = (min + max) / 2;
+        }
+        else
+        {
+          action(1 + dim) = min + value_idx * (max - min) / (nb_values_per_dim - 1);
+        }
+      }
+      actions.push_back(action);
+    }
+  }
+  return actions;
+}
+
 double KickControler::getKickDir(const Eigen::VectorXd& state, const Eigen::VectorXd& action) const
 {
   int action_id = action(0);
@@ -821,6 +987,37 @@ double KickControler::getKickDir(const Eigen::VectorXd& state, const Eigen::Vect
   return kdm.computeKickDirection(ball_seen, kick_action);
 }
 
+bool KickControler::hasSymmetry() const
+{
+  bool centered_goalie = !use_goalie || goalie_y == 0;
+  return centered_goalie && kmc && kmc->isSymmetric() && !simulate_approaches && !approach_steps_approximator;
+}
+
+Eigen::VectorXd KickControler::mirrorState(const Eigen::VectorXd& state) const
+{
+  Eigen::VectorXd mirrored = state;
+  mirrored(1) = -state(1);
+  for (size_t player_id = 0; player_id < players.size(); player_id++)
+  {
+    int start_idx = 2 + 3 * player_id;
+    mirrored(start_idx + 1) = -state(start_idx + 1);
+    mirrored(start_idx + 2) = normalizeAngle(-state(start_idx + 2));
+  }
+  return mirrored;
+}
+
+Eigen::VectorXd KickControler::mirrorAction(const Eigen::VectorXd& action) const
+{
+  int kicker_id(0), kick_option(0);
+  analyzeActionId(action(0), &kicker_id, &kick_option);
+  const KickOption& ko =
+      kicker_id < 0 ? *(kick_options[kick_option]) : *(players[kicker_id]->kick_options[kick_option]);
+  int kick_dims = ko.kick_decision_model->getActionsLimits().rows();
+  Eigen::VectorXd mirrored = action;
+  mirrored.segment(1, kick_dims) = ko.kick_decision_model->mirrorActions(action.segment(1, kick_dims));
+  return mirrored;
+}
+
 Eigen::Matrix<double, 2, 2> KickControler::getFieldLimits() const
 {
   Eigen::Matrix<double, 2, 2> field_limits;
@@ -880,10 +1077,7 @@ void KickControler::updateActionsLimits()
     // Update actions limits for navigation
     std::vector<Eigen::MatrixXd> nav_action_limits;
     nav_action_limits = players[p_id]->navigation_approach.getActionsLimits();
-    if (players[p_id]->approach_policy)
-    {
-      players[p_id]->approach_policy->setActionLimits(nav_action_limits);
-    }
+    players[p_id]->approach_policy.build(nav_action_limits);
     for (size_t ko_id = 0; ko_id < players[p_id]->kick_options.size(); ko_id++)
     {
       // kick_model
@@ -891,10 +1085,7 @@ void KickControler::updateActionsLimits()
       // Updating the approach action limits for approach policies
       std::vector<Eigen::MatrixXd> app_action_limits;
       app_action_limits = players[p_id]->kick_options[ko_id]->approach_model.getActionsLimits();
-      if (players[p_id]->kick_options[ko_id]->approach_policy)
-      {
-        players[p_id]->kick_options[ko_id]->approach_policy->setActionLimits(app_action_limits);
-      }
+      players[p_id]->kick_options[ko_id]->approach_policy.build(app_action_limits);
       // Getting current kick model parameters limits
       Eigen::MatrixXd kick_limits = kdm.getActionsLimits();
       int kick_dims = kick_limits.rows();
@@ -938,157 +1129,49 @@ void KickControler::initialBallNoise(double ball_x, double ball_y, double* ball_
 void KickControler::moveBall(double src_x, double src_y, double* dst_x, double* dst_y, bool* terminal,
                              double* reward) const
 {
-  if (use_goalie && isCollidingGoalie(src_x, src_y, dst_x, dst_y))
-  {
-    *reward = *reward + goal_collision_reward;
-    *terminal = true;
-    return;
-  }
-  else if (isGoal(src_x, src_y, dst_x, dst_y))
-  {
-    *reward = *reward + goal_reward;
-    *terminal = true;
-    return;
-  }
-  else if (isOut(src_x, src_y, dst_x, dst_y))
-  {
-    *reward = *reward + failure_reward;
-    *terminal = true;
-    return;
-  }
-  *terminal = false;
+  BallExitKernel::Event event = ball_exit_kernel.process(src_x, src_y, dst_x, dst_y);
+  *terminal = event != BallExitKernel::Event::None;
+  *reward = *reward + getEventReward(event);
 }
 
-bool KickControler::isCollidingGoalie(double src_x, double src_y, double* dst_x, double* dst_y) const
+void KickControler::moveBalls(int n, const double* src_x, const double* src_y, double* dst_x, double* dst_y,
+                              bool* terminal, double* rewards) const
 {
-  // 0: precomputing values (using ball radius)
-  double min_goalie_x = goalie_x - goalie_thickness / 2 - ball_radius;
-  double max_goalie_x = goalie_x + goalie_thickness / 2 + ball_radius;
-  double min_goalie_y = goalie_y - goalie_width / 2 - ball_radius;
-  double max_goalie_y = goalie_y + goalie_width / 2 + ball_radius;
-  double dx = *dst_x - src_x;
-  double dy = *dst_y - src_y;
-  // 1: If both points are above or below specific values, collision is not possible
-  bool below_x = src_x < min_goalie_x && *dst_x < min_goalie_x;
-  bool above_x = src_x > max_goalie_x && *dst_x > max_goalie_x;
-  bool below_y = src_y < min_goalie_y && *dst_y < min_goalie_y;
-  bool above_y = src_y > max_goalie_y && *dst_y > max_goalie_y;
-  if (below_x || above_x || below_y || above_y)
-    return false;
-  // 2: Special case, ball moving laterally: spot first collision (mandatory)
-  if (dx == 0)
-  {
-    double dist_to_min = std::fabs(src_y - min_goalie_y);
-    double dist_to_max = std::fabs(src_y - max_goalie_y);
-    if (dist_to_min < dist_to_max)
-    {
-      *dst_y = min_goalie_y;
-    }
-    else
-    {
-      *dst_y = max_goalie_y;
-    }
-    return true;
-  }
-  // 3: Computing trajectories under the form a*x + b
-  double a = dy / dx;
-  double b = src_y - a * src_x;
-  // 4: Detecting potential collision:
-  std::vector<double> collisions_x, collisions_y;
-  double tmp_x, tmp_y;
-  // 4.1: collision with min_goalie_x
-  tmp_x = min_goalie_x;
-  tmp_y = a * tmp_x + b;
-  if (tmp_y > min_goalie_y && tmp_y < max_goalie_y)
-  {
-    collisions_x.push_back(tmp_x);
-    collisions_y.push_back(tmp_y);
-  }
-  // 4.2: collision with max_goalie_x
-  tmp_x = max_goalie_x;
-  tmp_y = a * tmp_x + b;
-  if (tmp_y > min_goalie_y && tmp_y < max_goalie_y)
-  {
-    collisions_x.push_back(tmp_x);
-    collisions_y.push_back(tmp_y);
-  }
-  // 4.3: collision with min_goalie_y
-  if (a != 0)
+  // Events are processed by chunks to avoid allocation
+  const int chunk_size = 64;
+  BallExitKernel::Event events[chunk_size];
+  for (int start = 0; start < n; start += chunk_size)
   {
-    tmp_y = min_goalie_y;
-    tmp_x = (tmp_y - b) / a;
-    if (tmp_x > min_goalie_x && tmp_x < max_goalie_x)
+    int size = std::min(chunk_size, n - start);
+    ball_exit_kernel.process(size, src_x + start, src_y + start, dst_x + start, dst_y + start, events);
+    for (int i = 0; i < size; i++)
     {
-      collisions_x.push_back(tmp_x);
-      collisions_y.push_back(tmp_y);
+      terminal[start + i] = events[i] != BallExitKernel::Event::None;
+      rewards[start + i] = getEventReward(events[i]);
     }
   }
-  // 4.4: collision with max_goalie_y
-  if (a != 0)
-  {
-    tmp_y = max_goalie_y;
-    tmp_x = (tmp_y - b) / a;
-    if (tmp_x > min_goalie_x && tmp_x < max_goalie_x)
-    {
-      collisions_x.push_back(tmp_x);
-      collisions_y.push_back(tmp_y);
-    }
-  }
-  // 5: If no collision has been found return false
-  if (collisions_x.size() == 0)
-    return false;
-  // 6: Choose the closest collision to 'src'
-  double best_dist2 = std::numeric_limits<double>::max();
-  for (int i = 0; i < (int)collisions_x.size(); i++)
-  {
-    double dx = collisions_x[i] - src_x;
-    double dy = collisions_y[i] - src_y;
-    double dist2 = dx * dx + dy * dy;
-    if (dist2 < best_dist2)
-    {
-      best_dist2 = dist2;
-      *dst_x = collisions_x[i];
-      *dst_y = collisions_y[i];
-    }
-  }
-  return true;
 }
 
-bool KickControler::isGoal(double src_x, double src_y, double* dst_x, double* dst_y) const
+double KickControler::getEventReward(BallExitKernel::Event event) const
 {
-  double dx = *dst_x - src_x;
-  double limit_x = field_length / 2 + ball_radius;
-  // Impossible to score a goal by kicking backward or if ball did not entirely cross the line
-  if (dx <= 0 || *dst_x < limit_x)
-    return false;
-  // Finding equation a*x +b;
-  double dy = *dst_y - src_y;
-  double a = dy / dx;
-  double b = src_y - a * src_x;
-  // Finding intersection with goal line
-  double intercept_y = a * field_length / 2 + b;
-  bool intersect = std::fabs(intercept_y) < goal_width / 2;
-  // If no intersection:
-  if (!intersect)
-    return false;
-  // Set x to a given limit without changing trajectory
-  *dst_x = limit_x;
-  *dst_y = a * limit_x + b;
-  return true;
+  switch (event)
+  {
+    case BallExitKernel::Event::GoalieCollision:
+      return goal_collision_reward;
+    case BallExitKernel::Event::Goal:
+      return goal_reward;
+    case BallExitKernel::Event::Out:
+      return failure_reward;
+    case BallExitKernel::Event::None:
+      break;
+  }
+  return 0;
 }
 
-bool KickControler::isOut(double src_x, double src_y, double* dst_x, double* dst_y) const
+void KickControler::updateBallExitKernel()
 {
-  (void)src_x;
-  (void)src_y;
-  // Computing limits
-  double min_x = -field_length / 2 - ball_radius;
-  double max_x = field_length / 2 + ball_radius;
-  double min_y = -field_width / 2 - ball_radius;
-  double max_y = field_width / 2 + ball_radius;
-  // Getting values
-  return (*dst_x < min_x || *dst_y < min_y || *dst_x > max_x || *dst_y > max_y);
-  // TODO: modifies values of dst if ball is out
+  ball_exit_kernel.setField(field_length, field_width, goal_width, ball_radius);
+  ball_exit_kernel.setGoalie(use_goalie, goalie_x, goalie_y, goalie_thickness, goalie_width);
 }
 
 bool KickControler::isGoalArea(double player_x, double player_y) const
@@ -1,6 +1,11 @@
 #include "problems/simulated_cart_pole.h"
 
+#include "utils/sin_cos.h"
+#include "utils/ziggurat_normal.h"
+
+#include <cmath>
 #include <iostream>
+#include <sstream>
 
 namespace csa_mdp
 {
@@ -13,9 +18,7 @@ SimulatedCartPole::SimulatedCartPole()
   , cart_mass(0.5)
   , pendulum_mass(0.5)
   , friction(0.1)
-  , gravity(9.82)
-  ,  // although this value seems weird, it's the default in pilco
-  integration_step(0.001)
+  , gravity(9.82)  // although this value seems weird, it's the default in pilco
   , simulation_step(0.1)
   , torque_stddev(0.1)
   , reward_type(RewardType::Pilco)
@@ -139,53 +142,136 @@ Eigen::VectorXd SimulatedCartPole::getFullSuccessor(const Eigen::VectorXd& state
 {
   // Apply noise on action
   std::normal_distribution<double> noise_distribution(0, torque_stddev);
-  double noisy_cmd = action(0) + noise_distribution(*engine);
+  double noisy_cmd = action(1) + noise_distribution(*engine);
   // Integrating action with the system dynamics
-  double elapsed = 0;
-  Eigen::VectorXd current_state = state;
-  while (elapsed < simulation_step)
+  auto derivative = [this, noisy_cmd](const Eigen::Vector4d& x) { return getDerivative(x, noisy_cmd); };
+  Eigen::Vector4d dynamic_state = integrator.integrate<4>(state.segment(0, 4), simulation_step, derivative);
+  Eigen::VectorXd next_state(6);
+  next_state.segment(0, 4) = dynamic_state;
+  // Normalize theta
+  next_state(2) = std::remainder(next_state(2), 2 * M_PI);
+  // Before publishing, update cos(theta) and sin(theta)
+  next_state(4) = cos(next_state(2));
+  next_state(5) = sin(next_state(2));
+  return next_state;
+}
+
+Eigen::Vector4d SimulatedCartPole::getDerivative(const Eigen::Vector4d& state, double cmd) const
+{
+  // Defining short names for variables
+  double vel = state(1);
+  double theta = state(2);
+  double omega = state(3);
+  double omega2 = omega * omega;
+  double sin_t = -sin(theta);  // sin(theta + pi): in pilco, 0 has not the same meaning
+  double cos_t = -cos(theta);  // cos(theta + pi): in pilco, 0 has not the same meaning
+  double cos_t2 = cos_t * cos_t;
+  double M = cart_mass;
+  double m = pendulum_mass;
+  double l = pole_length;
+  double u = cmd;
+  double f = friction;
+  double g = gravity;
+  Eigen::Vector4d grad;
+  grad(0) = vel;
+  grad(1) =
+      (2 * m * l * omega2 * sin_t + 3 * m * g * sin_t * cos_t + 4 * u - 4 * f * vel) / (4 * (M + m) - 3 * m * cos_t2);
+  grad(2) = omega;
+  grad(3) = (-3 * m * l * omega2 * sin_t * cos_t - 6 * (M + m) * g * sin_t - 6 * (u - f * vel) * cos_t) /
+            (4 * l * (m + M) - 3 * m * l * cos_t2);
+  return grad;
+}
+
+SimulatedCartPole::DynamicArrays SimulatedCartPole::getDerivatives(const DynamicArrays& states,
+                                                                   const RowArray& cmds) const
+{
+  int n = states.cols();
+  // sin(theta + pi) and cos(theta + pi): in pilco, 0 has not the same meaning
+  RowArray sin_t(n), cos_t(n);
+  sinCos(n, states.row(2).data(), sin_t.data(), cos_t.data());
+  sin_t = -sin_t;
+  cos_t = -cos_t;
+  double M = cart_mass;
+  double m = pendulum_mass;
+  double l = pole_length;
+  double f = friction;
+  double g = gravity;
+  // Both denominators of getDerivative are proportional
+  RowArray inv_den = (4 * (M + m) - 3 * m * cos_t.square()).inverse();
+  RowArray force = cmds - f * states.row(1);
+  DynamicArrays grad(4, n);
+  grad.row(0) = states.row(1);
+  grad.row(1) = (2 * m * l * states.row(3).square() * sin_t + 3 * m * g * sin_t * cos_t + 4 * force) * inv_den;
+  grad.row(2) = states.row(3);
+  grad.row(3) = (-3 * m * l * states.row(3).square() * sin_t * cos_t - 6 * (M + m) * g * sin_t - 6 * force * cos_t) *
+                inv_den / l;
+  return grad;
+}
+
+void SimulatedCartPole::getSuccessors(const StateArrays& states, const Eigen::ArrayXd& cmds,
+                                      std::default_random_engine* engine, StateArrays* successors,
+                                      Eigen::ArrayXd* rewards, Eigen::Array<bool, -1, 1>* terminal) const
+{
+  int n = states.cols();
+  if (cmds.rows() != n)
+  {
+    std::ostringstream oss;
+    oss << "SimulatedCartPole::getSuccessors: invalid dimensions: states " << states.rows() << "x" << states.cols()
+        << ", cmds " << cmds.rows();
+    throw std::logic_error(oss.str());
+  }
+  // Noise of all the environments is drawn in a single batch
+  RowArray noisy_cmds(n);
+  ZigguratNormal::fill(noisy_cmds.data(), n, engine);
+  noisy_cmds = cmds.transpose() + torque_stddev * noisy_cmds;
+  // Required for the rewards, before successors is written
+  Eigen::Array<bool, -1, 1> src_terminal = areTerminal(states);
+  auto derivative = [this, &noisy_cmds](const DynamicArrays& x) { return getDerivatives(x, noisy_cmds); };
+  DynamicArrays dynamic_states = integrator.integrateBatch<4>(states.topRows<4>(), simulation_step, derivative);
+  successors->resize(6, n);
+  successors->topRows<4>() = dynamic_states;
+  // Normalize theta, same as std::remainder except for ties
+  successors->row(2) = dynamic_states.row(2) - 2 * M_PI * (dynamic_states.row(2) / (2 * M_PI)).round();
+  sinCos(n, successors->row(2).data(), successors->row(5).data(), successors->row(4).data());
+  *terminal = areTerminal(*successors);
+  RowArray cart_pos = successors->row(0);
+  RowArray theta = successors->row(2);
+  RowArray step_rewards(n);
+  switch (reward_type)
   {
-    // Defining short names for variables
-    double dt = std::min(simulation_step - elapsed, integration_step);
-    double vel = current_state(1);
-    double theta = current_state(2);
-    double omega = current_state(3);
-    double omega2 = omega * omega;
-    double sin_t = sin(theta + M_PI);  // Adding pi because in pilco, 0 has not the same meaning
-    double cos_t = cos(theta + M_PI);  // Adding pi because in pilco, 0 has not the same meaning
-    double cos_t2 = cos_t * cos_t;
-    double M = cart_mass;
-    double m = pendulum_mass;
-    double l = pole_length;
-    double u = noisy_cmd;
-    double f = friction;
-    double g = gravity;
-    // Computing gradient
-    Eigen::VectorXd grad = Eigen::VectorXd::Zero(6);
-    grad(0) = vel;
-    grad(1) =
-        (2 * m * l * omega2 * sin_t + 3 * m * g * sin_t * cos_t + 4 * u - 4 * f * vel) / (4 * (M + m) - 3 * m * cos_t2);
-    grad(2) = omega;
-    grad(3) = (-3 * m * l * omega2 * sin_t * cos_t - 6 * (M + m) * g * sin_t - 6 * (u - f * vel) * cos_t) /
-              (4 * l * (m + M) - 3 * m * l * cos_t2);
-    // Updating state
-    Eigen::VectorXd next_state = current_state + grad * dt;
-    // Normalize theta
-    while (next_state(2) > M_PI)
+    case RewardType::Binary:
+      step_rewards = (theta.abs() < M_PI / 10).select(RowArray::Zero(n), RowArray::Constant(n, -1));
+      break;
+    case RewardType::Continuous:
+      step_rewards = -((cart_pos / max_pos).square().square() + (theta / M_PI).square());
+      break;
+    case RewardType::Pilco:
     {
-      next_state(2) -= 2 * M_PI;
+      RowArray dx = cart_pos - successors->row(5) * pole_length;
+      RowArray dy = successors->row(4) * pole_length - pole_length;
+      step_rewards = (-0.5 * (dx.square() + dy.square()) / (pole_length * pole_length)).exp() - 1;
+      break;
     }
-    while (next_state(2) < -M_PI)
+  }
+  *rewards = (*terminal || src_terminal).select(Eigen::ArrayXd::Constant(n, -100), step_rewards.transpose());
+}
+
+Eigen::Array<bool, -1, 1> SimulatedCartPole::areTerminal(const StateArrays& states) const
+{
+  const Eigen::MatrixXd& state_limits = getStateLimits();
+  int n = states.cols();
+  Eigen::Array<bool, -1, 1> terminal = Eigen::Array<bool, -1, 1>::Zero(n);
+  for (int dim = 0; dim < 6; dim++)
+  {
+    const double* values = states.row(dim).data();
+    double min = state_limits(dim, 0);
+    double max = state_limits(dim, 1);
+    for (int env = 0; env < n; env++)
     {
-      next_state(2) += 2 * M_PI;
+      terminal(env) |= values[env] > max || values[env] < min;
     }
-    elapsed += dt;
-    current_state = next_state;
   }
-  // Before publishing, update cos(theta) and sin(theta)
-  current_state(4) = cos(current_state(2));
-  current_state(5) = sin(current_state(2));
-  return current_state;
+  return terminal;
 }
 
 Eigen::VectorXd SimulatedCartPole::getAngularSuccessor(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
@@ -268,6 +354,11 @@ Eigen::VectorXd SimulatedCartPole::getStartingState(std::default_random_engine*
   return state;
 }
 
+const OdeIntegrator& SimulatedCartPole::getIntegrator() const
+{
+  return integrator;
+}
+
 Json::Value SimulatedCartPole::toJson() const
 {
   Json::Value v;
@@ -280,7 +371,7 @@ Json::Value SimulatedCartPole::toJson() const
   v["pendulum_mass"] = pendulum_mass;
   v["friction"] = friction;
   v["gravity"] = gravity;
-  v["integration_step"] = integration_step;
+  v["integrator"] = integrator.toJson();
   v["simulation_step"] = simulation_step;
   v["torque_stddev"] = torque_stddev;
   v["reward_type"] = to_string(reward_type);
@@ -290,7 +381,6 @@ Json::Value SimulatedCartPole::toJson() const
 
 void SimulatedCartPole::fromJson(const Json::Value& v, const std::string& dir_name)
 {
-  (void)dir_name;
   std::string reward_type_str;
   std::string learning_space_str;
   rhoban_utils::tryRead(v, "max_pos", &max_pos);
@@ -302,7 +392,15 @@ void SimulatedCartPole::fromJson(const Json::Value& v, const std::string& dir_na
   rhoban_utils::tryRead(v, "pendulum_mass", &pendulum_mass);
   rhoban_utils::tryRead(v, "friction", &friction);
   rhoban_utils::tryRead(v, "gravity", &gravity);
-  rhoban_utils::tryRead(v, "integration_step", &integration_step);
+  // 'integration_step' is a shortcut for explicit Euler with the given step
+  if (v.isMember("integration_step"))
+  {
+    integrator.setFixedStep(OdeIntegrator::Method::Euler, rhoban_utils::read<double>(v, "integration_step"));
+  }
+  if (v.isMember("integrator"))
+  {
+    integrator.fromJson(v["integrator"], dir_name);
+  }
   rhoban_utils::tryRead(v, "simulation_step", &simulation_step);
   rhoban_utils::tryRead(v, "torque_stddev", &torque_stddev);
   rhoban_utils::tryRead(v, "reward_type", &reward_type_str);
@@ -0,0 +1,93 @@
+#include "problems/simulated_cart_pole_pool.h"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace csa_mdp
+{
+SimulatedCartPolePool::SimulatedCartPolePool(std::shared_ptr<const SimulatedCartPole> model_, int nb_envs)
+  : model(model_)
+  , states(6, nb_envs)
+  , rewards(Eigen::ArrayXd::Zero(nb_envs))
+  , terminal(Eigen::Array<bool, -1, 1>::Zero(nb_envs))
+{
+  if (!model || nb_envs < 0)
+  {
+    std::ostringstream oss;
+    oss << "SimulatedCartPolePool: invalid configuration: " << nb_envs << " environments"
+        << (model ? "" : " and no model");
+    throw std::logic_error(oss.str());
+  }
+  // Starting state of SimulatedCartPole does not depend on the engine
+  std::default_random_engine engine;
+  reset(&engine);
+}
+
+int SimulatedCartPolePool::size() const
+{
+  return states.cols();
+}
+
+void SimulatedCartPolePool::reset(std::default_random_engine* engine)
+{
+  for (int env = 0; env < size(); env++)
+  {
+    states.col(env) = model->getStartingState(engine);
+  }
+  terminal.setZero();
+}
+
+int SimulatedCartPolePool::resetTerminated(std::default_random_engine* engine)
+{
+  int nb_reset = 0;
+  for (int env = 0; env < size(); env++)
+  {
+    if (terminal(env))
+    {
+      states.col(env) = model->getStartingState(engine);
+      terminal(env) = false;
+      nb_reset++;
+    }
+  }
+  return nb_reset;
+}
+
+Eigen::VectorXd SimulatedCartPolePool::getState(int env) const
+{
+  return states.col(env);
+}
+
+void SimulatedCartPolePool::setState(int env, const Eigen::VectorXd& full_state)
+{
+  if (env < 0 || env >= size() || full_state.rows() != 6)
+  {
+    std::ostringstream oss;
+    oss << "SimulatedCartPolePool::setState: invalid env " << env << " (size: " << size() << ") or state dimension "
+        << full_state.rows();
+    throw std::logic_error(oss.str());
+  }
+  states.col(env) = full_state;
+  terminal(env) = model->isTerminal(full_state);
+}
+
+const SimulatedCartPole::StateArrays& SimulatedCartPolePool::getStates() const
+{
+  return states;
+}
+
+void SimulatedCartPolePool::step(const Eigen::ArrayXd& cmds, std::default_random_engine* engine)
+{
+  model->getSuccessors(states, cmds, engine, &states, &rewards, &terminal);
+}
+
+const Eigen::ArrayXd& SimulatedCartPolePool::getRewards() const
+{
+  return rewards;
+}
+
+const Eigen::Array<bool, -1, 1>& SimulatedCartPolePool::getTerminal() const
+{
+  return terminal;
+}
+
+}  // namespace csa_mdp
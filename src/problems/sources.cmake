@@ -1,6 +1,7 @@
 set (SOURCES
 #TODO: Fix problems with the new multi action setup
   ball_approach.cpp
+  ball_exit_kernel.cpp
 #  cart_pole.cpp
   cart_pole_stabilization.cpp
   double_integrator.cpp
@@ -9,6 +10,7 @@ set (SOURCES
   extended_problem_factory.cpp
   kick_controler.cpp
   simulated_cart_pole.cpp
+  simulated_cart_pole_pool.cpp
   ssl_ball_approach.cpp
   ssl_dynamic_ball_approach.cpp
 )
\ No newline at end of file
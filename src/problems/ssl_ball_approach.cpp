@@ -33,6 +33,26 @@ static Eigen::Vector3d boundXYA(const Eigen::Vector3d& vec, double cart_bound, d
   return bounded_vec;
 }
 
+/// Derivative of boundNorm(vec, bound) with respect to vec
+static Eigen::Matrix2d boundNormJacobian(const Eigen::Vector2d& vec, double bound)
+{
+  double norm = vec.norm();
+  if (norm > bound)
+  {
+    return bound / norm * (Eigen::Matrix2d::Identity() - vec * vec.transpose() / (norm * norm));
+  }
+  return Eigen::Matrix2d::Identity();
+}
+
+/// Derivative of boundXYA(vec, cart_bound, a_bound) with respect to vec
+static Eigen::Matrix3d boundXYAJacobian(const Eigen::Vector3d& vec, double cart_bound, double a_bound)
+{
+  Eigen::Matrix3d jacobian = Eigen::Matrix3d::Zero();
+  jacobian.block<2, 2>(0, 0) = boundNormJacobian(vec.segment<2>(0), cart_bound);
+  jacobian(2, 2) = std::fabs(vec(2)) <= a_bound ? 1 : 0;
+  return jacobian;
+}
+
 /// Return the homogeneous transform T_r2_from_r1
 /// p    : the position of R2 center in r1 referential
 /// alpha: the rotation from R1 to R2 (R2.x = R1.x * cos(alpha) + R1.y * sin(theta))
@@ -205,6 +225,94 @@ Problem::Result SSLBallApproach::getSuccessor(const Eigen::VectorXd& state, cons
   return result;
 }
 
+Eigen::VectorXd SSLBallApproach::getDeterministicSuccessor(const Eigen::VectorXd& state,
+                                                           const Eigen::VectorXd& action,
+                                                           Eigen::MatrixXd* state_jacobian,
+                                                           Eigen::MatrixXd* action_jacobian) const
+{
+  if (state.rows() != 6 || action.rows() != 3)
+  {
+    std::ostringstream oss;
+    oss << "SSLBallApproach::getDeterministicSuccessor: invalid dimensions: state " << state.rows() << ", action "
+        << action.rows() << " (expecting 6 and 3)";
+    throw std::logic_error(oss.str());
+  }
+  // Same motion as getSuccessor without noise: the robot moves by
+  // 'displacement' in rt and the ball is then expressed in rdt with
+  // R * (ball - displacement), vectors with R * v
+  Eigen::Vector3d acc = boundXYA(action, max_acc, max_acc_theta);
+  Eigen::Vector3d curr_speed = state.segment(3, 3);
+  Eigen::Vector3d unbounded_speed = curr_speed + acc * dt;
+  // As in getSuccessor, average speed is computed before bounding speed
+  Eigen::Vector3d displacement = (curr_speed + unbounded_speed) / 2 * dt;
+  Eigen::Vector3d next_speed = boundXYA(unbounded_speed, max_speed, max_speed_theta);
+  double c = cos(displacement(2));
+  double s = sin(displacement(2));
+  Eigen::Matrix2d rotation, rotation_derivative;
+  rotation << c, s, -s, c;
+  rotation_derivative << -s, c, -c, -s;
+  Eigen::Vector2d ball_in_rt(getBallX(state), getBallY(state));
+  Eigen::Vector2d ball_offset = ball_in_rt - displacement.segment(0, 2);
+  Eigen::Vector2d ball_in_rdt = rotation * ball_offset;
+  Eigen::Vector2d next_speed_in_rdt = rotation * next_speed.segment(0, 2);
+  Eigen::VectorXd successor(6);
+  successor(0) = ball_in_rdt.norm();
+  successor(1) = atan2(ball_in_rdt(1), ball_in_rdt(0));
+  successor(2) = normalizeAngle(state(2) - displacement(2));
+  successor.segment(3, 2) = next_speed_in_rdt;
+  successor(5) = next_speed(2);
+  if (state_jacobian == nullptr && action_jacobian == nullptr)
+  {
+    return successor;
+  }
+  // Derivatives of the intermediate variables
+  Eigen::Matrix3d acc_jacobian = boundXYAJacobian(action, max_acc, max_acc_theta);
+  Eigen::Matrix<double, 3, 6> d_disp_d_state = Eigen::Matrix<double, 3, 6>::Zero();
+  d_disp_d_state.block<3, 3>(0, 3) = Eigen::Matrix3d::Identity() * dt;
+  Eigen::Matrix3d d_disp_d_action = acc_jacobian * dt * dt / 2;
+  Eigen::Matrix3d speed_jacobian = boundXYAJacobian(unbounded_speed, max_speed, max_speed_theta);
+  Eigen::Matrix<double, 3, 6> d_speed_d_state = Eigen::Matrix<double, 3, 6>::Zero();
+  d_speed_d_state.block<3, 3>(0, 3) = speed_jacobian;
+  Eigen::Matrix3d d_speed_d_action = speed_jacobian * acc_jacobian * dt;
+  Eigen::Matrix<double, 2, 6> d_ball_d_state = Eigen::Matrix<double, 2, 6>::Zero();
+  d_ball_d_state.col(0) << cos(state(1)), sin(state(1));
+  d_ball_d_state.col(1) << -ball_in_rt(1), ball_in_rt(0);
+  // Derivatives of the ball position in rdt
+  Eigen::Matrix<double, 2, 6> d_ball_rdt_d_state = rotation * (d_ball_d_state - d_disp_d_state.block<2, 6>(0, 0)) +
+                                                   rotation_derivative * ball_offset * d_disp_d_state.row(2);
+  Eigen::Matrix<double, 2, 3> d_ball_rdt_d_action =
+      -rotation * d_disp_d_action.block<2, 3>(0, 0) + rotation_derivative * ball_offset * d_disp_d_action.row(2);
+  Eigen::MatrixXd ds = Eigen::MatrixXd::Zero(6, 6);
+  Eigen::MatrixXd da = Eigen::MatrixXd::Zero(6, 3);
+  double sq_dist = ball_in_rdt.squaredNorm();
+  if (sq_dist > 0)
+  {
+    double dist = std::sqrt(sq_dist);
+    ds.row(0) = ball_in_rdt.transpose() * d_ball_rdt_d_state / dist;
+    da.row(0) = ball_in_rdt.transpose() * d_ball_rdt_d_action / dist;
+    ds.row(1) = (ball_in_rdt(0) * d_ball_rdt_d_state.row(1) - ball_in_rdt(1) * d_ball_rdt_d_state.row(0)) / sq_dist;
+    da.row(1) = (ball_in_rdt(0) * d_ball_rdt_d_action.row(1) - ball_in_rdt(1) * d_ball_rdt_d_action.row(0)) / sq_dist;
+  }
+  ds.row(2) = -d_disp_d_state.row(2);
+  ds(2, 2) += 1;
+  da.row(2) = -d_disp_d_action.row(2);
+  ds.block<2, 6>(3, 0) = rotation * d_speed_d_state.block<2, 6>(0, 0) +
+                         rotation_derivative * next_speed.segment(0, 2) * d_disp_d_state.row(2);
+  da.block<2, 3>(3, 0) = rotation * d_speed_d_action.block<2, 3>(0, 0) +
+                         rotation_derivative * next_speed.segment(0, 2) * d_disp_d_action.row(2);
+  ds.row(5) = d_speed_d_state.row(2);
+  da.row(5) = d_speed_d_action.row(2);
+  if (state_jacobian != nullptr)
+  {
+    *state_jacobian = ds;
+  }
+  if (action_jacobian != nullptr)
+  {
+    *action_jacobian = da;
+  }
+  return successor;
+}
+
 Eigen::VectorXd SSLBallApproach::getStartingState(std::default_random_engine* engine) const
 {
   Eigen::VectorXd state = Eigen::VectorXd::Zero(6);
@@ -1,11 +1,16 @@
 #include "problems/ssl_dynamic_ball_approach.h"
 
+#include "utils/config_cache.h"
+#include "utils/sin_cos.h"
+#include "utils/ziggurat_normal.h"
+
 #include <rhoban_utils/angle.h>
-#include <rhoban_fa/function_approximator_factory.h>
 
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <random>
+#include <sstream>
 
 namespace csa_mdp
 {
@@ -28,28 +33,41 @@ static Eigen::Vector3d boundXYA(const Eigen::Vector3d& vec, double cart_bound, d
   return bounded_vec;
 }
 
+/// Derivative of boundNorm(vec, bound) with respect to vec
+static Eigen::Matrix2d boundNormJacobian(const Eigen::Vector2d& vec, double bound)
+{
+  double norm = vec.norm();
+  if (norm > bound)
+  {
+    return bound / norm * (Eigen::Matrix2d::Identity() - vec * vec.transpose() / (norm * norm));
+  }
+  return Eigen::Matrix2d::Identity();
+}
+
+/// Derivative of boundXYA(vec, cart_bound, a_bound) with respect to vec
+static Eigen::Matrix3d boundXYAJacobian(const Eigen::Vector3d& vec, double cart_bound, double a_bound)
+{
+  Eigen::Matrix3d jacobian = Eigen::Matrix3d::Zero();
+  jacobian.block<2, 2>(0, 0) = boundNormJacobian(vec.segment<2>(0), cart_bound);
+  jacobian(2, 2) = std::fabs(vec(2)) <= a_bound ? 1 : 0;
+  return jacobian;
+}
+
 static Eigen::Vector2d pointFromPolar(double dist, double angle_rad)
 {
   return Eigen::Vector2d(dist * cos(angle_rad), dist * sin(angle_rad));
 }
 
-/// Return the homogeneous transform T_r2_from_r1
-/// p    : the position of R2 center in r1 referential
-/// alpha: the rotation from R1 to R2 (R2.x = R1.x * cos(alpha) + R1.y * sin(theta))
-static Eigen::Matrix<double, 3, 3> getR2FromR1(const Eigen::Vector2d& p, double alpha)
+/// 64 bits FNV-1a hash of the provided data
+static uint64_t hashFNV1a(const std::string& data)
 {
-  Eigen::Matrix<double, 2, 2> rotation;
-  rotation(0, 0) = cos(alpha);
-  rotation(0, 1) = sin(alpha);
-  rotation(1, 0) = -sin(alpha);
-  rotation(1, 1) = cos(alpha);
-  Eigen::Matrix<double, 3, 3> transform;
-  transform.block(0, 0, 2, 2) = rotation;
-  transform.block(0, 2, 2, 1) = -rotation * p;
-  transform(2, 0) = 0;
-  transform(2, 1) = 0;
-  transform(2, 2) = 1;
-  return transform;
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : data)
+  {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
 }
 
 SSLDynamicBallApproach::SSLDynamicBallApproach()
@@ -130,6 +148,11 @@ void SSLDynamicBallApproach::setMaxDist(double dist)
 }
 
 bool SSLDynamicBallApproach::isTerminal(const Eigen::VectorXd& state) const
+{
+  return isTerminal(FixedState(state));
+}
+
+bool SSLDynamicBallApproach::isTerminal(const FixedState& state) const
 {
   return isSuccess(state) || isColliding(state) || isOutOfSpace(state);
 }
@@ -137,12 +160,16 @@ bool SSLDynamicBallApproach::isTerminal(const Eigen::VectorXd& state) const
 double SSLDynamicBallApproach::getReward(const Eigen::VectorXd& state, const Eigen::VectorXd& action,
                                          const Eigen::VectorXd& dst) const
 {
-  (void)state;
   (void)action;
+  return getReward(FixedState(state), FixedState(dst));
+}
+
+double SSLDynamicBallApproach::getReward(const FixedState& state, const FixedState& dst) const
+{
   if (isSuccess(dst))
   {
     if (mode == Mode::Wide && finish_value)
-      return finish_value->predict(getLearningState(state))(0);
+      return getFinishValue(state);
     return 0;
   }
   if (isColliding(dst))
@@ -167,67 +194,247 @@ Problem::Result SSLDynamicBallApproach::getSuccessor(const Eigen::VectorXd& stat
         << " invalid dimension for action, expecting 4 and received " << action.rows();
     throw std::runtime_error(oss.str());
   }
+  FixedState successor;
+  Problem::Result result;
+  step(state, action.segment<3>(1), engine, &successor, &result.reward, &result.terminal);
+  result.successor = successor;
+  return result;
+}
+
+void SSLDynamicBallApproach::step(const FixedState& state, const Eigen::Vector3d& action,
+                                  std::default_random_engine* engine, FixedState* successor, double* reward,
+                                  bool* terminal) const
+{
+  double noise[3];
+  ZigguratNormal::fill(noise, 3, engine);
+  stepWithNoise(state, action, noise, successor, reward, terminal);
+}
+
+void SSLDynamicBallApproach::stepWithNoise(const FixedState& state, const Eigen::Vector3d& action,
+                                           const double* noise, FixedState* successor, double* reward,
+                                           bool* terminal) const
+{
+  // Keeping a copy of the state since successor might alias it
+  FixedState src = state;
+  applyMotion(src, action, noise, successor);
+  *reward = getReward(src, *successor);
+  *terminal = isTerminal(*successor);
+}
+
+void SSLDynamicBallApproach::applyMotion(const FixedState& state, const Eigen::Vector3d& action, const double* noise,
+                                         FixedState* successor) const
+{
   // REFERENTIAL INFORMATIONS
   // Here, we use 2 different basis:
   // rt : referential of the robot at time 'now'
   // rdt: referential of the robot at time 'now+dt'
   // BOUNDING ACCELERATION AND SPEED TO PHYSICAL LIMITS
-  Eigen::Vector3d robot_acc_in_rt = action.segment(1, 3);
-  robot_acc_in_rt = boundXYA(robot_acc_in_rt, max_acc, max_acc_theta);
-  Eigen::Vector3d robot_curr_speed_in_rt = state.segment(4, 3);
+  Eigen::Vector3d robot_acc_in_rt = boundXYA(action, max_acc, max_acc_theta);
+  Eigen::Vector3d robot_curr_speed_in_rt = state.segment<3>(4);
   Eigen::Vector3d robot_next_speed_in_rt = robot_curr_speed_in_rt + robot_acc_in_rt * dt;
   robot_next_speed_in_rt = boundXYA(robot_next_speed_in_rt, max_robot_speed, max_robot_speed_theta);
   // COMPUTING NOISE
   // Since variance is multiplied by dt, stddev is multiplied by sqrt(dt)
   double noise_multiplier = std::sqrt(dt);
-  std::normal_distribution<double> cart_noise(0, cart_stddev * noise_multiplier);
-  std::normal_distribution<double> angular_noise(0, angular_stddev * noise_multiplier);
-  double noise_x = cart_noise(*engine);
-  double noise_y = cart_noise(*engine);
-  double noise_theta = angular_noise(*engine);
+  double noise_x = cart_stddev * noise_multiplier * noise[0];
+  double noise_y = cart_stddev * noise_multiplier * noise[1];
+  double noise_theta = angular_stddev * noise_multiplier * noise[2];
   // GETTING TRANSFORM FROM RT TO RDT
   Eigen::Vector3d robot_avg_speed_in_rt = (robot_curr_speed_in_rt + robot_next_speed_in_rt) / 2;
-  double next_theta_speed = robot_next_speed_in_rt(2);
-  // Computing orientation change of robot
   double theta_diff = robot_avg_speed_in_rt(2) * dt + noise_theta;
-  robot_avg_speed_in_rt(2) = 0;  // Transforming avg_speed_in_rt to homogeneous coordinates
-  Eigen::Vector3d next_pos_in_rt = Eigen::Vector3d(noise_x, noise_y, 1) + robot_avg_speed_in_rt * dt;
-  Eigen::Matrix<double, 3, 3> rdt_from_rt = getR2FromR1(next_pos_in_rt.segment(0, 2), theta_diff);
+  // Position of the robot at 'now+dt' in rt
+  double pos_x = noise_x + robot_avg_speed_in_rt(0) * dt;
+  double pos_y = noise_y + robot_avg_speed_in_rt(1) * dt;
+  // Points are transformed with R(-theta_diff) * (p - pos) and vectors with R(-theta_diff) * v
+  double c = cos(theta_diff);
+  double s = sin(theta_diff);
   // ROLLING BALL
-  Eigen::Vector4d ball_state;
-  ball_state.segment(0, 2) = state.segment(0, 2);
-  ball_state.segment(2, 2) = state.segment(7, 2);
+  Eigen::Vector4d ball_state(state(0), state(1), state(7), state(8));
   ball_state = rolling_ball_model.getNextState(ball_state, dt);
-  // GETTING OBJECT FINAL POSITION
-  Eigen::Vector3d ball_in_rt, target_in_rt, ball_speed_in_rt;
-  ball_in_rt.segment(0, 2) = ball_state.segment(0, 2);
-  ball_in_rt(2) = 1;  // point
-  target_in_rt.segment(0, 2) = state.segment(2, 2);
-  target_in_rt(2) = 1;  // point
-  ball_speed_in_rt.segment(0, 2) = ball_state.segment(2, 2);
-  ball_speed_in_rt(2) = 0;        // vector
-  robot_next_speed_in_rt(2) = 0;  // vector
-  // TRANSFORMING TO RDT REFERENTIAL
-  Eigen::Vector3d ball_in_rdt, target_in_rdt, ball_speed_in_rdt, robot_next_speed_in_rdt;
-  ball_in_rdt = rdt_from_rt * ball_in_rt;
-  target_in_rdt = rdt_from_rt * target_in_rt;
-  robot_next_speed_in_rdt = rdt_from_rt * robot_next_speed_in_rt;
-  ball_speed_in_rdt = rdt_from_rt * ball_speed_in_rt;
-  // Filling up successor
-  Eigen::VectorXd successor(11);
-  successor.segment(0, 2) = ball_in_rdt.segment(0, 2);
-  successor.segment(2, 2) = target_in_rdt.segment(0, 2);
-  successor.segment(4, 2) = robot_next_speed_in_rdt.segment(0, 2);
-  successor(6) = next_theta_speed;
-  successor.segment(7, 2) = ball_speed_in_rdt.segment(0, 2);
-  successor(9) = state(9);  // kick_dir_tol is fixed for each trial
-  successor(10) = state(10) + theta_diff;
-  // Filling up result
-  Problem::Result result;
-  result.successor = successor;
-  result.reward = getReward(state, action, successor);
-  result.terminal = isTerminal(successor);
-  return result;
+  // Keeping a copy of the state since successor might alias it
+  FixedState src = state;
+  FixedState& dst = *successor;
+  double ball_dx = ball_state(0) - pos_x;
+  double ball_dy = ball_state(1) - pos_y;
+  double target_dx = src(2) - pos_x;
+  double target_dy = src(3) - pos_y;
+  dst(0) = c * ball_dx + s * ball_dy;
+  dst(1) = -s * ball_dx + c * ball_dy;
+  dst(2) = c * target_dx + s * target_dy;
+  dst(3) = -s * target_dx + c * target_dy;
+  dst(4) = c * robot_next_speed_in_rt(0) + s * robot_next_speed_in_rt(1);
+  dst(5) = -s * robot_next_speed_in_rt(0) + c * robot_next_speed_in_rt(1);
+  dst(6) = robot_next_speed_in_rt(2);
+  dst(7) = c * ball_state(2) + s * ball_state(3);
+  dst(8) = -s * ball_state(2) + c * ball_state(3);
+  dst(9) = src(9);  // kick_dir_tol is fixed for each trial
+  dst(10) = src(10) + theta_diff;
+}
+
+Eigen::VectorXd SSLDynamicBallApproach::getDeterministicSuccessor(const Eigen::VectorXd& state,
+                                                                  const Eigen::VectorXd& action,
+                                                                  Eigen::MatrixXd* state_jacobian,
+                                                                  Eigen::MatrixXd* action_jacobian) const
+{
+  if (state.rows() != 11 || action.rows() != 3)
+  {
+    std::ostringstream oss;
+    oss << "SSLDynamicBallApproach::getDeterministicSuccessor: invalid dimensions: state " << state.rows()
+        << ", action " << action.rows() << " (expecting 11 and 3)";
+    throw std::logic_error(oss.str());
+  }
+  double noise[3] = { 0, 0, 0 };
+  FixedState successor;
+  applyMotion(state, action, noise, &successor);
+  if (state_jacobian == nullptr && action_jacobian == nullptr)
+  {
+    return successor;
+  }
+  // Motion of the robot, see applyMotion
+  Eigen::Vector3d acc = boundXYA(action, max_acc, max_acc_theta);
+  Eigen::Vector3d curr_speed = state.segment<3>(4);
+  Eigen::Vector3d unbounded_speed = curr_speed + acc * dt;
+  Eigen::Vector3d next_speed = boundXYA(unbounded_speed, max_robot_speed, max_robot_speed_theta);
+  Eigen::Vector3d displacement = (curr_speed + next_speed) / 2 * dt;
+  double c = cos(displacement(2));
+  double s = sin(displacement(2));
+  Eigen::Matrix2d rotation, rotation_derivative;
+  rotation << c, s, -s, c;
+  rotation_derivative << -s, c, -c, -s;
+  Eigen::Vector4d ball_state(state(0), state(1), state(7), state(8));
+  Eigen::Matrix4d ball_jacobian = rolling_ball_model.getJacobian(dt);
+  ball_state = rolling_ball_model.getNextState(ball_state, dt);
+  // Derivatives of the intermediate variables
+  Eigen::Matrix3d speed_jacobian = boundXYAJacobian(unbounded_speed, max_robot_speed, max_robot_speed_theta);
+  Eigen::Matrix<double, 3, 11> d_speed_d_state = Eigen::Matrix<double, 3, 11>::Zero();
+  d_speed_d_state.block<3, 3>(0, 4) = speed_jacobian;
+  Eigen::Matrix3d d_speed_d_action = speed_jacobian * dt * boundXYAJacobian(action, max_acc, max_acc_theta);
+  Eigen::Matrix<double, 3, 11> d_disp_d_state = d_speed_d_state * dt / 2;
+  d_disp_d_state.block<3, 3>(0, 4) += Eigen::Matrix3d::Identity() * dt / 2;
+  Eigen::Matrix3d d_disp_d_action = d_speed_d_action * dt / 2;
+  Eigen::Matrix<double, 4, 11> d_ball_d_state = Eigen::Matrix<double, 4, 11>::Zero();
+  d_ball_d_state.col(0) = ball_jacobian.col(0);
+  d_ball_d_state.col(1) = ball_jacobian.col(1);
+  d_ball_d_state.col(7) = ball_jacobian.col(2);
+  d_ball_d_state.col(8) = ball_jacobian.col(3);
+  Eigen::Matrix<double, 2, 11> d_target_d_state = Eigen::Matrix<double, 2, 11>::Zero();
+  d_target_d_state.block<2, 2>(0, 2) = Eigen::Matrix2d::Identity();
+  // Points p are transformed to R * (p - pos), vectors v to R * v
+  Eigen::Vector2d ball_offset = ball_state.segment<2>(0) - displacement.segment<2>(0);
+  Eigen::Vector2d target_offset = state.segment<2>(2) - displacement.segment<2>(0);
+  Eigen::MatrixXd ds = Eigen::MatrixXd::Zero(11, 11);
+  Eigen::MatrixXd da = Eigen::MatrixXd::Zero(11, 3);
+  ds.block<2, 11>(0, 0) = rotation * (d_ball_d_state.block<2, 11>(0, 0) - d_disp_d_state.block<2, 11>(0, 0)) +
+                          rotation_derivative * ball_offset * d_disp_d_state.row(2);
+  da.block<2, 3>(0, 0) =
+      -rotation * d_disp_d_action.block<2, 3>(0, 0) + rotation_derivative * ball_offset * d_disp_d_action.row(2);
+  ds.block<2, 11>(2, 0) = rotation * (d_target_d_state - d_disp_d_state.block<2, 11>(0, 0)) +
+                          rotation_derivative * target_offset * d_disp_d_state.row(2);
+  da.block<2, 3>(2, 0) =
+      -rotation * d_disp_d_action.block<2, 3>(0, 0) + rotation_derivative * target_offset * d_disp_d_action.row(2);
+  ds.block<2, 11>(4, 0) = rotation * d_speed_d_state.block<2, 11>(0, 0) +
+                          rotation_derivative * next_speed.segment<2>(0) * d_disp_d_state.row(2);
+  da.block<2, 3>(4, 0) = rotation * d_speed_d_action.block<2, 3>(0, 0) +
+                         rotation_derivative * next_speed.segment<2>(0) * d_disp_d_action.row(2);
+  ds.row(6) = d_speed_d_state.row(2);
+  da.row(6) = d_speed_d_action.row(2);
+  ds.block<2, 11>(7, 0) = rotation * d_ball_d_state.block<2, 11>(2, 0) +
+                          rotation_derivative * ball_state.segment<2>(2) * d_disp_d_state.row(2);
+  da.block<2, 3>(7, 0) = rotation_derivative * ball_state.segment<2>(2) * d_disp_d_action.row(2);
+  ds(9, 9) = 1;
+  ds.row(10) = d_disp_d_state.row(2);
+  ds(10, 10) += 1;
+  da.row(10) = d_disp_d_action.row(2);
+  if (state_jacobian != nullptr)
+  {
+    *state_jacobian = ds;
+  }
+  if (action_jacobian != nullptr)
+  {
+    *action_jacobian = da;
+  }
+  return successor;
+}
+
+void SSLDynamicBallApproach::getSuccessors(const Eigen::MatrixXd& states, const Eigen::MatrixXd& actions,
+                                           std::default_random_engine* engine, Eigen::MatrixXd* successors,
+                                           Eigen::VectorXd* rewards, Eigen::Array<bool, -1, 1>* terminal,
+                                           bool strict) const
+{
+  int n = states.cols();
+  if (states.rows() != 11 || actions.rows() != 4 || actions.cols() != n || successors->rows() != 11 ||
+      successors->cols() != n || rewards->rows() != n || terminal->rows() != n)
+  {
+    std::ostringstream oss;
+    oss << "SSLDynamicBallApproach::getSuccessors: invalid dimensions: states " << states.rows() << "x"
+        << states.cols() << ", actions " << actions.rows() << "x" << actions.cols() << ", successors "
+        << successors->rows() << "x" << successors->cols() << ", rewards " << rewards->rows() << ", terminal "
+        << terminal->rows();
+    throw std::logic_error(oss.str());
+  }
+  // Samples are drawn in the same order as successive calls to step
+  Eigen::ArrayXXd noise(3, n);
+  ZigguratNormal::fill(noise.data(), 3 * n, engine);
+  if (strict)
+  {
+    FixedState successor;
+    for (int col = 0; col < n; col++)
+    {
+      stepWithNoise(states.col(col), actions.block<3, 1>(1, col), noise.col(col).data(), &successor,
+                    &((*rewards)(col)), &((*terminal)(col)));
+      successors->col(col) = successor;
+    }
+    return;
+  }
+  typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArray;
+  // Bounding norms by multiplying with bound / max(norm, bound) avoids divisions by 0
+  RowArray acc_x = actions.row(1).array();
+  RowArray acc_y = actions.row(2).array();
+  RowArray acc_scale = max_acc / (acc_x.square() + acc_y.square()).sqrt().max(max_acc);
+  RowArray acc_theta = actions.row(3).array().max(-max_acc_theta).min(max_acc_theta);
+  RowArray speed_x = states.row(4).array() + acc_x * acc_scale * dt;
+  RowArray speed_y = states.row(5).array() + acc_y * acc_scale * dt;
+  RowArray speed_scale = max_robot_speed / (speed_x.square() + speed_y.square()).sqrt().max(max_robot_speed);
+  speed_x *= speed_scale;
+  speed_y *= speed_scale;
+  RowArray speed_theta =
+      (states.row(6).array() + acc_theta * dt).max(-max_robot_speed_theta).min(max_robot_speed_theta);
+  // Transform from rt to rdt
+  double noise_multiplier = std::sqrt(dt);
+  RowArray theta_diff = (states.row(6).array() + speed_theta) / 2 * dt +
+                        angular_stddev * noise_multiplier * noise.row(2);
+  RowArray pos_x = cart_stddev * noise_multiplier * noise.row(0) + (states.row(4).array() + speed_x) / 2 * dt;
+  RowArray pos_y = cart_stddev * noise_multiplier * noise.row(1) + (states.row(5).array() + speed_y) / 2 * dt;
+  RowArray c(n), s(n);
+  sinCos(n, theta_diff.data(), s.data(), c.data());
+  // Rolling ball
+  Eigen::ArrayXXd balls(4, n);
+  for (int col = 0; col < n; col++)
+  {
+    Eigen::Vector4d ball_state(states(0, col), states(1, col), states(7, col), states(8, col));
+    balls.col(col) = rolling_ball_model.getNextState(ball_state, dt).array();
+  }
+  RowArray ball_dx = balls.row(0) - pos_x;
+  RowArray ball_dy = balls.row(1) - pos_y;
+  RowArray target_dx = states.row(2).array() - pos_x;
+  RowArray target_dy = states.row(3).array() - pos_y;
+  successors->row(0) = (c * ball_dx + s * ball_dy).matrix();
+  successors->row(1) = (-s * ball_dx + c * ball_dy).matrix();
+  successors->row(2) = (c * target_dx + s * target_dy).matrix();
+  successors->row(3) = (-s * target_dx + c * target_dy).matrix();
+  successors->row(4) = (c * speed_x + s * speed_y).matrix();
+  successors->row(5) = (-s * speed_x + c * speed_y).matrix();
+  successors->row(6) = speed_theta.matrix();
+  successors->row(7) = (c * balls.row(2) + s * balls.row(3)).matrix();
+  successors->row(8) = (-s * balls.row(2) + c * balls.row(3)).matrix();
+  successors->row(9) = states.row(9);
+  successors->row(10) = states.row(10) + theta_diff.matrix();
+  for (int col = 0; col < n; col++)
+  {
+    FixedState dst = successors->col(col);
+    (*rewards)(col) = getReward(states.col(col), dst);
+    (*terminal)(col) = isTerminal(dst);
+  }
 }
 
 Eigen::VectorXd SSLDynamicBallApproach::getStartingState(std::default_random_engine* engine) const
@@ -305,6 +512,11 @@ Eigen::VectorXd SSLDynamicBallApproach::getFinishStartingState(std::default_rand
 }
 
 bool SSLDynamicBallApproach::isSuccess(const Eigen::VectorXd& state) const
+{
+  return isSuccess(FixedState(state));
+}
+
+bool SSLDynamicBallApproach::isSuccess(const FixedState& state) const
 {
   switch (mode)
   {
@@ -319,57 +531,170 @@ bool SSLDynamicBallApproach::isSuccess(const Eigen::VectorXd& state) const
 
 bool SSLDynamicBallApproach::isFinishState(const Eigen::VectorXd& state) const
 {
-  // Get speed difference
-  const Eigen::Vector2d& robot_speed = state.segment(4, 2);
-  const Eigen::Vector2d& ball_speed = state.segment(7, 2);
-  Eigen::Vector2d speed_diff = robot_speed - ball_speed;
-  double target_dir_rad = atan2(state(3), state(2));  // Result in [-pi,pi]
-  // Computing conditions separately
-  bool ball_x_ok = state(0) >= finish_x_limits(0) && state(0) <= finish_x_limits(1);
-  bool ball_y_ok = std::fabs(state(1)) <= finish_y_tol;
-  bool speed_x_ok = speed_diff(0) >= finish_diff_speed_x_limits(0) && speed_diff(0) <= finish_diff_speed_x_limits(1);
-  bool speed_y_ok = std::fabs(speed_diff(1)) <= finish_diff_speed_y_max;
-  bool speed_theta_ok = std::fabs(state(6)) <= finish_speed_theta_max;
-  bool direction_ok = std::fabs(target_dir_rad) <= state(9);
-  // All conditions need to be gathered
-  return ball_x_ok && ball_y_ok && speed_x_ok && speed_y_ok && speed_theta_ok && direction_ok;
+  return isFinishState(FixedState(state));
+}
+
+bool SSLDynamicBallApproach::isFinishState(const FixedState& state) const
+{
+  return isInZone(state, finish_x_limits, finish_y_tol, finish_diff_speed_x_limits, finish_diff_speed_y_max,
+                  finish_speed_theta_max);
 }
 
 bool SSLDynamicBallApproach::isKickable(const Eigen::VectorXd& state) const
+{
+  return isKickable(FixedState(state));
+}
+
+bool SSLDynamicBallApproach::isKickable(const FixedState& state) const
+{
+  return isInZone(state, kick_x_limits, kick_y_tol, kick_diff_speed_x_limits, kick_diff_speed_y_max,
+                  kick_speed_theta_max);
+}
+
+bool SSLDynamicBallApproach::isInZone(const FixedState& state, const Eigen::Vector2d& x_limits, double y_tol,
+                                      const Eigen::Vector2d& diff_speed_x_limits, double diff_speed_y_max,
+                                      double speed_theta_max) const
 {
   // Get speed difference
-  const Eigen::Vector2d& robot_speed = state.segment(4, 2);
-  const Eigen::Vector2d& ball_speed = state.segment(7, 2);
-  Eigen::Vector2d speed_diff = robot_speed - ball_speed;
-  double target_dir_rad = atan2(state(3), state(2));  // Result in [-pi,pi]
+  double speed_diff_x = state(4) - state(7);
+  double speed_diff_y = state(5) - state(8);
   // Computing conditions separately
-  bool ball_x_ok = state(0) >= kick_x_limits(0) && state(0) <= kick_x_limits(1);
-  bool ball_y_ok = std::fabs(state(1)) <= kick_y_tol;
-  bool speed_x_ok = speed_diff(0) >= kick_diff_speed_x_limits(0) && speed_diff(0) <= kick_diff_speed_x_limits(1);
-  bool speed_y_ok = std::fabs(speed_diff(1)) <= kick_diff_speed_y_max;
-  bool speed_theta_ok = std::fabs(state(6)) <= kick_speed_theta_max;
-  bool direction_ok = std::fabs(target_dir_rad) <= state(9);
-  // All conditions need to be gathered
-  return ball_x_ok && ball_y_ok && speed_x_ok && speed_y_ok && speed_theta_ok && direction_ok;
+  bool ball_x_ok = state(0) >= x_limits(0) && state(0) <= x_limits(1);
+  bool ball_y_ok = std::fabs(state(1)) <= y_tol;
+  bool speed_x_ok = speed_diff_x >= diff_speed_x_limits(0) && speed_diff_x <= diff_speed_x_limits(1);
+  bool speed_y_ok = std::fabs(speed_diff_y) <= diff_speed_y_max;
+  bool speed_theta_ok = std::fabs(state(6)) <= speed_theta_max;
+  // Direction is only computed when all other conditions are gathered
+  if (!(ball_x_ok && ball_y_ok && speed_x_ok && speed_y_ok && speed_theta_ok))
+  {
+    return false;
+  }
+  double target_dir_rad = atan2(state(3), state(2));  // Result in [-pi,pi]
+  return std::fabs(target_dir_rad) <= state(9);
 }
 
 bool SSLDynamicBallApproach::isColliding(const Eigen::VectorXd& state) const
+{
+  return isColliding(FixedState(state));
+}
+
+bool SSLDynamicBallApproach::isColliding(const FixedState& state) const
 {
   // Robot is globally circular but it has a kicker 'inside' the circle
-  return state(0) < collision_forward && state.segment(0, 2).norm() <= collision_radius;
+  return state(0) < collision_forward && state.segment<2>(0).norm() <= collision_radius;
 }
 
 bool SSLDynamicBallApproach::isOutOfSpace(const Eigen::VectorXd& state) const
 {
-  bool ball_dist_ko = state.segment(0, 2).norm() > ball_max_dist;
-  bool target_dist_ko = state.segment(2, 2).norm() > target_max_dist;
-  bool robot_cart_speed_ko = state.segment(4, 2).norm() > max_robot_speed;
+  return isOutOfSpace(FixedState(state));
+}
+
+bool SSLDynamicBallApproach::isOutOfSpace(const FixedState& state) const
+{
+  bool ball_dist_ko = state.segment<2>(0).norm() > ball_max_dist;
+  bool target_dist_ko = state.segment<2>(2).norm() > target_max_dist;
+  // The motion saturates the speed of the robot, the rotation to the next
+  // referential should not turn rounding errors into exits
+  bool robot_cart_speed_ko = state.segment<2>(4).norm() > max_robot_speed * (1 + 1e-9);
   bool robot_theta_speed_ko = std::fabs(state(6)) > max_robot_speed_theta;
-  bool ball_speed_ko = state.segment(7, 2).norm() > max_ball_speed;
+  bool ball_speed_ko = state.segment<2>(7).norm() > max_ball_speed;
   bool kick_tol_ko = state(9) < min_kick_dir_tol || state(9) > max_kick_dir_tol;
   return ball_dist_ko || target_dist_ko || robot_cart_speed_ko || robot_theta_speed_ko || ball_speed_ko || kick_tol_ko;
 }
 
+double SSLDynamicBallApproach::getFinishValue(const FixedState& state) const
+{
+  // Learning dimensions are the first 10 dimensions of the state
+  auto learning_state = state.segment<10>(0);
+  if (finish_value_table && finish_value_table->contains(learning_state))
+  {
+    return finish_value_table->getValue(learning_state);
+  }
+  return finish_value->predict(getLearningState(Eigen::VectorXd(state)))(0);
+}
+
+Eigen::MatrixXd SSLDynamicBallApproach::getFinishValueTableLimits() const
+{
+  const Eigen::MatrixXd& state_limits = getStateLimits();
+  Eigen::MatrixXd limits = state_limits.block(0, 0, 10, 2);
+  // Maximal relative motion of the ball during a step
+  double reach = (max_robot_speed + max_ball_speed) * dt;
+  double speed_theta_max = finish_speed_theta_max + max_acc_theta * dt;
+  limits.row(0) << finish_x_limits(0) - reach, finish_x_limits(1) + reach;
+  limits.row(1) << -finish_y_tol - reach, finish_y_tol + reach;
+  limits.row(6) << -speed_theta_max, speed_theta_max;
+  // Remaining inside the state space
+  limits.col(0) = limits.col(0).cwiseMax(state_limits.block(0, 0, 10, 1));
+  limits.col(1) = limits.col(1).cwiseMin(state_limits.block(0, 1, 10, 1));
+  return limits;
+}
+
+void SSLDynamicBallApproach::buildFinishValueTable(const Json::Value& v, const std::string& dir_name)
+{
+  if (!finish_value)
+  {
+    throw rhoban_utils::JsonParsingError("SSLDynamicBallApproach::buildFinishValueTable: finish_value is required");
+  }
+  int nb_threads = 1;
+  int error_samples = 1000;
+  std::string cache_dir;
+  rhoban_utils::tryRead(v, "nb_threads", &nb_threads);
+  rhoban_utils::tryRead(v, "error_samples", &error_samples);
+  rhoban_utils::tryRead(v, "cache_dir", &cache_dir);
+  std::vector<int> nb_points(10, 2);
+  if (v.isMember("resolution") && v["resolution"].isArray())
+  {
+    nb_points = rhoban_utils::readVector<int>(v, "resolution");
+  }
+  else if (v.isMember("resolution"))
+  {
+    nb_points = std::vector<int>(10, rhoban_utils::read<int>(v, "resolution"));
+  }
+  Eigen::MatrixXd limits = getFinishValueTableLimits();
+  // Tables are identified by the source of the approximator and the grid, the
+  // approximator itself is only loaded if the table has to be filled
+  std::ostringstream description;
+  description << finish_value.getSourceKey() << std::endl;
+  description.precision(17);
+  description << limits;
+  for (int n : nb_points)
+  {
+    description << " " << n;
+  }
+  std::ostringstream key;
+  key << std::hex << hashFNV1a(description.str());
+  finish_value_table = ConfigCache<const MultilinearTable>::getContent(key.str(), [&]() {
+    std::unique_ptr<MultilinearTable> table(new MultilinearTable(limits, nb_points));
+    std::string cache_path;
+    if (cache_dir != "")
+    {
+      cache_path = dir_name + cache_dir + "/finish_value_" + key.str() + ".bin";
+      if (table->tryLoad(cache_path))
+      {
+        std::cout << "SSLDynamicBallApproach: finish value table loaded from '" << cache_path << "'" << std::endl;
+        return table;
+      }
+    }
+    const rhoban_fa::FunctionApproximator& fa = finish_value.get();
+    MultilinearTable::Function f = [&fa](const Eigen::VectorXd& learning_state) {
+      return fa.predict(learning_state)(0);
+    };
+    table->fill(f, nb_threads);
+    // Reporting the error on random states of the grid
+    std::default_random_engine engine;
+    double max_error, mean_error;
+    table->getError(f, error_samples, &engine, &max_error, &mean_error);
+    std::cout << "SSLDynamicBallApproach: finish value table built with " << table->getNbValues()
+              << " values, error on " << error_samples << " samples: max " << max_error << ", mean " << mean_error
+              << std::endl;
+    if (cache_path != "")
+    {
+      table->save(cache_path);
+    }
+    return table;
+  });
+}
+
 Json::Value SSLDynamicBallApproach::toJson() const
 {
   throw std::logic_error("SSLDynamicBallApproach::toJson: not implemented");
@@ -444,9 +769,12 @@ void SSLDynamicBallApproach::fromJson(const Json::Value& v, const std::string& d
   max_kick_dir_tol = rhoban_utils::deg2rad(max_kick_dir_tol_deg);
   // If applicable load the finish value
   if (v.isMember("finish_value"))
-    rhoban_fa::FunctionApproximatorFactory().tryLoadBinaryFromPath(v["finish_value"], dir_name, &finish_value);
+    finish_value.setBinaryFromPath(v["finish_value"], dir_name);
   // Update limits according to the new parameters
   updateLimits();
+  // Table depends on the limits
+  if (v.isMember("finish_value_table"))
+    buildFinishValueTable(v["finish_value_table"], dir_name);
 }
 
 std::string SSLDynamicBallApproach::getClassName() const
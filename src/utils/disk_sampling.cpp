@@ -0,0 +1,112 @@
+#include "utils/disk_sampling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace csa_mdp
+{
+// Integral of sqrt(r^2-t^2) for t in [-r,u]
+static double circleIntegral(double u, double r)
+{
+  u = std::max(-r, std::min(r, u));
+  return 0.5 * (u * std::sqrt(std::max(0.0, r * r - u * u)) + r * r * std::asin(u / r)) + M_PI * r * r / 4;
+}
+
+// Integral of min(sqrt(r^2-t^2), d) for t in [-r,u]
+static double cappedCircleIntegral(double u, double r, double d)
+{
+  if (d >= r)
+  {
+    return circleIntegral(u, r);
+  }
+  // Half-width of the interval where the circle is above d
+  double w = std::sqrt(r * r - d * d);
+  if (u <= -w)
+  {
+    return circleIntegral(u, r);
+  }
+  if (u < w)
+  {
+    return circleIntegral(-w, r) + d * (u + w);
+  }
+  return circleIntegral(-w, r) + 2 * d * w + circleIntegral(u, r) - circleIntegral(w, r);
+}
+
+Eigen::Vector2d sampleDiskInBox(const Eigen::Vector2d& center, double radius, const Eigen::Matrix<double, 2, 2>& box,
+                                std::default_random_engine* engine)
+{
+  double cx = center(0), cy = center(1);
+  if (radius <= 0 || cx < box(0, 0) || cx > box(0, 1) || cy < box(1, 0) || cy > box(1, 1))
+  {
+    std::ostringstream oss;
+    oss << "sampleDiskInBox: invalid disk: center: " << center.transpose() << ", radius: " << radius;
+    throw std::logic_error(oss.str());
+  }
+  // Since the center is inside the box, the height of the section at x is
+  // min(s, dist_up) + min(s, dist_down) with s the half-chord
+  double dist_up = box(1, 1) - cy;
+  double dist_down = cy - box(1, 0);
+  double x_min = std::max(box(0, 0), cx - radius);
+  double x_max = std::min(box(0, 1), cx + radius);
+  auto half_chord = [radius, cx](double x) { return std::sqrt(std::max(0.0, radius * radius - (x - cx) * (x - cx))); };
+  auto area = [radius, cx, dist_up, dist_down](double x) {
+    return cappedCircleIntegral(x - cx, radius, dist_up) + cappedCircleIntegral(x - cx, radius, dist_down);
+  };
+  auto height = [&half_chord, dist_up, dist_down](double x) {
+    double s = half_chord(x);
+    return std::min(s, dist_up) + std::min(s, dist_down);
+  };
+  std::uniform_real_distribution<double> unit_distrib(0, 1);
+  double area_min = area(x_min);
+  double target = area_min + unit_distrib(*engine) * (area(x_max) - area_min);
+  double x = solveIncreasing(area, height, target, x_min, x_max, 1e-12 * (x_max - x_min), 100);
+  double s = half_chord(x);
+  double y_min = std::max(box(1, 0), cy - s);
+  double y_max = std::min(box(1, 1), cy + s);
+  return Eigen::Vector2d(x, y_min + unit_distrib(*engine) * (y_max - y_min));
+}
+
+double solveIncreasing(const std::function<double(double)>& f, const std::function<double(double)>& df,
+                       double target, double low, double high, double tol, int max_iter, int* nb_iter)
+{
+  double x = (low + high) / 2;
+  int iter = 0;
+  while (iter < max_iter && high - low > tol)
+  {
+    iter++;
+    double err = f(x) - target;
+    if (err == 0)
+    {
+      break;
+    }
+    if (err > 0)
+    {
+      high = x;
+    }
+    else
+    {
+      low = x;
+    }
+    double next = (low + high) / 2;
+    double slope = df(x);
+    if (slope > 0 && x - err / slope > low && x - err / slope < high)
+    {
+      next = x - err / slope;
+    }
+    bool converged = std::fabs(next - x) < tol;
+    x = next;
+    if (converged)
+    {
+      break;
+    }
+  }
+  if (nb_iter != nullptr)
+  {
+    *nb_iter = iter;
+  }
+  return x;
+}
+
+}  // namespace csa_mdp
@@ -0,0 +1,147 @@
+#include "utils/lazy_approximator.h"
+
+#include "utils/config_cache.h"
+
+#include "rhoban_fa/function_approximator_factory.h"
+
+#include <climits>
+#include <cstdlib>
+
+namespace csa_mdp
+{
+typedef ConfigCache<const rhoban_fa::FunctionApproximator> ApproximatorCache;
+
+/// Since the exact format of v is handled by the factory, every string found
+/// in v is considered as a candidate path, both as is and relative to dir_name
+static void getCandidatePaths(const Json::Value& v, const std::string& dir_name, std::vector<std::string>* paths)
+{
+  if (v.isString())
+  {
+    paths->push_back(v.asString());
+    paths->push_back(dir_name + v.asString());
+  }
+  else if (v.isObject() || v.isArray())
+  {
+    for (const Json::Value& child : v)
+    {
+      getCandidatePaths(child, dir_name, paths);
+    }
+  }
+}
+
+/// Version of all the files, missing files are also part of the version since
+/// they might be created later
+static std::string getFilesVersion(const std::vector<std::string>& paths)
+{
+  std::string version;
+  for (const std::string& path : paths)
+  {
+    version += getFileVersion(path) + ";";
+  }
+  return version;
+}
+
+LazyApproximator::LazyApproximator() : loaded(false)
+{
+}
+
+void LazyApproximator::setFile(const std::string& path)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  source = [path]() {
+    return ApproximatorCache::getFile(path, [&path]() {
+      std::unique_ptr<rhoban_fa::FunctionApproximator> fa;
+      rhoban_fa::FunctionApproximatorFactory().loadFromFile(path, fa);
+      return std::unique_ptr<const rhoban_fa::FunctionApproximator>(std::move(fa));
+    });
+  };
+  char resolved[PATH_MAX];
+  source_id = "file:" + std::string(realpath(path.c_str(), resolved) != nullptr ? resolved : path);
+  source_files = { path };
+  approximator.reset();
+  loaded = false;
+}
+
+void LazyApproximator::setBinaryFromPath(const Json::Value& v, const std::string& dir_name)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  std::string content = dir_name + "\n" + v.toStyledString();
+  std::vector<std::string> paths;
+  getCandidatePaths(v, dir_name, &paths);
+  source = [v, dir_name, content, paths]() {
+    ApproximatorCache::Loader loader = [&v, &dir_name]() {
+      std::unique_ptr<rhoban_fa::FunctionApproximator> fa;
+      rhoban_fa::FunctionApproximatorFactory().tryLoadBinaryFromPath(v, dir_name, &fa);
+      return std::unique_ptr<const rhoban_fa::FunctionApproximator>(std::move(fa));
+    };
+    return ApproximatorCache::getContent(content, loader, getFilesVersion(paths));
+  };
+  source_id = "content:" + content;
+  source_files = paths;
+  approximator.reset();
+  loaded = false;
+}
+
+void LazyApproximator::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  source = Source();
+  source_id = "";
+  source_files.clear();
+  approximator.reset();
+  loaded = false;
+}
+
+bool LazyApproximator::isDefined() const
+{
+  return (bool)source;
+}
+
+std::string LazyApproximator::getSourceKey() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!source)
+  {
+    throw std::logic_error("LazyApproximator::getSourceKey: no source provided");
+  }
+  return source_id + "\n" + getFilesVersion(source_files);
+}
+
+bool LazyApproximator::isLoaded() const
+{
+  return loaded;
+}
+
+const rhoban_fa::FunctionApproximator& LazyApproximator::get() const
+{
+  if (!loaded.load(std::memory_order_acquire))
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded.load(std::memory_order_relaxed))
+    {
+      if (!source)
+      {
+        throw std::logic_error("LazyApproximator::get: no source provided");
+      }
+      approximator = source();
+      if (!approximator)
+      {
+        throw std::runtime_error("LazyApproximator::get: failed to load approximator");
+      }
+      loaded.store(true, std::memory_order_release);
+    }
+  }
+  return *approximator;
+}
+
+const rhoban_fa::FunctionApproximator* LazyApproximator::operator->() const
+{
+  return &get();
+}
+
+LazyApproximator::operator bool() const
+{
+  return isDefined();
+}
+
+}  // namespace csa_mdp
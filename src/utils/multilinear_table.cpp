@@ -0,0 +1,257 @@
+#include "utils/multilinear_table.h"
+
+#include "rhoban_random/tools.h"
+#include "rhoban_utils/threading/multi_core.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace csa_mdp
+{
+/// Above this number of active dimensions, the number of corners used for
+/// interpolation makes the table pointless
+static constexpr int MaxActiveDims = 16;
+
+/// Identifies the binary files written by MultilinearTable
+static const char FileMagic[4] = { 'M', 'L', 'T', '1' };
+
+MultilinearTable::MultilinearTable(const Eigen::MatrixXd& limits_, const std::vector<int>& nb_points_)
+  : limits(limits_), nb_points(nb_points_)
+{
+  int dim = limits.rows();
+  if (limits.cols() != 2 || (int)nb_points.size() != dim)
+  {
+    std::ostringstream oss;
+    oss << "MultilinearTable: invalid dimensions: limits " << limits.rows() << "x" << limits.cols() << ", nb_points "
+        << nb_points.size();
+    throw std::logic_error(oss.str());
+  }
+  steps = Eigen::VectorXd::Zero(dim);
+  strides.resize(dim);
+  long nb_values = 1;
+  for (int d = 0; d < dim; d++)
+  {
+    if (nb_points[d] < 1 || !(limits(d, 0) <= limits(d, 1)))
+    {
+      std::ostringstream oss;
+      oss << "MultilinearTable: invalid grid along dimension " << d << ": " << nb_points[d] << " points in ["
+          << limits(d, 0) << "," << limits(d, 1) << "]";
+      throw std::logic_error(oss.str());
+    }
+    strides[d] = nb_values;
+    nb_values *= nb_points[d];
+    if (nb_points[d] > 1)
+    {
+      steps(d) = (limits(d, 1) - limits(d, 0)) / (nb_points[d] - 1);
+      active_dims.push_back(d);
+    }
+  }
+  if ((int)active_dims.size() > MaxActiveDims || nb_values > std::numeric_limits<int>::max())
+  {
+    std::ostringstream oss;
+    oss << "MultilinearTable: grid is too large (" << active_dims.size() << " active dimensions, " << nb_values
+        << " values)";
+    throw std::logic_error(oss.str());
+  }
+  values.resize(nb_values, 0.0);
+}
+
+int MultilinearTable::getDim() const
+{
+  return limits.rows();
+}
+
+int MultilinearTable::getNbValues() const
+{
+  return values.size();
+}
+
+const Eigen::MatrixXd& MultilinearTable::getLimits() const
+{
+  return limits;
+}
+
+const std::vector<int>& MultilinearTable::getNbPoints() const
+{
+  return nb_points;
+}
+
+Eigen::VectorXd MultilinearTable::getGridPoint(int index) const
+{
+  Eigen::VectorXd point(getDim());
+  for (int d = 0; d < getDim(); d++)
+  {
+    int idx = (index / strides[d]) % nb_points[d];
+    if (nb_points[d] == 1)
+    {
+      point(d) = (limits(d, 0) + limits(d, 1)) / 2;
+    }
+    else
+    {
+      point(d) = limits(d, 0) + idx * steps(d);
+    }
+  }
+  return point;
+}
+
+void MultilinearTable::fill(Function f, int nb_threads)
+{
+  rhoban_utils::MultiCore::StochasticTask task = [this, &f](int start_idx, int end_idx, std::default_random_engine*) {
+    for (int idx = start_idx; idx < end_idx; idx++)
+    {
+      values[idx] = f(getGridPoint(idx));
+    }
+  };
+  // Engines are not used by the task
+  std::default_random_engine engine;
+  std::vector<std::default_random_engine> engines =
+      rhoban_random::getRandomEngines(std::max(1, std::min(nb_threads, getNbValues())), &engine);
+  rhoban_utils::MultiCore::runParallelStochasticTask(task, getNbValues(), &engines);
+}
+
+bool MultilinearTable::contains(const Eigen::Ref<const Eigen::VectorXd>& point) const
+{
+  for (int d = 0; d < getDim(); d++)
+  {
+    if (point(d) < limits(d, 0) || point(d) > limits(d, 1))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+double MultilinearTable::getValue(const Eigen::Ref<const Eigen::VectorXd>& point) const
+{
+  int nb_active = active_dims.size();
+  // Lower corner of the cell and position inside the cell along active dimensions
+  int base = 0;
+  double ratios[MaxActiveDims];
+  int offsets[MaxActiveDims];
+  for (int k = 0; k < nb_active; k++)
+  {
+    int d = active_dims[k];
+    double pos = (point(d) - limits(d, 0)) / steps(d);
+    pos = std::max(0.0, std::min((double)(nb_points[d] - 1), pos));
+    int idx = std::min((int)pos, nb_points[d] - 2);
+    ratios[k] = pos - idx;
+    offsets[k] = strides[d];
+    base += idx * strides[d];
+  }
+  // Weighted sum over the corners of the cell
+  double result = 0;
+  for (int corner = 0; corner < (1 << nb_active); corner++)
+  {
+    double weight = 1;
+    int offset = base;
+    for (int k = 0; k < nb_active; k++)
+    {
+      if (corner & (1 << k))
+      {
+        weight *= ratios[k];
+        offset += offsets[k];
+      }
+      else
+      {
+        weight *= 1 - ratios[k];
+      }
+    }
+    result += weight * values[offset];
+  }
+  return result;
+}
+
+void MultilinearTable::getError(Function f, int nb_samples, std::default_random_engine* engine, double* max_error,
+                                double* mean_error) const
+{
+  *max_error = 0;
+  *mean_error = 0;
+  if (nb_samples <= 0)
+  {
+    return;
+  }
+  Eigen::VectorXd point(getDim());
+  for (int sample = 0; sample < nb_samples; sample++)
+  {
+    for (int d = 0; d < getDim(); d++)
+    {
+      std::uniform_real_distribution<double> distrib(limits(d, 0), limits(d, 1));
+      point(d) = distrib(*engine);
+    }
+    double error = std::fabs(getValue(point) - f(point));
+    *max_error = std::max(*max_error, error);
+    *mean_error += error;
+  }
+  *mean_error /= nb_samples;
+}
+
+void MultilinearTable::save(const std::string& path) const
+{
+  std::ofstream out(path, std::ios::binary);
+  if (!out.good())
+  {
+    throw std::runtime_error("MultilinearTable::save: failed to open '" + path + "'");
+  }
+  int dim = getDim();
+  out.write(FileMagic, sizeof(FileMagic));
+  out.write((const char*)&dim, sizeof(int));
+  out.write((const char*)nb_points.data(), dim * sizeof(int));
+  for (int d = 0; d < dim; d++)
+  {
+    out.write((const char*)&limits(d, 0), sizeof(double));
+    out.write((const char*)&limits(d, 1), sizeof(double));
+  }
+  out.write((const char*)values.data(), values.size() * sizeof(double));
+  if (!out.good())
+  {
+    throw std::runtime_error("MultilinearTable::save: failed to write '" + path + "'");
+  }
+}
+
+bool MultilinearTable::tryLoad(const std::string& path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in.good())
+  {
+    return false;
+  }
+  char magic[sizeof(FileMagic)];
+  int dim;
+  in.read(magic, sizeof(magic));
+  in.read((char*)&dim, sizeof(int));
+  if (!in.good() || std::memcmp(magic, FileMagic, sizeof(FileMagic)) != 0 || dim != getDim())
+  {
+    return false;
+  }
+  std::vector<int> file_nb_points(dim);
+  in.read((char*)file_nb_points.data(), dim * sizeof(int));
+  if (!in.good() || file_nb_points != nb_points)
+  {
+    return false;
+  }
+  for (int d = 0; d < dim; d++)
+  {
+    double min, max;
+    in.read((char*)&min, sizeof(double));
+    in.read((char*)&max, sizeof(double));
+    if (!in.good() || min != limits(d, 0) || max != limits(d, 1))
+    {
+      return false;
+    }
+  }
+  std::vector<double> file_values(values.size());
+  in.read((char*)file_values.data(), file_values.size() * sizeof(double));
+  if (!in.good())
+  {
+    return false;
+  }
+  values = file_values;
+  return true;
+}
+
+}  // namespace csa_mdp
@@ -0,0 +1,105 @@
+#include "utils/ode_integrator.h"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace csa_mdp
+{
+OdeIntegrator::OdeIntegrator()
+  : method(Method::Euler), step(0.001), abs_tol(1e-6), rel_tol(1e-6), initial_step(0.01), min_step(1e-6)
+{
+}
+
+OdeIntegrator::Method OdeIntegrator::getMethod() const
+{
+  return method;
+}
+
+double OdeIntegrator::getStep() const
+{
+  return step;
+}
+
+void OdeIntegrator::setFixedStep(Method new_method, double new_step)
+{
+  if (new_method == Method::RK45 || new_step <= 0)
+  {
+    std::ostringstream oss;
+    oss << "OdeIntegrator::setFixedStep: invalid configuration: " << to_string(new_method) << " with step "
+        << new_step;
+    throw std::logic_error(oss.str());
+  }
+  method = new_method;
+  step = new_step;
+}
+
+std::string OdeIntegrator::getClassName() const
+{
+  return "OdeIntegrator";
+}
+
+Json::Value OdeIntegrator::toJson() const
+{
+  Json::Value v;
+  v["method"] = to_string(method);
+  v["step"] = step;
+  v["abs_tol"] = abs_tol;
+  v["rel_tol"] = rel_tol;
+  v["initial_step"] = initial_step;
+  v["min_step"] = min_step;
+  return v;
+}
+
+void OdeIntegrator::fromJson(const Json::Value& v, const std::string& dir_name)
+{
+  (void)dir_name;
+  std::string method_str;
+  rhoban_utils::tryRead(v, "method", &method_str);
+  if (method_str != "")
+  {
+    method = loadOdeIntegratorMethod(method_str);
+  }
+  rhoban_utils::tryRead(v, "step", &step);
+  rhoban_utils::tryRead(v, "abs_tol", &abs_tol);
+  rhoban_utils::tryRead(v, "rel_tol", &rel_tol);
+  rhoban_utils::tryRead(v, "initial_step", &initial_step);
+  rhoban_utils::tryRead(v, "min_step", &min_step);
+  if (step <= 0 || initial_step <= 0 || min_step <= 0 || abs_tol < 0 || rel_tol < 0 || abs_tol + rel_tol <= 0)
+  {
+    throw rhoban_utils::JsonParsingError("OdeIntegrator::fromJson: steps should be strictly positive and at least "
+                                         "one tolerance should be strictly positive");
+  }
+}
+
+std::string to_string(OdeIntegrator::Method method)
+{
+  switch (method)
+  {
+    case OdeIntegrator::Method::Euler:
+      return "euler";
+    case OdeIntegrator::Method::RK4:
+      return "rk4";
+    case OdeIntegrator::Method::RK45:
+      return "rk45";
+  }
+  throw std::runtime_error("to_string(OdeIntegrator::Method): unknown method");
+}
+
+OdeIntegrator::Method loadOdeIntegratorMethod(const std::string& str)
+{
+  if (str == "euler")
+  {
+    return OdeIntegrator::Method::Euler;
+  }
+  if (str == "rk4")
+  {
+    return OdeIntegrator::Method::RK4;
+  }
+  if (str == "rk45")
+  {
+    return OdeIntegrator::Method::RK45;
+  }
+  throw std::runtime_error("loadOdeIntegratorMethod: unknown method: '" + str + "'");
+}
+
+}  // namespace csa_mdp
@@ -0,0 +1,109 @@
+#include "utils/sin_cos.h"
+
+#include <cmath>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace csa_mdp
+{
+/// Process angles by groups of 4 using AVX2 instructions (if available)
+/// Return the number of angles processed
+static int sinCosAVX2(int n, const double* x, double* sin_x, double* cos_x);
+
+void sinCos(int n, const double* x, double* sin_x, double* cos_x)
+{
+  int start = sinCosAVX2(n, x, sin_x, cos_x);
+  for (int i = start; i < n; i++)
+  {
+    sin_x[i] = std::sin(x[i]);
+    cos_x[i] = std::cos(x[i]);
+  }
+}
+
+#ifdef __AVX2__
+int sinCosAVX2(int n, const double* x, double* sin_x, double* cos_x)
+{
+  // pi/2 split in three parts: n * pio2_1 and n * pio2_2 are exact for |n| < 2^20
+  const __m256d pio2_1 = _mm256_set1_pd(1.57079632673412561417e+00);
+  const __m256d pio2_2 = _mm256_set1_pd(6.07710050630396597660e-11);
+  const __m256d pio2_3 = _mm256_set1_pd(2.02226624879595063154e-21);
+  const __m256d two_over_pi = _mm256_set1_pd(6.36619772367581382433e-01);
+  const __m256d max_angle = _mm256_set1_pd(1e5);
+  const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffff));
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d half = _mm256_set1_pd(0.5);
+  // fdlibm kernels on [-pi/4, pi/4]
+  const __m256d s1 = _mm256_set1_pd(-1.66666666666666324348e-01);
+  const __m256d s2 = _mm256_set1_pd(8.33333333332248946124e-03);
+  const __m256d s3 = _mm256_set1_pd(-1.98412698298579493134e-04);
+  const __m256d s4 = _mm256_set1_pd(2.75573137070700676789e-06);
+  const __m256d s5 = _mm256_set1_pd(-2.50507602534068634195e-08);
+  const __m256d s6 = _mm256_set1_pd(1.58969099521155010221e-10);
+  const __m256d c1 = _mm256_set1_pd(4.16666666666666019037e-02);
+  const __m256d c2 = _mm256_set1_pd(-1.38888888888741095749e-03);
+  const __m256d c3 = _mm256_set1_pd(2.48015872894767294178e-05);
+  const __m256d c4 = _mm256_set1_pd(-2.75573143513906633035e-07);
+  const __m256d c5 = _mm256_set1_pd(2.08757232129817482790e-09);
+  const __m256d c6 = _mm256_set1_pd(-1.13596475577881948265e-11);
+  const __m256i int_one = _mm256_set1_epi64x(1);
+  const __m256i int_two = _mm256_set1_epi64x(2);
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m256d a = _mm256_loadu_pd(x + i);
+    // Not finite or too large: scalar version (NaN fails the comparison)
+    __m256d valid = _mm256_cmp_pd(_mm256_and_pd(a, abs_mask), max_angle, _CMP_LE_OQ);
+    if (_mm256_movemask_pd(valid) != 0xF)
+    {
+      for (int lane = 0; lane < 4; lane++)
+      {
+        sin_x[i + lane] = std::sin(x[i + lane]);
+        cos_x[i + lane] = std::cos(x[i + lane]);
+      }
+      continue;
+    }
+    // a = q * pi/2 + r with r in [-pi/4, pi/4]
+    __m256d q = _mm256_round_pd(_mm256_mul_pd(a, two_over_pi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(a, _mm256_mul_pd(q, pio2_1));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(q, pio2_2));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(q, pio2_3));
+    __m256d z = _mm256_mul_pd(r, r);
+    __m256d ps = _mm256_add_pd(s5, _mm256_mul_pd(z, s6));
+    ps = _mm256_add_pd(s4, _mm256_mul_pd(z, ps));
+    ps = _mm256_add_pd(s3, _mm256_mul_pd(z, ps));
+    ps = _mm256_add_pd(s2, _mm256_mul_pd(z, ps));
+    ps = _mm256_add_pd(s1, _mm256_mul_pd(z, ps));
+    __m256d sin_r = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(z, r), ps));
+    __m256d pc = _mm256_add_pd(c5, _mm256_mul_pd(z, c6));
+    pc = _mm256_add_pd(c4, _mm256_mul_pd(z, pc));
+    pc = _mm256_add_pd(c3, _mm256_mul_pd(z, pc));
+    pc = _mm256_add_pd(c2, _mm256_mul_pd(z, pc));
+    pc = _mm256_add_pd(c1, _mm256_mul_pd(z, pc));
+    __m256d cos_r = _mm256_add_pd(_mm256_sub_pd(one, _mm256_mul_pd(half, z)), _mm256_mul_pd(_mm256_mul_pd(z, z), pc));
+    // Quadrant: odd quadrants swap sine and cosine, signs depend on bit 1 of q and q + 1
+    __m256i quadrant = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(q));
+    __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(quadrant, int_one), int_one));
+    __m256d sin_sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(quadrant, int_two), 62));
+    __m256d cos_sign =
+        _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(quadrant, int_one), int_two), 62));
+    __m256d res_sin = _mm256_xor_pd(_mm256_blendv_pd(sin_r, cos_r, swap), sin_sign);
+    __m256d res_cos = _mm256_xor_pd(_mm256_blendv_pd(cos_r, sin_r, swap), cos_sign);
+    _mm256_storeu_pd(sin_x + i, res_sin);
+    _mm256_storeu_pd(cos_x + i, res_cos);
+  }
+  return i;
+}
+#else
+int sinCosAVX2(int n, const double* x, double* sin_x, double* cos_x)
+{
+  (void)n;
+  (void)x;
+  (void)sin_x;
+  (void)cos_x;
+  return 0;
+}
+#endif
+
+}  // namespace csa_mdp
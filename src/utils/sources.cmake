@@ -0,0 +1,8 @@
+set(SOURCES
+  disk_sampling.cpp
+  lazy_approximator.cpp
+  multilinear_table.cpp
+  ode_integrator.cpp
+  sin_cos.cpp
+  ziggurat_normal.cpp
+)
@@ -0,0 +1,108 @@
+#include "utils/ziggurat_normal.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace csa_mdp
+{
+/// Range of the signed integers used by the method
+static constexpr double IntRange = 1073741824.0;  // 2^30
+/// Start of the tail of the distribution
+static constexpr double TailStart = 3.442619855899;
+/// Area of each layer
+static constexpr double LayerArea = 9.91256303526217e-3;
+
+ZigguratNormal::Tables::Tables()
+{
+  double dn = TailStart;
+  double tn = dn;
+  double q = LayerArea / std::exp(-0.5 * dn * dn);
+  k[0] = (unsigned int)((dn / q) * IntRange);
+  k[1] = 0;
+  w[0] = q / IntRange;
+  w[127] = dn / IntRange;
+  f[0] = 1.0;
+  f[127] = std::exp(-0.5 * dn * dn);
+  for (int i = 126; i >= 1; i--)
+  {
+    dn = std::sqrt(-2.0 * std::log(LayerArea / dn + std::exp(-0.5 * dn * dn)));
+    k[i + 1] = (unsigned int)((dn / tn) * IntRange);
+    tn = dn;
+    f[i] = std::exp(-0.5 * dn * dn);
+    w[i] = dn / IntRange;
+  }
+}
+
+double ZigguratNormal::sample(std::default_random_engine* engine)
+{
+  return sample(getTables(), engine);
+}
+
+void ZigguratNormal::fill(double* dst, int nb_samples, std::default_random_engine* engine)
+{
+  const Tables& tables = getTables();
+  for (int idx = 0; idx < nb_samples; idx++)
+  {
+    dst[idx] = sample(tables, engine);
+  }
+}
+
+const ZigguratNormal::Tables& ZigguratNormal::getTables()
+{
+  static Tables tables;
+  return tables;
+}
+
+double ZigguratNormal::sample(const Tables& tables, std::default_random_engine* engine)
+{
+  int hz = drawInt(engine);
+  int iz = hz & 127;
+  if ((unsigned int)std::abs(hz) < tables.k[iz])
+  {
+    return hz * tables.w[iz];
+  }
+  return sampleSlow(tables, hz, iz, engine);
+}
+
+double ZigguratNormal::sampleSlow(const Tables& tables, int hz, int iz, std::default_random_engine* engine)
+{
+  while (true)
+  {
+    double x = hz * tables.w[iz];
+    if (iz == 0)
+    {
+      // Sampling from the tail
+      double y;
+      do
+      {
+        x = -std::log(drawUniform(engine)) / TailStart;
+        y = -std::log(drawUniform(engine));
+      } while (y + y < x * x);
+      return hz > 0 ? TailStart + x : -TailStart - x;
+    }
+    // Sampling inside the wedge
+    if (tables.f[iz] + drawUniform(engine) * (tables.f[iz - 1] - tables.f[iz]) < std::exp(-0.5 * x * x))
+    {
+      return x;
+    }
+    hz = drawInt(engine);
+    iz = hz & 127;
+    if ((unsigned int)std::abs(hz) < tables.k[iz])
+    {
+      return hz * tables.w[iz];
+    }
+  }
+}
+
+int ZigguratNormal::drawInt(std::default_random_engine* engine)
+{
+  return (int)((*engine)() - std::default_random_engine::min()) - (1 << 30);
+}
+
+double ZigguratNormal::drawUniform(std::default_random_engine* engine)
+{
+  double range = (double)std::default_random_engine::max() - std::default_random_engine::min() + 1;
+  return ((*engine)() - std::default_random_engine::min() + 0.5) / range;
+}
+
+}  // namespace csa_mdp
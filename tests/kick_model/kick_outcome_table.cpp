@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+#include <kick_model/kick_model_collection.h>
+#include <kick_model/kick_outcome_table.h>
+
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace csa_mdp;
+
+/// Number of samples used for the statistical tests
+static const int NbSamples = 200000;
+
+/// Tolerance of the statistical tests in number of standard errors, tests are
+/// deterministic since engines are seeded
+static const double NbStdErrors = 5;
+
+/// Cumulative distribution function of the standard normal law
+static double normalCDF(double x)
+{
+  return 0.5 * std::erfc(-x / M_SQRT2);
+}
+
+TEST(normalQuantile, knownValues)
+{
+  EXPECT_NEAR(0, KickOutcomeTable::normalQuantile(0.5), 1e-15);
+  EXPECT_NEAR(1.959963984540054, KickOutcomeTable::normalQuantile(0.975), 1e-14);
+  EXPECT_NEAR(-1.959963984540054, KickOutcomeTable::normalQuantile(0.025), 1e-14);
+  EXPECT_NEAR(1, KickOutcomeTable::normalQuantile(0.8413447460685429), 1e-14);
+  // Tails
+  EXPECT_NEAR(-4.753424308822899, KickOutcomeTable::normalQuantile(1e-6), 1e-12);
+  EXPECT_NEAR(-6.361340902404056, KickOutcomeTable::normalQuantile(1e-10), 1e-12);
+  EXPECT_NEAR(4.753424308822899, KickOutcomeTable::normalQuantile(1 - 1e-6), 1e-9);
+}
+
+TEST(normalQuantile, invertsCDF)
+{
+  std::vector<double> probabilities;
+  for (double log_p = -300; log_p <= std::log10(0.5); log_p += 0.25)
+  {
+    probabilities.push_back(std::pow(10, log_p));
+  }
+  // Both sides of the switch between the central and the tail approximations
+  for (double p : { 0.02424, 0.02425, 0.02426, 0.5 })
+  {
+    probabilities.push_back(p);
+  }
+  for (double p : probabilities)
+  {
+    EXPECT_NEAR(p, normalCDF(KickOutcomeTable::normalQuantile(p)), 1e-12 * p) << "p: " << p;
+    // Upper tail, accuracy is limited by the representation of 1-p
+    if (p > 1e-15)
+    {
+      double q = 1 - p;
+      EXPECT_NEAR(q, normalCDF(KickOutcomeTable::normalQuantile(q)), 1e-12 * q) << "q: " << q;
+      EXPECT_NEAR(-KickOutcomeTable::normalQuantile(p), KickOutcomeTable::normalQuantile(q), 1e-15 / p)
+          << "p: " << p;
+    }
+  }
+}
+
+TEST(normalQuantile, invalidProbabilities)
+{
+  EXPECT_THROW(KickOutcomeTable::normalQuantile(0), std::logic_error);
+  EXPECT_THROW(KickOutcomeTable::normalQuantile(1), std::logic_error);
+  EXPECT_THROW(KickOutcomeTable::normalQuantile(-0.5), std::logic_error);
+}
+
+/// Kick model recording the quantiles used to build its outcomes
+class RecordingKick : public KickModel
+{
+public:
+  Eigen::Vector2d getKickInSelf(const Eigen::Vector2d& ball_pos, bool right_kick) const override
+  {
+    (void)right_kick;
+    return ball_pos;
+  }
+
+  Eigen::Vector2d applyKick(const Eigen::Vector2d& ball_pos, double kick_dir, const Eigen::VectorXd& kick_parameters,
+                            std::default_random_engine* engine) const override
+  {
+    (void)kick_dir;
+    (void)kick_parameters;
+    (void)engine;
+    return ball_pos;
+  }
+
+  int getNbNoiseSources() const override
+  {
+    return 3;
+  }
+
+  Eigen::Vector2d getOutcomeFromQuantiles(const Eigen::VectorXd& q) const override
+  {
+    quantiles.push_back(q);
+    return Eigen::Vector2d(1, 0);
+  }
+
+  std::string getClassName() const override
+  {
+    return "RecordingKick";
+  }
+
+  KickModel* clone() const override
+  {
+    return new RecordingKick(*this);
+  }
+
+  mutable std::vector<Eigen::VectorXd> quantiles;
+};
+
+TEST(build, latinHypercubeStratification)
+{
+  int nb_samples = 1000;
+  RecordingKick kick;
+  KickOutcomeTable table;
+  std::default_random_engine engine;
+  table.build(kick, GrassModel(), nb_samples, 3600, &engine);
+  ASSERT_EQ(nb_samples, table.size());
+  ASSERT_EQ(nb_samples, (int)kick.quantiles.size());
+  // Each stratum of each source is used exactly once, at its center
+  for (int source = 0; source < 3; source++)
+  {
+    std::vector<double> values;
+    for (const Eigen::VectorXd& q : kick.quantiles)
+    {
+      values.push_back(q(source));
+    }
+    std::sort(values.begin(), values.end());
+    for (int i = 0; i < nb_samples; i++)
+    {
+      EXPECT_DOUBLE_EQ((i + 0.5) / nb_samples, values[i]) << "source " << source;
+    }
+  }
+  // Sources are shuffled independently: the correlation between the quantiles
+  // of two sources is close to 0 (standard error: 1 / sqrt(n))
+  for (int s1 = 0; s1 < 3; s1++)
+  {
+    for (int s2 = s1 + 1; s2 < 3; s2++)
+    {
+      double sum = 0;
+      for (const Eigen::VectorXd& q : kick.quantiles)
+      {
+        sum += (q(s1) - 0.5) * (q(s2) - 0.5);
+      }
+      // Variance of a uniform variable on [0,1] is 1/12
+      double correlation = 12 * sum / nb_samples;
+      EXPECT_NEAR(0, correlation, NbStdErrors / std::sqrt(nb_samples)) << "sources " << s1 << ", " << s2;
+    }
+  }
+}
+
+/// Collection with a single noisy kick and a grass cone slowing kicks toward
+/// positive directions, outcome tables are used if nb_outcome_samples > 0
+static void buildCollection(int nb_outcome_samples, KickModelCollection* kmc)
+{
+  Json::Value kick;
+  kick["class name"] = "ClassicKick";
+  kick["content"]["kick_zone"]["kick_theta_tol"] = 10;
+  kick["content"]["kick_zone"]["kick_theta_offset"] = 0;
+  kick["content"]["kick_power"] = 3;
+  kick["content"]["right_kick_dir"] = 0;
+  kick["content"]["rel_dist_stddev"] = 0.1;
+  kick["content"]["dir_stddev"] = 10;
+  Json::Value v;
+  v["map"]["classic"] = kick;
+  v["grassModel"]["ratio"] = 0.5;
+  v["grassModel"]["coneWidth"] = 60;
+  v["grassModel"]["coneOffset"] = 45;
+  v["nb_outcome_samples"] = nb_outcome_samples;
+  v["outcome_seed"] = 3;
+  kmc->fromJson(v, ".");
+}
+
+/// Mean and covariance of the final position of the ball
+static void getMoments(const KickModel& kick, const Eigen::Vector2d& ball_pos, double kick_dir, Eigen::Vector2d* mean,
+                       Eigen::Matrix2d* covariance)
+{
+  std::default_random_engine engine;
+  Eigen::Vector2d sum = Eigen::Vector2d::Zero();
+  Eigen::Matrix2d sum2 = Eigen::Matrix2d::Zero();
+  for (int sample = 0; sample < NbSamples; sample++)
+  {
+    Eigen::Vector2d pos = kick.applyKick(ball_pos, kick_dir, &engine);
+    sum += pos;
+    sum2 += pos * pos.transpose();
+  }
+  *mean = sum / NbSamples;
+  *covariance = sum2 / NbSamples - (*mean) * mean->transpose();
+}
+
+TEST(applyKick, matchesMonteCarlo)
+{
+  // The table is a finite sample of the outcomes, it adds its own error
+  int nb_outcomes = 100000;
+  KickModelCollection table_kmc, mc_kmc;
+  buildCollection(nb_outcomes, &table_kmc);
+  buildCollection(0, &mc_kmc);
+  const KickModel& table_kick = table_kmc.getKickModel("classic");
+  const KickModel& mc_kick = mc_kmc.getKickModel("classic");
+  Eigen::Vector2d ball_pos(1, -2);
+  // Directions outside of the cone, inside and on its boundaries
+  for (double kick_dir_deg : { -150.0, 0.0, 15.0, 45.0, 75.0, 179.0 })
+  {
+    double kick_dir = kick_dir_deg * M_PI / 180;
+    Eigen::Vector2d table_mean, mc_mean;
+    Eigen::Matrix2d table_cov, mc_cov;
+    getMoments(table_kick, ball_pos, kick_dir, &table_mean, &table_cov);
+    getMoments(mc_kick, ball_pos, kick_dir, &mc_mean, &mc_cov);
+    // Errors come from both samplings and from the content of the table
+    double error_factor = 2.0 / NbSamples + 1.0 / nb_outcomes;
+    for (int dim = 0; dim < 2; dim++)
+    {
+      double tolerance = NbStdErrors * std::sqrt(mc_cov(dim, dim) * error_factor);
+      EXPECT_NEAR(mc_mean(dim), table_mean(dim), tolerance) << "kick_dir: " << kick_dir_deg << ", dim " << dim;
+    }
+    for (int row = 0; row < 2; row++)
+    {
+      for (int col = 0; col < 2; col++)
+      {
+        // Variance of the empirical covariance for a gaussian distribution
+        double cov_variance = mc_cov(row, row) * mc_cov(col, col) + mc_cov(row, col) * mc_cov(row, col);
+        double tolerance = NbStdErrors * std::sqrt(cov_variance * error_factor);
+        EXPECT_NEAR(mc_cov(row, col), table_cov(row, col), tolerance)
+            << "kick_dir: " << kick_dir_deg << ", cov(" << row << "," << col << ")";
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
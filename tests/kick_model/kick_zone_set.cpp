@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <kick_model/kick_zone_set.h>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+using namespace csa_mdp;
+
+/// Build a kick zone with the given orientation properties [deg]
+static KickZone buildZone(double theta_offset, double theta_tol)
+{
+  Json::Value v;
+  v["kick_theta_offset"] = theta_offset;
+  v["kick_theta_tol"] = theta_tol;
+  KickZone zone;
+  zone.fromJson(v, "");
+  return zone;
+}
+
+TEST(getKickableZone, matchesKickZones)
+{
+  // Some of the tolerances are crossing the [-pi, pi] discontinuity
+  std::vector<KickZone> zones = { buildZone(0, 10), buildZone(90, 60), buildZone(170, 30), buildZone(45, 200) };
+  KickZoneSet zone_set;
+  for (const KickZone& zone : zones)
+  {
+    zone_set.add(zone);
+  }
+  std::default_random_engine engine;
+  std::uniform_real_distribution<double> x_distrib(0.1, 0.25), y_distrib(-0.15, 0.15), theta_distrib(-10, 10);
+  for (int sample = 0; sample < 100000; sample++)
+  {
+    Eigen::Vector3d state(x_distrib(engine), y_distrib(engine), theta_distrib(engine));
+    int expected_zone = -1;
+    for (size_t zone_id = 0; zone_id < zones.size(); zone_id++)
+    {
+      if (zones[zone_id].isKickable(state))
+      {
+        expected_zone = zone_id;
+        break;
+      }
+    }
+    EXPECT_EQ(expected_zone, zone_set.getKickableZone(state));
+    EXPECT_EQ(expected_zone >= 0, zone_set.isKickable(state));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <kick_model/rolling_ball_model.h>
+
+#include <cmath>
+
+#define EPSILON std::pow(10, -9)
+
+using namespace csa_mdp;
+
+static RollingBallModel buildModel(double decay_rate)
+{
+  Json::Value v;
+  v["decay_rate"] = decay_rate;
+  RollingBallModel model;
+  model.fromJson(v, "");
+  return model;
+}
+
+TEST(getNextState, composition)
+{
+  for (double decay_rate : { 0.5, 1.0 })
+  {
+    RollingBallModel model = buildModel(decay_rate);
+    Eigen::Vector4d ball_state(0.2, -0.1, 0.5, 0.3);
+    Eigen::Vector4d single = model.getNextState(ball_state, 2.0);
+    Eigen::Vector4d successive = ball_state;
+    for (int step = 0; step < 20; step++)
+    {
+      successive = model.getNextState(successive, 0.1);
+    }
+    for (int dim = 0; dim < 4; dim++)
+    {
+      EXPECT_NEAR(single(dim), successive(dim), EPSILON);
+    }
+  }
+}
+
+TEST(getLineIntercept, consistentWithGetNextState)
+{
+  RollingBallModel model = buildModel(0.5);
+  Eigen::Vector4d ball_state(0, 0, 1, 0.5);
+  double time;
+  Eigen::Vector2d position;
+  // Ball travels 2 [m] along x before stopping
+  ASSERT_TRUE(model.getLineIntercept(ball_state, Eigen::Vector2d(1, 0), Eigen::Vector2d(-1, 0), &time, &position));
+  Eigen::Vector4d next_state = model.getNextState(ball_state, time);
+  EXPECT_NEAR(1, position(0), EPSILON);
+  EXPECT_NEAR(next_state(0), position(0), EPSILON);
+  EXPECT_NEAR(next_state(1), position(1), EPSILON);
+  EXPECT_FALSE(model.getLineIntercept(ball_state, Eigen::Vector2d(2.5, 0), Eigen::Vector2d(1, 0), &time, &position));
+  EXPECT_FALSE(model.getLineIntercept(ball_state, Eigen::Vector2d(-1, 0), Eigen::Vector2d(1, 0), &time, &position));
+}
+
+TEST(getCircleIntercept, consistentWithGetNextState)
+{
+  RollingBallModel model = buildModel(0.5);
+  Eigen::Vector4d ball_state(0, 0, 1, 0);
+  Eigen::Vector2d center(1.5, 0.1);
+  double radius = 0.2;
+  double time;
+  Eigen::Vector2d position;
+  ASSERT_TRUE(model.getCircleIntercept(ball_state, center, radius, &time, &position));
+  Eigen::Vector4d next_state = model.getNextState(ball_state, time);
+  EXPECT_NEAR(radius, (position - center).norm(), EPSILON);
+  EXPECT_NEAR(next_state(0), position(0), EPSILON);
+  EXPECT_NEAR(next_state(1), position(1), EPSILON);
+  // Circle out of reach or not on the trajectory
+  EXPECT_FALSE(model.getCircleIntercept(ball_state, Eigen::Vector2d(2.5, 0), radius, &time, &position));
+  EXPECT_FALSE(model.getCircleIntercept(ball_state, Eigen::Vector2d(1, 1), radius, &time, &position));
+  // Already inside
+  EXPECT_TRUE(model.getCircleIntercept(ball_state, Eigen::Vector2d(0.1, 0), radius, &time, &position));
+  EXPECT_EQ(0, time);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
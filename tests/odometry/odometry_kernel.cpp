@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <odometry/odometry_kernel.h>
+
+#include <cmath>
+#include <vector>
+
+#define EPSILON std::pow(10, -12)
+
+using namespace csa_mdp;
+
+static const std::vector<OdometryDisplacementModel::Type> displacement_types = {
+  OdometryDisplacementModel::DisplacementIdentity,        OdometryDisplacementModel::DisplacementProportionalXY,
+  OdometryDisplacementModel::DisplacementProportionalXYA, OdometryDisplacementModel::DisplacementLinearSimpleXY,
+  OdometryDisplacementModel::DisplacementLinearSimpleXYA, OdometryDisplacementModel::DisplacementLinearFullXY,
+  OdometryDisplacementModel::DisplacementLinearFullXYA
+};
+
+static const std::vector<OdometryNoiseModel::Type> noise_types = {
+  OdometryNoiseModel::NoiseDisable, OdometryNoiseModel::NoiseConstant, OdometryNoiseModel::NoiseProportional,
+  OdometryNoiseModel::NoiseLinearSimple, OdometryNoiseModel::NoiseLinearFull
+};
+
+/// Parameters drawn uniformly inside the limits of the model
+template <class M>
+static void setRandomParameters(M* model, std::default_random_engine* engine)
+{
+  Eigen::MatrixXd limits = model->getParametersLimits();
+  Eigen::VectorXd params(limits.rows());
+  for (int i = 0; i < limits.rows(); i++)
+  {
+    std::uniform_real_distribution<double> distrib(limits(i, 0), limits(i, 1));
+    params(i) = distrib(*engine);
+  }
+  ASSERT_EQ(0, model->setParameters(params));
+}
+
+static Eigen::Vector3d randomDeltaPose(std::default_random_engine* engine)
+{
+  std::uniform_real_distribution<double> cart_distrib(-0.1, 0.1), angular_distrib(-0.5, 0.5);
+  return Eigen::Vector3d(cart_distrib(*engine), cart_distrib(*engine), angular_distrib(*engine));
+}
+
+TEST(getDiff, correctionMatchesDisplacementModel)
+{
+  std::default_random_engine engine;
+  for (OdometryDisplacementModel::Type type : displacement_types)
+  {
+    OdometryDisplacementModel displacement(type);
+    OdometryNoiseModel noise(OdometryNoiseModel::NoiseConstant);
+    for (int trial = 0; trial < 100; trial++)
+    {
+      setRandomParameters(&displacement, &engine);
+      std::unique_ptr<OdometryKernel> kernel = OdometryKernel::build(displacement, noise);
+      Eigen::Vector3d delta_pose = randomDeltaPose(&engine);
+      // Without engine, no noise is applied
+      Eigen::Vector3d expected = displacement.displacementCorrection(delta_pose);
+      Eigen::Vector3d received = kernel->getDiff(delta_pose, nullptr);
+      for (int dim = 0; dim < 3; dim++)
+      {
+        EXPECT_NEAR(expected(dim), received(dim), EPSILON) << "displacement type " << type;
+      }
+    }
+  }
+}
+
+/// The kernel draws different samples than OdometryNoiseModel, therefore the
+/// mean and the variance of the noise are compared with their expected values
+TEST(getDiff, noiseMatchesNoiseModelStatistics)
+{
+  std::default_random_engine engine;
+  int nb_samples = 100000;
+  double nb_std_errors = 5;
+  for (OdometryDisplacementModel::Type displacement_type : displacement_types)
+  {
+    for (OdometryNoiseModel::Type noise_type : noise_types)
+    {
+      OdometryDisplacementModel displacement(displacement_type);
+      OdometryNoiseModel noise(noise_type);
+      setRandomParameters(&displacement, &engine);
+      setRandomParameters(&noise, &engine);
+      std::unique_ptr<OdometryKernel> kernel = OdometryKernel::build(displacement, noise);
+      Eigen::Vector3d delta_pose = randomDeltaPose(&engine);
+      Eigen::Vector3d correction = displacement.displacementCorrection(delta_pose);
+      Eigen::Vector3d variance = noise.getVariance(correction);
+      Eigen::Vector3d sum = Eigen::Vector3d::Zero(), sum2 = Eigen::Vector3d::Zero();
+      for (int sample = 0; sample < nb_samples; sample++)
+      {
+        Eigen::Vector3d error = kernel->getDiff(delta_pose, &engine) - correction;
+        sum += error;
+        sum2 += error.cwiseProduct(error);
+      }
+      for (int dim = 0; dim < 3; dim++)
+      {
+        double mean = sum(dim) / nb_samples;
+        double empirical_variance = sum2(dim) / nb_samples - mean * mean;
+        double stddev = std::sqrt(variance(dim));
+        // Noise is gaussian: Var(x^2) = 2 sigma^4
+        EXPECT_NEAR(0, mean, nb_std_errors * stddev / std::sqrt(nb_samples) + EPSILON)
+            << "types " << displacement_type << ", " << noise_type << ", dim " << dim;
+        EXPECT_NEAR(variance(dim), empirical_variance,
+                    nb_std_errors * std::sqrt(2.0 / nb_samples) * variance(dim) + EPSILON)
+            << "types " << displacement_type << ", " << noise_type << ", dim " << dim;
+      }
+    }
+  }
+}
+
+TEST(getDiffs, sameAsSuccessiveGetDiff)
+{
+  std::default_random_engine engine;
+  int n = 100;
+  for (OdometryDisplacementModel::Type displacement_type : displacement_types)
+  {
+    for (OdometryNoiseModel::Type noise_type : noise_types)
+    {
+      OdometryDisplacementModel displacement(displacement_type);
+      OdometryNoiseModel noise(noise_type);
+      setRandomParameters(&displacement, &engine);
+      setRandomParameters(&noise, &engine);
+      std::unique_ptr<OdometryKernel> kernel = OdometryKernel::build(displacement, noise);
+      Eigen::MatrixXd delta_poses(3, n), diffs(3, n);
+      for (int col = 0; col < n; col++)
+      {
+        delta_poses.col(col) = randomDeltaPose(&engine);
+      }
+      std::default_random_engine batch_engine(1), scalar_engine(1);
+      kernel->getDiffs(delta_poses, &batch_engine, &diffs);
+      for (int col = 0; col < n; col++)
+      {
+        Eigen::Vector3d diff = kernel->getDiff(delta_poses.col(col), &scalar_engine);
+        for (int dim = 0; dim < 3; dim++)
+        {
+          EXPECT_EQ(diff(dim), diffs(dim, col)) << "types " << displacement_type << ", " << noise_type;
+        }
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
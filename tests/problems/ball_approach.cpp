@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <problems/ball_approach.h>
+
+#include "batch_successors.h"
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#define EPSILON std::pow(10, -9)
+
+using namespace csa_mdp;
+
+/// Build a noisy approach problem with a single kick zone
+static BallApproach buildProblem()
+{
+  BallApproach ball_approach;
+  ball_approach.addKickZone(KickZone());
+  ball_approach.setOdometry(
+      Odometry(OdometryDisplacementModel::DisplacementProportionalXYA, OdometryNoiseModel::NoiseConstant));
+  return ball_approach;
+}
+
+/// Default odometry is the identity without noise: the command is applied as
+/// is, rotation first
+TEST(getSuccessor, noiselessStep)
+{
+  BallApproach problem;
+  problem.addKickZone(KickZone());
+  Eigen::VectorXd state(6), action(4);
+  // Ball 1 [m] ahead, target at 0.5 [rad], walking forward
+  state << 1, 0, 0.5, 0.02, 0, 0;
+  // Forward acceleration is bounded by max_step_x_diff
+  action << 0, 0.05, -0.005, 0.1;
+  Eigen::Vector3d cmd(0.03, -0.005, 0.1);
+  double ball_x = std::cos(-0.1) - cmd(0);
+  double ball_y = std::sin(-0.1) - cmd(1);
+  Eigen::VectorXd expected_successor(6);
+  expected_successor << std::sqrt(ball_x * ball_x + ball_y * ball_y), std::atan2(ball_y, ball_x), 0.4, cmd;
+  // Time spent for a step, the ball is visible and too far to be kicked
+  double expected_reward = -1 / (2 * 1.7);
+  std::default_random_engine engine;
+  Problem::Result r = problem.getSuccessor(state, action, &engine);
+  Eigen::MatrixXd successors(6, 1);
+  Eigen::VectorXd rewards(1);
+  Eigen::Array<bool, -1, 1> terminal(1);
+  for (bool strict : { true, false })
+  {
+    problem.getSuccessors(state, action, &engine, &successors, &rewards, &terminal, strict);
+    for (int dim = 0; dim < 6; dim++)
+    {
+      EXPECT_NEAR(expected_successor(dim), r.successor(dim), EPSILON) << "dim " << dim;
+      EXPECT_NEAR(expected_successor(dim), successors(dim, 0), EPSILON) << "dim " << dim << ", strict: " << strict;
+    }
+    EXPECT_NEAR(expected_reward, r.reward, EPSILON);
+    EXPECT_NEAR(expected_reward, rewards(0), EPSILON);
+    EXPECT_FALSE(r.terminal);
+    EXPECT_FALSE(terminal(0));
+  }
+}
+
+TEST(getSuccessors, strictIsIdenticalToGetSuccessor)
+{
+  checkBatchSuccessors(buildProblem(), 1000, true, 0);
+}
+
+TEST(getSuccessors, fastIsCloseToGetSuccessor)
+{
+  checkBatchSuccessors(buildProblem(), 1000, false, EPSILON);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <problems/ball_exit_kernel.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#define EPSILON std::pow(10, -12)
+
+using namespace csa_mdp;
+
+/// Field and goalie dimensions are exactly representable, therefore segments
+/// ending on a boundary are not affected by rounding errors
+static BallExitKernel buildKernel(bool use_goalie)
+{
+  BallExitKernel kernel;
+  // Field bounds: x in [-4.5625, 4.5625], y in [-3.0625, 3.0625], goal line at 4.5
+  kernel.setField(9, 6, 2.5, 0.0625);
+  // Goalie bounds: x in [4, 4.25], y in [-0.3125, 0.3125]
+  kernel.setGoalie(use_goalie, 4.125, 0, 0.125, 0.5);
+  return kernel;
+}
+
+/// Process all the segments with the batch version and compare the results
+/// with the single segment version. The number of segments is not a multiple
+/// of 4, therefore both the AVX2 path (if available) and the scalar remainder
+/// are used by the batch version
+static void checkBatch(const BallExitKernel& kernel, const std::vector<double>& src_x,
+                       const std::vector<double>& src_y, const std::vector<double>& dst_x,
+                       const std::vector<double>& dst_y)
+{
+  int n = src_x.size();
+  std::vector<double> batch_x = dst_x, batch_y = dst_y;
+  std::vector<BallExitKernel::Event> events(n);
+  kernel.process(n, src_x.data(), src_y.data(), batch_x.data(), batch_y.data(), events.data());
+  for (int i = 0; i < n; i++)
+  {
+    double scalar_x = dst_x[i], scalar_y = dst_y[i];
+    BallExitKernel::Event event = kernel.process(src_x[i], src_y[i], &scalar_x, &scalar_y);
+    EXPECT_EQ(event, events[i]) << "segment " << i << ": (" << src_x[i] << ", " << src_y[i] << ") -> (" << dst_x[i]
+                                << ", " << dst_y[i] << ")";
+    EXPECT_NEAR(scalar_x, batch_x[i], EPSILON);
+    EXPECT_NEAR(scalar_y, batch_y[i], EPSILON);
+  }
+}
+
+static void checkRandomSegments(bool use_goalie)
+{
+  BallExitKernel kernel = buildKernel(use_goalie);
+  std::default_random_engine engine;
+  // Segments start inside the field and might end far outside of it
+  std::uniform_real_distribution<double> src_x_distrib(-4.5, 4.5), src_y_distrib(-3, 3);
+  std::uniform_real_distribution<double> move_distrib(-6, 6);
+  int n = 10003;
+  std::vector<double> src_x(n), src_y(n), dst_x(n), dst_y(n);
+  for (int i = 0; i < n; i++)
+  {
+    src_x[i] = src_x_distrib(engine);
+    src_y[i] = src_y_distrib(engine);
+    dst_x[i] = src_x[i] + move_distrib(engine);
+    dst_y[i] = src_y[i] + move_distrib(engine);
+  }
+  checkBatch(kernel, src_x, src_y, dst_x, dst_y);
+}
+
+TEST(process, batchMatchesScalarOnRandomSegments)
+{
+  checkRandomSegments(false);
+  checkRandomSegments(true);
+}
+
+static void checkBoundarySegments(bool use_goalie)
+{
+  BallExitKernel kernel = buildKernel(use_goalie);
+  std::vector<double> src_x, src_y, dst_x, dst_y;
+  auto add = [&](double sx, double sy, double ex, double ey) {
+    src_x.push_back(sx);
+    src_y.push_back(sy);
+    dst_x.push_back(ex);
+    dst_y.push_back(ey);
+  };
+  // Ending exactly on each side of the field
+  add(0, 2, 4.5625, 2);
+  add(0, 2, -4.5625, 2);
+  add(0, 0, 0, 3.0625);
+  add(0, 0, 0, -3.0625);
+  add(0, 0, 4.5625, 3.0625);
+  add(0, 0, -4.5625, -3.0625);
+  // Leaving the field by the smallest representable amount
+  add(0, 2, std::nextafter(4.5625, 5.0), 2);
+  add(0, 0, 0, std::nextafter(-3.0625, -4.0));
+  // Entirely crossing the goal line exactly, on the posts and inside the goal
+  add(0, 1.2, 4.5625, 1.2);
+  add(0, 1.25, 4.5625, 1.25);
+  add(0, -1.25, 5, -1.25);
+  add(0, 1, std::nextafter(4.5625, 4.0), 1);
+  // Kicking backward toward the goal
+  add(4.6, 0.5, 4.58, 0.5);
+  // Touching the goalie bounds exactly, lateral moves and moves along its sides
+  add(3, 0, 4, 0);
+  add(4.5, 0, 4.25, 0);
+  add(4.1, -1, 4.1, 1);
+  add(4.1, 1, 4.1, -0.3125);
+  add(4.1, 1, 4.1, 0.3125);
+  add(3, 0.3125, 4.4, 0.3125);
+  add(3, -0.3125, 4.4, -0.3125);
+  add(4, -1, 4, 1);
+  // Zero length segments, inside and on the boundaries
+  add(1, 1, 1, 1);
+  add(4.5625, 0, 4.5625, 0);
+  add(4.125, 0, 4.125, 0);
+  // Each case is checked at every position of a group of 4
+  for (int offset = 1; offset < 4; offset++)
+  {
+    std::vector<double> sx(offset, 0.0), sy(offset, 0.0), ex(offset, 0.0), ey(offset, 0.0);
+    sx.insert(sx.end(), src_x.begin(), src_x.end());
+    sy.insert(sy.end(), src_y.begin(), src_y.end());
+    ex.insert(ex.end(), dst_x.begin(), dst_x.end());
+    ey.insert(ey.end(), dst_y.begin(), dst_y.end());
+    checkBatch(kernel, sx, sy, ex, ey);
+  }
+  checkBatch(kernel, src_x, src_y, dst_x, dst_y);
+}
+
+TEST(process, batchMatchesScalarOnBoundaries)
+{
+  checkBoundarySegments(false);
+  checkBoundarySegments(true);
+}
+
+TEST(process, boundaryEvents)
+{
+  BallExitKernel kernel = buildKernel(false);
+  double x = 4.5625, y = 2;
+  EXPECT_EQ(BallExitKernel::Event::None, kernel.process(0, 2, &x, &y));
+  x = std::nextafter(4.5625, 5.0);
+  EXPECT_EQ(BallExitKernel::Event::Out, kernel.process(0, 2, &x, &y));
+  // Ball entirely crossing the line inside the goal
+  x = 4.5625;
+  y = 1.2;
+  EXPECT_EQ(BallExitKernel::Event::Goal, kernel.process(0, 1.2, &x, &y));
+  EXPECT_EQ(4.5625, x);
+  EXPECT_EQ(1.2, y);
+  // Intercept on the post is not a goal
+  x = 5;
+  y = 1.25;
+  EXPECT_EQ(BallExitKernel::Event::Out, kernel.process(0, 1.25, &x, &y));
+  // Goalie stops the ball on its front side
+  kernel = buildKernel(true);
+  x = 5;
+  y = 0;
+  EXPECT_EQ(BallExitKernel::Event::GoalieCollision, kernel.process(3, 0, &x, &y));
+  EXPECT_EQ(4, x);
+  EXPECT_EQ(0, y);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "rhoban_csa_mdp/core/problem.h"
+
+#include <functional>
+#include <random>
+
+namespace csa_mdp
+{
+/// Batch version of getSuccessor applied on all the columns of states and
+/// actions, successors, rewards and terminal have to be allocated by the caller
+typedef std::function<void(const Eigen::MatrixXd& states, const Eigen::MatrixXd& actions,
+                           std::default_random_engine* engine, Eigen::MatrixXd* successors, Eigen::VectorXd* rewards,
+                           Eigen::Array<bool, -1, 1>* terminal)>
+    BatchSuccessors;
+
+/// Sample states uniformly inside 'state_ratio' times the limits of the
+/// problem and actions (without action_id) inside twice the limits of the first
+/// action space, inputs might therefore be outside of the limits
+inline void sampleBatchInputs(const Problem& problem, int n, Eigen::MatrixXd* states, Eigen::MatrixXd* actions,
+                              std::default_random_engine* engine, double state_ratio = 1)
+{
+  const Eigen::MatrixXd& state_limits = problem.getStateLimits();
+  const Eigen::MatrixXd& action_limits = problem.getActionLimits(0);
+  int state_dims = state_limits.rows();
+  int action_dims = action_limits.rows();
+  *states = Eigen::MatrixXd(state_dims, n);
+  *actions = Eigen::MatrixXd::Zero(action_dims + 1, n);
+  for (int col = 0; col < n; col++)
+  {
+    for (int dim = 0; dim < state_dims; dim++)
+    {
+      std::uniform_real_distribution<double> distrib(state_ratio * state_limits(dim, 0),
+                                                     state_ratio * state_limits(dim, 1));
+      (*states)(dim, col) = distrib(*engine);
+    }
+    for (int dim = 0; dim < action_dims; dim++)
+    {
+      std::uniform_real_distribution<double> distrib(2 * action_limits(dim, 0), 2 * action_limits(dim, 1));
+      (*actions)(dim + 1, col) = distrib(*engine);
+    }
+  }
+}
+
+/// Compare batch on the provided inputs with successive calls to getSuccessor
+/// using an engine with the same seed. Successors and rewards have to be at
+/// most 'epsilon' away, terminal status have to be identical.
+/// With an epsilon of 0, results have to be bitwise identical
+inline void compareBatchSuccessors(const Problem& problem, const BatchSuccessors& batch, const Eigen::MatrixXd& states,
+                                   const Eigen::MatrixXd& actions, double epsilon)
+{
+  int n = states.cols();
+  int state_dims = states.rows();
+  Eigen::MatrixXd successors(state_dims, n);
+  Eigen::VectorXd rewards(n);
+  Eigen::Array<bool, -1, 1> terminal(n);
+  std::default_random_engine batch_engine(1), scalar_engine(1);
+  batch(states, actions, &batch_engine, &successors, &rewards, &terminal);
+  for (int col = 0; col < n; col++)
+  {
+    Problem::Result r = problem.getSuccessor(states.col(col), actions.col(col), &scalar_engine);
+    for (int dim = 0; dim < state_dims; dim++)
+    {
+      EXPECT_NEAR(r.successor(dim), successors(dim, col), epsilon) << "column " << col << ", dim " << dim;
+    }
+    EXPECT_NEAR(r.reward, rewards(col), epsilon) << "column " << col;
+    EXPECT_EQ(r.terminal, terminal(col)) << "column " << col;
+  }
+}
+
+/// Compare P::getSuccessors on n random inputs (see sampleBatchInputs) with
+/// successive calls to getSuccessor (see compareBatchSuccessors)
+template <class P>
+void checkBatchSuccessors(const P& problem, int n, bool strict, double epsilon)
+{
+  std::default_random_engine engine;
+  Eigen::MatrixXd states, actions;
+  sampleBatchInputs(problem, n, &states, &actions, &engine);
+  BatchSuccessors batch = [&problem, strict](const Eigen::MatrixXd& states, const Eigen::MatrixXd& actions,
+                                             std::default_random_engine* engine, Eigen::MatrixXd* successors,
+                                             Eigen::VectorXd* rewards, Eigen::Array<bool, -1, 1>* terminal) {
+    problem.getSuccessors(states, actions, engine, successors, rewards, terminal, strict);
+  };
+  compareBatchSuccessors(problem, batch, states, actions, epsilon);
+}
+
+}  // namespace csa_mdp
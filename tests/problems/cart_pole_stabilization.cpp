@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <problems/cart_pole_stabilization.h>
+
+#include <cmath>
+
+#define EPSILON std::pow(10, -12)
+
+using namespace csa_mdp;
+
+static Eigen::VectorXd getNextState(const CartPoleStabilization& problem)
+{
+  std::default_random_engine engine;
+  Eigen::VectorXd state(4), action(2);
+  state << 0.1, 0.2, std::cos(0.1), std::sin(0.1);
+  action << 0, 5;
+  return problem.getSuccessor(state, action, &engine).successor;
+}
+
+TEST(fromJson, perInstanceParameters)
+{
+  CartPoleStabilization light, heavy, reference;
+  Json::Value light_json, heavy_json, reference_json;
+  light_json["noise_max"] = 0;
+  light_json["pendulum_mass"] = 1;
+  light_json["theta_max"] = 1;
+  heavy_json["noise_max"] = 0;
+  heavy_json["pendulum_mass"] = 4;
+  reference_json["noise_max"] = 0;
+  reference.fromJson(reference_json, "");
+  Eigen::VectorXd reference_successor = getNextState(reference);
+  light.fromJson(light_json, "");
+  heavy.fromJson(heavy_json, "");
+  // Configuring instances does not affect the others
+  EXPECT_NEAR(4, heavy.toJson()["pendulum_mass"].asDouble(), EPSILON);
+  EXPECT_NEAR(M_PI / 2, heavy.getStateLimits()(0, 1), EPSILON);
+  EXPECT_NEAR(1, light.getStateLimits()(0, 1), EPSILON);
+  Eigen::VectorXd light_successor = getNextState(light);
+  Eigen::VectorXd heavy_successor = getNextState(heavy);
+  for (int dim = 0; dim < 4; dim++)
+  {
+    EXPECT_NEAR(reference_successor(dim), getNextState(reference)(dim), EPSILON);
+  }
+  EXPECT_GT(std::fabs(light_successor(1) - heavy_successor(1)), 1e-3);
+}
+
+TEST(fromJson, invalidParameters)
+{
+  CartPoleStabilization problem;
+  Json::Value v;
+  v["pendulum_mass"] = -1;
+  EXPECT_THROW(problem.fromJson(v, ""), rhoban_utils::JsonParsingError);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
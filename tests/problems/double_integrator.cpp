@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <problems/double_integrator.h>
+
+#include "batch_successors.h"
+
+#include <cmath>
+
+#define EPSILON std::pow(10, -12)
+
+using namespace csa_mdp;
+
+/// Batch version of DoubleIntegrator::getSuccessor
+static BatchSuccessors getBatch(const DoubleIntegrator& problem)
+{
+  return [&problem](const Eigen::MatrixXd& states, const Eigen::MatrixXd& actions, std::default_random_engine* engine,
+                    Eigen::MatrixXd* successors, Eigen::VectorXd* rewards, Eigen::Array<bool, -1, 1>* terminal) {
+    problem.getSuccessors(states, actions, engine, successors, rewards, terminal);
+  };
+}
+
+TEST(getSuccessor, exactDiscretization)
+{
+  std::default_random_engine engine;
+  DoubleIntegrator problem;
+  Eigen::VectorXd state(2), action(2);
+  state << 0.2, -0.4;
+  action << 0, 0.6;
+  Problem::Result r = problem.getSuccessor(state, action, &engine);
+  // Step is 0.5 [s]
+  Eigen::Vector2d expected_successor(0.2 - 0.4 * 0.5 + 0.6 * 0.5 * 0.5 / 2, -0.4 + 0.6 * 0.5);
+  double expected_reward = -(0.2 * 0.2);
+  EXPECT_NEAR(expected_successor(0), r.successor(0), EPSILON);
+  EXPECT_NEAR(expected_successor(1), r.successor(1), EPSILON);
+  EXPECT_NEAR(expected_reward, r.reward, EPSILON);
+  EXPECT_FALSE(r.terminal);
+  // Same values with the batch version
+  Eigen::MatrixXd successors(2, 1);
+  Eigen::VectorXd rewards(1);
+  Eigen::Array<bool, -1, 1> terminal(1);
+  getBatch(problem)(state, action, &engine, &successors, &rewards, &terminal);
+  EXPECT_NEAR(expected_successor(0), successors(0, 0), EPSILON);
+  EXPECT_NEAR(expected_successor(1), successors(1, 0), EPSILON);
+  EXPECT_NEAR(expected_reward, rewards(0), EPSILON);
+  EXPECT_FALSE(terminal(0));
+}
+
+static void checkBatch(DoubleIntegrator::Version version)
+{
+  DoubleIntegrator problem(version);
+  std::default_random_engine engine;
+  Eigen::MatrixXd states, actions;
+  sampleBatchInputs(problem, 1000, &states, &actions, &engine);
+  compareBatchSuccessors(problem, getBatch(problem), states, actions, EPSILON);
+}
+
+TEST(getSuccessors, matchesGetSuccessor)
+{
+  checkBatch(DoubleIntegrator::SantaMaria1998);
+  checkBatch(DoubleIntegrator::Weinstein2012);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
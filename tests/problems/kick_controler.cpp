@@ -0,0 +1,316 @@
+#include <gtest/gtest.h>
+#include <problems/kick_controler.h>
+
+#include "rhoban_csa_mdp/core/policy_factory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <vector>
+
+using namespace csa_mdp;
+
+/// Path of the kick model collection used by the tests
+static const std::string KmcPath = "kick_controler_test_kmc.json";
+
+/// Write a kick model collection with a single noisy kick
+static void writeKickModelCollection()
+{
+  Json::Value kick_zone;
+  kick_zone["kick_x_min"] = 0.12;
+  kick_zone["kick_x_max"] = 0.22;
+  kick_zone["kick_y_tol"] = 0.04;
+  kick_zone["kick_y_offset"] = 0.08;
+  kick_zone["kick_theta_tol"] = 10;
+  kick_zone["kick_theta_offset"] = 0;
+  Json::Value kick;
+  kick["class name"] = "ClassicKick";
+  kick["content"]["kick_zone"] = kick_zone;
+  kick["content"]["kick_power"] = 3;
+  kick["content"]["right_kick_dir"] = 0;
+  kick["content"]["rel_dist_stddev"] = 0.1;
+  kick["content"]["dir_stddev"] = 10;
+  Json::Value kmc;
+  kmc["map"]["classic"] = kick;
+  kmc["grassModel"] = Json::Value(Json::objectValue);
+  std::ofstream out(KmcPath);
+  out << kmc;
+}
+
+/// Configuration of a problem with two players using approximated approaches
+static Json::Value buildConfig()
+{
+  writeKickModelCollection();
+  Json::Value kick_option;
+  kick_option["kick_decision_model"]["class name"] = "DirectedKick";
+  kick_option["kick_decision_model"]["content"] = Json::Value(Json::objectValue);
+  kick_option["kick_model_names"].append("classic");
+  Json::Value v;
+  v["kmc_path"] = KmcPath;
+  v["simulate_approaches"] = false;
+  v["max_initial_dist"] = 2;
+  for (std::string name : { "p1", "p2" })
+  {
+    Json::Value player;
+    player["name"] = name;
+    player["kick_options"].append(kick_option);
+    v["players"].append(player);
+  }
+  return v;
+}
+
+static std::unique_ptr<KickControler> buildProblem(const Json::Value& v)
+{
+  std::unique_ptr<KickControler> problem(new KickControler);
+  problem->fromJson(v, ".");
+  return problem;
+}
+
+TEST(getStartingState, bankIsReproducible)
+{
+  Json::Value v = buildConfig();
+  v["starting_states_bank_size"] = 20;
+  v["starting_states_bank_seed"] = 3;
+  std::unique_ptr<KickControler> problem = buildProblem(v);
+  const std::vector<Eigen::VectorXd>& bank = problem->getStartingStatesBank();
+  ASSERT_EQ(20, (int)bank.size());
+  // Same seed provides the same bank
+  EXPECT_EQ(bank, buildProblem(v)->getStartingStatesBank());
+  // Two sequential evaluations with the same seed see the same states, even
+  // if other evaluations use the problem in the meantime
+  std::default_random_engine first_engine(5), second_engine(5), other_engine(7);
+  std::vector<Eigen::VectorXd> first_states, second_states;
+  for (int episode = 0; episode < 50; episode++)
+  {
+    first_states.push_back(problem->getStartingState(&first_engine));
+  }
+  for (int episode = 0; episode < 50; episode++)
+  {
+    problem->getStartingState(&other_engine);
+    second_states.push_back(problem->getStartingState(&second_engine));
+  }
+  EXPECT_EQ(first_states, second_states);
+  for (const Eigen::VectorXd& state : first_states)
+  {
+    EXPECT_NE(bank.end(), std::find(bank.begin(), bank.end(), state));
+  }
+}
+
+TEST(getStartingState, playersAreNearTheBall)
+{
+  std::unique_ptr<KickControler> problem = buildProblem(buildConfig());
+  std::default_random_engine engine;
+  for (int episode = 0; episode < 1000; episode++)
+  {
+    Eigen::VectorXd state = problem->getStartingState(&engine);
+    ASSERT_EQ(8, state.rows());
+    for (int player = 0; player < 2; player++)
+    {
+      EXPECT_GE(2 * (1 + 1e-9), (state.segment(2 + 3 * player, 2) - state.segment(0, 2)).norm());
+      EXPECT_GE(4.5, std::fabs(state(2 + 3 * player)));
+      EXPECT_GE(3, std::fabs(state(3 + 3 * player)));
+    }
+  }
+}
+
+/// Features of a transition which are expected to be equal in distribution for
+/// symmetric inputs: ball position, position, cosine and sine of the direction
+/// of the players, reward
+static Eigen::VectorXd getFeatures(const Eigen::VectorXd& successor, double reward)
+{
+  int nb_players = (successor.rows() - 2) / 3;
+  Eigen::VectorXd features(3 + 4 * nb_players);
+  features.segment(0, 2) = successor.segment(0, 2);
+  for (int player = 0; player < nb_players; player++)
+  {
+    features.segment(2 + 4 * player, 2) = successor.segment(2 + 3 * player, 2);
+    features(4 + 4 * player) = std::cos(successor(4 + 3 * player));
+    features(5 + 4 * player) = std::sin(successor(4 + 3 * player));
+  }
+  features(2 + 4 * nb_players) = reward;
+  return features;
+}
+
+/// Since transitions are noisy, the mean of the features of the mirrored
+/// successors of (state, action) are compared with the mean of the features of
+/// the successors of the mirrored inputs
+static void checkMirrorEquivariance(const KickControler& problem, const Eigen::VectorXd& state,
+                                    const Eigen::VectorXd& action)
+{
+  int nb_samples = 20000;
+  double nb_std_errors = 5;
+  std::default_random_engine engine;
+  Eigen::VectorXd mirrored_state = problem.mirrorState(state);
+  Eigen::VectorXd mirrored_action = problem.mirrorAction(action);
+  int nb_features = getFeatures(state, 0).rows();
+  Eigen::VectorXd sum = Eigen::VectorXd::Zero(nb_features), sum2 = Eigen::VectorXd::Zero(nb_features);
+  Eigen::VectorXd mirrored_sum = sum, mirrored_sum2 = sum;
+  for (int sample = 0; sample < nb_samples; sample++)
+  {
+    Problem::Result result = problem.getSuccessor(state, action, &engine);
+    Eigen::VectorXd features = getFeatures(problem.mirrorState(result.successor), result.reward);
+    sum += features;
+    sum2 += features.cwiseProduct(features);
+    Problem::Result mirrored_result = problem.getSuccessor(mirrored_state, mirrored_action, &engine);
+    Eigen::VectorXd mirrored_features = getFeatures(mirrored_result.successor, mirrored_result.reward);
+    mirrored_sum += mirrored_features;
+    mirrored_sum2 += mirrored_features.cwiseProduct(mirrored_features);
+  }
+  for (int dim = 0; dim < nb_features; dim++)
+  {
+    double mean = sum(dim) / nb_samples;
+    double mirrored_mean = mirrored_sum(dim) / nb_samples;
+    // Features might be constant, rounding errors could lead to negative variances
+    double variance = std::max(0.0, sum2(dim) / nb_samples - mean * mean);
+    double mirrored_variance = std::max(0.0, mirrored_sum2(dim) / nb_samples - mirrored_mean * mirrored_mean);
+    double tolerance = nb_std_errors * std::sqrt((variance + mirrored_variance) / nb_samples) + 1e-9;
+    EXPECT_NEAR(mean, mirrored_mean, tolerance) << "feature " << dim << ", state: " << state.transpose()
+                                                << ", action: " << action.transpose();
+  }
+}
+
+TEST(hasSymmetry, approximatedApproachesAreMirrorEquivariant)
+{
+  std::unique_ptr<KickControler> problem = buildProblem(buildConfig());
+  ASSERT_TRUE(problem->hasSymmetry());
+  std::default_random_engine engine;
+  std::uniform_real_distribution<double> dir_distrib(-M_PI, M_PI);
+  for (int trial = 0; trial < 10; trial++)
+  {
+    Eigen::VectorXd state = problem->getStartingState(&engine);
+    for (int action_id : { 0, 1 })
+    {
+      Eigen::VectorXd action(2);
+      action << action_id, dir_distrib(engine);
+      checkMirrorEquivariance(*problem, state, action);
+    }
+  }
+}
+
+TEST(hasSymmetry, approachStepsApproximatorBreaksSymmetry)
+{
+  // The approximator is only loaded when used, the file does not need to exist
+  Json::Value v = buildConfig();
+  v["approach_approximator_path"] = "approach_steps.bin";
+  EXPECT_FALSE(buildProblem(v)->hasSymmetry());
+  v["approach_approximator_path"] = "";
+  EXPECT_TRUE(buildProblem(v)->hasSymmetry());
+}
+
+/// Approach policy which never moves and counts the actions requested, each
+/// instance is identified by its name
+class CountingPolicy : public Policy
+{
+public:
+  Eigen::VectorXd getRawAction(const Eigen::VectorXd& state, std::default_random_engine* engine) const override
+  {
+    (void)state;
+    (void)engine;
+    getNbCalls()[name]++;
+    return Eigen::VectorXd::Zero(4);
+  }
+
+  std::string getClassName() const override
+  {
+    return "CountingPolicy";
+  }
+
+  Json::Value toJson() const override
+  {
+    Json::Value v;
+    v["name"] = name;
+    return v;
+  }
+
+  void fromJson(const Json::Value& v, const std::string& dir_name) override
+  {
+    (void)dir_name;
+    name = rhoban_utils::read<std::string>(v, "name");
+  }
+
+  static std::map<std::string, int>& getNbCalls()
+  {
+    static std::map<std::string, int> nb_calls;
+    return nb_calls;
+  }
+
+private:
+  std::string name;
+};
+
+static Json::Value buildCountingPolicy(const std::string& name)
+{
+  Json::Value v;
+  v["class name"] = "CountingPolicy";
+  v["content"]["name"] = name;
+  return v;
+}
+
+/// While the other robots are moving after the kick, the kicker stays still
+/// but its policy is still queried, preserving the random sequence of the
+/// episode
+TEST(getSuccessor, disabledKickerQueriesItsPolicy)
+{
+  PolicyFactory::registerExtraBuilder("CountingPolicy", []() { return std::unique_ptr<Policy>(new CountingPolicy); });
+  Json::Value v = buildConfig();
+  v["simulate_approaches"] = true;
+  v["step_initial_stddev"] = 0;
+  v["players"].resize(1);
+  v["players"][0]["policy"] = buildCountingPolicy("navigation");
+  v["players"][0]["kick_options"][0]["policy"] = buildCountingPolicy("kicker");
+  std::unique_ptr<KickControler> problem = buildProblem(v);
+  // Ball at the center of the field, kicker placed to kick toward the goal
+  // with its left foot: the approach ends after a single step
+  Eigen::VectorXd state(5), action(2);
+  state << 0, 0, -0.17, -0.08, 0;
+  action << 0, 0;
+  std::default_random_engine engine;
+  CountingPolicy::getNbCalls().clear();
+  Problem::Result result = problem->getSuccessor(state, action, &engine);
+  EXPECT_FALSE(result.terminal);
+  // One step of approach, then (int)(10 * 2 * 1.7) + 1 steps for the other
+  // robots after a kick lasting 10 seconds
+  EXPECT_EQ(1 + 35, CountingPolicy::getNbCalls()["kicker"]);
+  EXPECT_EQ(0, CountingPolicy::getNbCalls()["navigation"]);
+}
+
+TEST(getPolicy, sharingRequiresSameLimits)
+{
+  PolicyFactory::registerExtraBuilder("CountingPolicy", []() { return std::unique_ptr<Policy>(new CountingPolicy); });
+  Json::Value v = buildConfig();
+  for (Json::Value& player : v["players"])
+  {
+    player["policy"] = buildCountingPolicy("navigation");
+    player["share_policy"] = true;
+    Json::Value kick_option = player["kick_options"][0];
+    kick_option["policy"] = buildCountingPolicy("kicker");
+    kick_option["share_policy"] = true;
+    player["kick_options"][0] = kick_option;
+    // Same description with different action limits
+    kick_option["approach_model"]["max_step_x_diff"] = 0.02;
+    player["kick_options"].append(kick_option);
+    // Stateful policies are not shared
+    kick_option["share_policy"] = false;
+    player["kick_options"].append(kick_option);
+  }
+  std::unique_ptr<KickControler> problem = buildProblem(v), other = buildProblem(v);
+  // Players and problems share the policies with the same limits
+  const Policy* navigation = &problem->getPolicy(0, -1, 0);
+  const Policy* kicker = &problem->getPolicy(0, 0, 0);
+  EXPECT_NE(navigation, kicker);
+  EXPECT_EQ(navigation, &problem->getPolicy(1, -1, 0));
+  EXPECT_EQ(navigation, &other->getPolicy(0, -1, 0));
+  EXPECT_EQ(kicker, &problem->getPolicy(1, 1, 0));
+  EXPECT_EQ(kicker, &other->getPolicy(0, 0, 0));
+  EXPECT_NE(kicker, &problem->getPolicy(0, 0, 1));
+  EXPECT_EQ(&problem->getPolicy(0, 0, 1), &problem->getPolicy(1, 1, 1));
+  EXPECT_NE(&problem->getPolicy(0, 0, 2), &problem->getPolicy(1, 1, 2));
+  EXPECT_NE(&problem->getPolicy(0, 0, 2), &other->getPolicy(0, 0, 2));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
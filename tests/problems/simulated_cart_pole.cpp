@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <problems/simulated_cart_pole_pool.h>
+
+#include "batch_successors.h"
+
+#include <cmath>
+
+#define EPSILON std::pow(10, -9)
+
+using namespace csa_mdp;
+
+static std::shared_ptr<SimulatedCartPole> buildProblem(const std::string& reward_type, const std::string& integrator,
+                                                       double integrator_step)
+{
+  std::shared_ptr<SimulatedCartPole> problem(new SimulatedCartPole);
+  Json::Value v;
+  v["reward_type"] = reward_type;
+  v["torque_stddev"] = 0;
+  v["integrator"]["method"] = integrator;
+  v["integrator"]["step"] = integrator_step;
+  problem->fromJson(v, "");
+  return problem;
+}
+
+/// Batch version of SimulatedCartPole::getSuccessor for full states
+static BatchSuccessors getBatch(const SimulatedCartPole& problem)
+{
+  return [&problem](const Eigen::MatrixXd& states, const Eigen::MatrixXd& actions, std::default_random_engine* engine,
+                    Eigen::MatrixXd* successors, Eigen::VectorXd* rewards, Eigen::Array<bool, -1, 1>* terminal) {
+    SimulatedCartPole::StateArrays batch_states = states.array(), batch_successors;
+    Eigen::ArrayXd cmds = actions.row(1).transpose().array(), batch_rewards;
+    problem.getSuccessors(batch_states, cmds, engine, &batch_successors, &batch_rewards, terminal);
+    *successors = batch_successors.matrix();
+    *rewards = batch_rewards.matrix();
+  };
+}
+
+/// Starting at rest with the pole upright, a single euler step of 0.1 [s] only
+/// depends on the command: accelerations are 4u / (4(M+m) - 3m) for the cart
+/// and 6u / (4l(M+m) - 3ml) for the pole
+TEST(getSuccessor, eulerStepFromRest)
+{
+  std::shared_ptr<SimulatedCartPole> problem = buildProblem("pilco", "euler", 0.1);
+  Eigen::VectorXd state(6), action(2);
+  state << 0.5, 0, 0, 0, 1, 0;
+  action << 0, 2;
+  // M = m = 0.5, l = 0.5
+  Eigen::VectorXd expected_successor(6);
+  expected_successor << 0.5, 0.1 * 8 / 2.5, 0, 0.1 * 12 / 1.25, 1, 0;
+  // The end of the pole is 0.5 [m] away from its target
+  double expected_reward = std::exp(-0.5) - 1;
+  std::default_random_engine engine;
+  Problem::Result r = problem->getSuccessor(state, action, &engine);
+  Eigen::MatrixXd successors(6, 1);
+  Eigen::VectorXd rewards(1);
+  Eigen::Array<bool, -1, 1> terminal(1);
+  getBatch(*problem)(state, action, &engine, &successors, &rewards, &terminal);
+  for (int dim = 0; dim < 6; dim++)
+  {
+    EXPECT_NEAR(expected_successor(dim), r.successor(dim), EPSILON) << "dim " << dim;
+    EXPECT_NEAR(expected_successor(dim), successors(dim, 0), EPSILON) << "dim " << dim;
+  }
+  EXPECT_NEAR(expected_reward, r.reward, EPSILON);
+  EXPECT_NEAR(expected_reward, rewards(0), EPSILON);
+  EXPECT_FALSE(r.terminal);
+  EXPECT_FALSE(terminal(0));
+}
+
+static void checkBatch(const std::string& reward_type, const std::string& integrator)
+{
+  std::shared_ptr<SimulatedCartPole> problem = buildProblem(reward_type, integrator, 0.01);
+  std::default_random_engine engine;
+  Eigen::MatrixXd states, actions;
+  // Some states are slightly outside of the limits
+  sampleBatchInputs(*problem, 1000, &states, &actions, &engine, 1.1);
+  for (int col = 0; col < states.cols(); col++)
+  {
+    states(4, col) = std::cos(states(2, col));
+    states(5, col) = std::sin(states(2, col));
+  }
+  compareBatchSuccessors(*problem, getBatch(*problem), states, actions, EPSILON);
+}
+
+TEST(getSuccessors, matchesGetSuccessor)
+{
+  checkBatch("pilco", "rk4");
+  checkBatch("continuous", "euler");
+  checkBatch("binary", "rk4");
+}
+
+TEST(SimulatedCartPolePool, resetTerminated)
+{
+  std::shared_ptr<SimulatedCartPole> problem(new SimulatedCartPole);
+  std::default_random_engine engine;
+  SimulatedCartPolePool pool(problem, 3);
+  Eigen::VectorXd start = problem->getStartingState(&engine);
+  Eigen::VectorXd state = start;
+  // Cart is moving fast toward the limit
+  state(0) = 0.95;
+  state(1) = 4;
+  pool.setState(1, state);
+  pool.step(Eigen::ArrayXd::Zero(3), &engine);
+  EXPECT_FALSE(pool.getTerminal()(0));
+  EXPECT_TRUE(pool.getTerminal()(1));
+  EXPECT_NEAR(-100, pool.getRewards()(1), EPSILON);
+  EXPECT_EQ(1, pool.resetTerminated(&engine));
+  EXPECT_FALSE(pool.getTerminal()(1));
+  for (int dim = 0; dim < 6; dim++)
+  {
+    EXPECT_NEAR(start(dim), pool.getState(1)(dim), EPSILON);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
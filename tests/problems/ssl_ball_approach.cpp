@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <problems/ssl_ball_approach.h>
+
+#include <cmath>
+
+#define EPSILON std::pow(10, -6)
+
+using namespace csa_mdp;
+
+TEST(getDeterministicSuccessor, jacobiansMatchFiniteDifferences)
+{
+  SSLBallApproach ball_approach;
+  Json::Value no_noise_model;
+  no_noise_model["cart_stddev"] = 0;
+  no_noise_model["angular_stddev"] = 0;
+  ball_approach.fromJson(no_noise_model, "");
+  const Eigen::MatrixXd& state_limits = ball_approach.getStateLimits();
+  const Eigen::MatrixXd& action_limits = ball_approach.getActionLimits(0);
+  std::default_random_engine engine;
+  double step = std::pow(10, -6);
+  for (int sample = 0; sample < 100; sample++)
+  {
+    Eigen::VectorXd state(6), action(3);
+    for (int dim = 0; dim < 6; dim++)
+    {
+      // Avoiding discontinuities of the angles at -pi and pi
+      double margin = (dim == 1 || dim == 2) ? 0.5 : 0;
+      std::uniform_real_distribution<double> distrib(state_limits(dim, 0) + margin, state_limits(dim, 1) - margin);
+      state(dim) = distrib(engine);
+    }
+    for (int dim = 0; dim < 3; dim++)
+    {
+      // Actions might be outside of the limits
+      std::uniform_real_distribution<double> distrib(2 * action_limits(dim, 0), 2 * action_limits(dim, 1));
+      action(dim) = distrib(engine);
+    }
+    Eigen::MatrixXd state_jacobian, action_jacobian;
+    Eigen::VectorXd successor =
+        ball_approach.getDeterministicSuccessor(state, action, &state_jacobian, &action_jacobian);
+    // Without noise, getSuccessor follows the same motion
+    Eigen::VectorXd full_action(4);
+    full_action << 0, action;
+    Problem::Result r = ball_approach.getSuccessor(state, full_action, &engine);
+    for (int dim = 0; dim < 6; dim++)
+    {
+      EXPECT_NEAR(r.successor(dim), successor(dim), EPSILON);
+    }
+    for (int dim = 0; dim < 6; dim++)
+    {
+      Eigen::VectorXd delta = Eigen::VectorXd::Zero(6);
+      delta(dim) = step;
+      Eigen::VectorXd diff = (ball_approach.getDeterministicSuccessor(state + delta, action, nullptr, nullptr) -
+                              ball_approach.getDeterministicSuccessor(state - delta, action, nullptr, nullptr)) /
+                             (2 * step);
+      for (int out = 0; out < 6; out++)
+      {
+        EXPECT_NEAR(diff(out), state_jacobian(out, dim), EPSILON);
+      }
+    }
+    for (int dim = 0; dim < 3; dim++)
+    {
+      Eigen::VectorXd delta = Eigen::VectorXd::Zero(3);
+      delta(dim) = step;
+      Eigen::VectorXd diff = (ball_approach.getDeterministicSuccessor(state, action + delta, nullptr, nullptr) -
+                              ball_approach.getDeterministicSuccessor(state, action - delta, nullptr, nullptr)) /
+                             (2 * step);
+      for (int out = 0; out < 6; out++)
+      {
+        EXPECT_NEAR(diff(out), action_jacobian(out, dim), EPSILON);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,8 +1,11 @@
 #include <gtest/gtest.h>
 #include <problems/ssl_dynamic_ball_approach.h>
 
+#include "batch_successors.h"
+
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <map>
 
 #define EPSILON std::pow(10, -6)
 
@@ -17,11 +20,34 @@ TEST(constructor, testSuccess)
   csa_mdp::SSLDynamicBallApproach ball_approach;
 }
 
-TEST(constructor, testRobotSpeed)
+/// Check getSuccessor and both modes of getSuccessors against the expected
+/// values, the reward of a step without collision is -dt
+static void checkSuccessor(const SSLDynamicBallApproach& ball_approach, const Eigen::VectorXd& state,
+                           const Eigen::VectorXd& action, const std::map<int, double>& expected, double dt)
 {
   std::default_random_engine engine;
+  Problem::Result r = ball_approach.getSuccessor(state, action, &engine);
+  Eigen::MatrixXd successors(11, 1);
+  Eigen::VectorXd rewards(1);
+  Eigen::Array<bool, -1, 1> terminal(1);
+  for (bool strict : { true, false })
+  {
+    ball_approach.getSuccessors(state, action, &engine, &successors, &rewards, &terminal, strict);
+    for (const auto& entry : expected)
+    {
+      EXPECT_NEAR(entry.second, r.successor(entry.first), EPSILON) << "dim " << entry.first;
+      EXPECT_NEAR(entry.second, successors(entry.first, 0), EPSILON) << "dim " << entry.first << ", strict " << strict;
+    }
+    EXPECT_NEAR(-dt, r.reward, EPSILON);
+    EXPECT_NEAR(-dt, rewards(0), EPSILON);
+    EXPECT_FALSE(r.terminal);
+    EXPECT_FALSE(terminal(0));
+  }
+}
+
+TEST(constructor, testRobotSpeed)
+{
   Eigen::VectorXd state, action;
-  Problem::Result r;
   SSLDynamicBallApproach ball_approach;
   // Disabling noise, choosing dt and ensuring limits are not a problem
   Json::Value no_noise_model;
@@ -30,33 +56,96 @@ TEST(constructor, testRobotSpeed)
   no_noise_model["cart_stddev"] = 0;
   no_noise_model["angular_stddev"] = 0;
   no_noise_model["dt"] = 0.5;
+  no_noise_model["ball_max_dist"] = 2;
   ball_approach.fromJson(no_noise_model, "");
   // Simple test: positive rotation (no speed for ball)
   state = Eigen::VectorXd::Zero(11);
   state(0) = -1;    // Ball 1[m] backward
   state(2) = 1;     // Target 1[m] backward
   state(6) = M_PI;  // Speed: pi/2 [rad/s]
+  state(9) = 0.2;   // Kick tolerance inside its limits
   action = Eigen::VectorXd::Zero(4);
-  r = ball_approach.getSuccessor(state, action, &engine);
-  EXPECT_NEAR(0, r.successor(0), EPSILON);
-  EXPECT_NEAR(1, r.successor(1), EPSILON);
-  EXPECT_NEAR(0, r.successor(2), EPSILON);
-  EXPECT_NEAR(-1, r.successor(3), EPSILON);
-  EXPECT_NEAR(M_PI, r.successor(6), EPSILON);
-  EXPECT_NEAR(M_PI / 2, r.successor(10), EPSILON);
+  checkSuccessor(ball_approach, state, action, { { 0, 0 }, { 1, 1 }, { 2, 0 }, { 3, -1 }, { 6, M_PI }, { 10, M_PI / 2 } },
+                 0.5);
   // Simple test: pure translation along y-axis
   state = Eigen::VectorXd::Zero(11);
   state(0) = -1;  // Ball 1[m] backward
   state(2) = 1;   // Target 1[m] backward
   state(5) = 1;   // Speed: 1[m/s] left
+  state(9) = 0.2;  // Kick tolerance inside its limits
   action = Eigen::VectorXd::Zero(4);
-  r = ball_approach.getSuccessor(state, action, &engine);
-  EXPECT_NEAR(-1, r.successor(0), EPSILON);
-  EXPECT_NEAR(-0.5, r.successor(1), EPSILON);
-  EXPECT_NEAR(1, r.successor(2), EPSILON);
-  EXPECT_NEAR(-0.5, r.successor(3), EPSILON);
-  EXPECT_NEAR(0, r.successor(6), EPSILON);
-  EXPECT_NEAR(0, r.successor(10), EPSILON);
+  checkSuccessor(ball_approach, state, action, { { 0, -1 }, { 1, -0.5 }, { 2, 1 }, { 3, -0.5 }, { 6, 0 }, { 10, 0 } },
+                 0.5);
+}
+
+/*******************************************************
+ * Batched successors
+ */
+
+TEST(getSuccessors, strictIsIdenticalToGetSuccessor)
+{
+  checkBatchSuccessors(SSLDynamicBallApproach(), 1000, true, 0);
+}
+
+TEST(getSuccessors, fastIsCloseToGetSuccessor)
+{
+  checkBatchSuccessors(SSLDynamicBallApproach(), 1000, false, EPSILON);
+}
+
+/*******************************************************
+ * Deterministic successor
+ */
+
+TEST(getDeterministicSuccessor, jacobiansMatchFiniteDifferences)
+{
+  SSLDynamicBallApproach ball_approach;
+  Json::Value no_noise_model;
+  no_noise_model["cart_stddev"] = 0;
+  no_noise_model["angular_stddev"] = 0;
+  ball_approach.fromJson(no_noise_model, "");
+  int n = 100;
+  std::default_random_engine engine;
+  Eigen::MatrixXd states, actions;
+  sampleBatchInputs(ball_approach, n, &states, &actions, &engine);
+  double step = std::pow(10, -6);
+  for (int col = 0; col < n; col++)
+  {
+    Eigen::VectorXd state = states.col(col);
+    Eigen::VectorXd action = actions.block(1, col, 3, 1);
+    Eigen::MatrixXd state_jacobian, action_jacobian;
+    Eigen::VectorXd successor =
+        ball_approach.getDeterministicSuccessor(state, action, &state_jacobian, &action_jacobian);
+    // Without noise, getSuccessor follows the same motion
+    Problem::Result r = ball_approach.getSuccessor(state, actions.col(col), &engine);
+    for (int dim = 0; dim < 11; dim++)
+    {
+      EXPECT_NEAR(r.successor(dim), successor(dim), EPSILON);
+    }
+    for (int dim = 0; dim < 11; dim++)
+    {
+      Eigen::VectorXd delta = Eigen::VectorXd::Zero(11);
+      delta(dim) = step;
+      Eigen::VectorXd diff = (ball_approach.getDeterministicSuccessor(state + delta, action, nullptr, nullptr) -
+                              ball_approach.getDeterministicSuccessor(state - delta, action, nullptr, nullptr)) /
+                             (2 * step);
+      for (int out = 0; out < 11; out++)
+      {
+        EXPECT_NEAR(diff(out), state_jacobian(out, dim), EPSILON);
+      }
+    }
+    for (int dim = 0; dim < 3; dim++)
+    {
+      Eigen::VectorXd delta = Eigen::VectorXd::Zero(3);
+      delta(dim) = step;
+      Eigen::VectorXd diff = (ball_approach.getDeterministicSuccessor(state, action + delta, nullptr, nullptr) -
+                              ball_approach.getDeterministicSuccessor(state, action - delta, nullptr, nullptr)) /
+                             (2 * step);
+      for (int out = 0; out < 11; out++)
+      {
+        EXPECT_NEAR(diff(out), action_jacobian(out, dim), EPSILON);
+      }
+    }
+  }
 }
 
 int main(int argc, char** argv)
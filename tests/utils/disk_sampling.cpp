@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <utils/disk_sampling.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace csa_mdp;
+
+/// Number of samples used for the statistical tests
+static const int NbSamples = 200000;
+
+/// Tolerance of the statistical tests in number of standard errors, tests are
+/// deterministic since engines are seeded
+static const double NbStdErrors = 5;
+
+/// Number of cells along each dimension for the histograms
+static const int NbCells = 6;
+
+static Eigen::Matrix<double, 2, 2> buildBox(double x_min, double x_max, double y_min, double y_max)
+{
+  Eigen::Matrix<double, 2, 2> box;
+  box << x_min, x_max, y_min, y_max;
+  return box;
+}
+
+/// Histogram of the points on a grid covering the bounding box of the
+/// intersection of the disk and the box
+class Histogram
+{
+public:
+  Histogram(const Eigen::Vector2d& center, double radius, const Eigen::Matrix<double, 2, 2>& box)
+    : counts(NbCells * NbCells, 0), nb_points(0)
+  {
+    for (int dim = 0; dim < 2; dim++)
+    {
+      min(dim) = std::max(box(dim, 0), center(dim) - radius);
+      max(dim) = std::min(box(dim, 1), center(dim) + radius);
+    }
+  }
+
+  void add(const Eigen::Vector2d& point)
+  {
+    int cell = 0;
+    for (int dim = 0; dim < 2; dim++)
+    {
+      int idx = (int)(NbCells * (point(dim) - min(dim)) / (max(dim) - min(dim)));
+      cell = cell * NbCells + std::min(NbCells - 1, std::max(0, idx));
+    }
+    counts[cell]++;
+    nb_points++;
+  }
+
+  double getFrequency(int cell) const
+  {
+    return counts[cell] / (double)nb_points;
+  }
+
+private:
+  Eigen::Vector2d min, max;
+  std::vector<int> counts;
+  int nb_points;
+};
+
+/// Compare the histogram of sampleDiskInBox with the histogram of rejection
+/// sampling and check that all samples are inside the disk and the box
+static void checkUniformity(const Eigen::Vector2d& center, double radius, const Eigen::Matrix<double, 2, 2>& box)
+{
+  std::default_random_engine engine;
+  Histogram sampled(center, radius, box), rejected(center, radius, box);
+  for (int i = 0; i < NbSamples; i++)
+  {
+    Eigen::Vector2d point = sampleDiskInBox(center, radius, box, &engine);
+    ASSERT_LE((point - center).norm(), radius * (1 + 1e-9));
+    ASSERT_LE(box(0, 0), point(0));
+    ASSERT_GE(box(0, 1), point(0));
+    ASSERT_LE(box(1, 0), point(1));
+    ASSERT_GE(box(1, 1), point(1));
+    sampled.add(point);
+  }
+  std::uniform_real_distribution<double> x_distrib(std::max(box(0, 0), center(0) - radius),
+                                                   std::min(box(0, 1), center(0) + radius));
+  std::uniform_real_distribution<double> y_distrib(std::max(box(1, 0), center(1) - radius),
+                                                   std::min(box(1, 1), center(1) + radius));
+  int nb_accepted = 0;
+  while (nb_accepted < NbSamples)
+  {
+    Eigen::Vector2d point(x_distrib(engine), y_distrib(engine));
+    if ((point - center).norm() <= radius)
+    {
+      rejected.add(point);
+      nb_accepted++;
+    }
+  }
+  for (int cell = 0; cell < NbCells * NbCells; cell++)
+  {
+    double p = (sampled.getFrequency(cell) + rejected.getFrequency(cell)) / 2;
+    // Standard error of the difference between two independent frequencies
+    double tolerance = NbStdErrors * std::sqrt(2 * p * (1 - p) / NbSamples);
+    EXPECT_NEAR(rejected.getFrequency(cell), sampled.getFrequency(cell), tolerance) << "cell " << cell;
+  }
+}
+
+TEST(sampleDiskInBox, diskInsideBox)
+{
+  checkUniformity(Eigen::Vector2d(0.5, -0.5), 1, buildBox(-3, 3, -2, 2));
+}
+
+TEST(sampleDiskInBox, clippedOnOneSide)
+{
+  checkUniformity(Eigen::Vector2d(2.5, 0), 1, buildBox(-3, 3, -2, 2));
+  checkUniformity(Eigen::Vector2d(0, -1.8), 1, buildBox(-3, 3, -2, 2));
+}
+
+TEST(sampleDiskInBox, clippedOnTwoSides)
+{
+  // Corner of the box
+  checkUniformity(Eigen::Vector2d(2.5, 1.5), 1, buildBox(-3, 3, -2, 2));
+  // Box narrower than the disk
+  checkUniformity(Eigen::Vector2d(0, 0.2), 1, buildBox(-3, 3, -0.5, 0.5));
+}
+
+TEST(sampleDiskInBox, boxInsideDisk)
+{
+  checkUniformity(Eigen::Vector2d(1, 0), 20, buildBox(-4.5, 4.5, -3, 3));
+}
+
+TEST(sampleDiskInBox, centerOnBoundary)
+{
+  checkUniformity(Eigen::Vector2d(3, -2), 1, buildBox(-3, 3, -2, 2));
+}
+
+TEST(sampleDiskInBox, centerOutsideBox)
+{
+  std::default_random_engine engine;
+  EXPECT_THROW(sampleDiskInBox(Eigen::Vector2d(4, 0), 1, buildBox(-3, 3, -2, 2), &engine), std::logic_error);
+}
+
+TEST(solveIncreasing, newtonConvergesQuickly)
+{
+  auto f = [](double x) { return x * x * x + x; };
+  auto df = [](double x) { return 3 * x * x + 1; };
+  int nb_iter;
+  double x = solveIncreasing(f, df, f(0.7), -2, 3, 1e-12, 100, &nb_iter);
+  EXPECT_NEAR(0.7, x, 1e-10);
+  // Bisection alone would require more than 40 iterations
+  EXPECT_GT(10, nb_iter);
+}
+
+TEST(solveIncreasing, bisectionWhenNewtonLeavesBracket)
+{
+  // Newton iterations on atan diverge when starting far from the root
+  auto f = [](double x) { return std::atan(x); };
+  auto df = [](double x) { return 1 / (1 + x * x); };
+  double x = solveIncreasing(f, df, std::atan(-5), -10, 30, 1e-12, 100);
+  EXPECT_NEAR(-5, x, 1e-9);
+}
+
+TEST(solveIncreasing, bisectionWhenDerivativeIsNull)
+{
+  auto f = [](double x) { return x * x * x; };
+  auto df = [](double x) {
+    (void)x;
+    return 0.0;
+  };
+  int nb_iter;
+  double x = solveIncreasing(f, df, 0.001, -1, 1, 1e-12, 100, &nb_iter);
+  EXPECT_NEAR(0.1, x, 1e-11);
+  // Bisection requires log2(2 / 1e-12) iterations
+  EXPECT_GE(42, nb_iter);
+}
+
+TEST(solveIncreasing, iterationCap)
+{
+  // No tolerance: only the cap stops the iterations
+  auto f = [](double x) { return std::atan(x); };
+  auto df = [](double x) { return 1 / (1 + x * x); };
+  int nb_iter;
+  double x = solveIncreasing(f, df, std::atan(std::sqrt(2)), -10, 30, 0, 5, &nb_iter);
+  EXPECT_EQ(5, nb_iter);
+  EXPECT_LE(-10, x);
+  EXPECT_GE(30, x);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <utils/lazy_approximator.h>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace csa_mdp;
+
+/// Path of the file used as a source by the tests, its content is never read
+static const std::string SourcePath = "lazy_approximator_test.bin";
+
+static void writeSource(const std::string& content)
+{
+  std::ofstream out(SourcePath);
+  out << content;
+}
+
+TEST(getSourceKey, undefinedSource)
+{
+  LazyApproximator approximator;
+  EXPECT_THROW(approximator.getSourceKey(), std::logic_error);
+}
+
+TEST(getSourceKey, fileModifiedInPlace)
+{
+  writeSource("first");
+  LazyApproximator approximator;
+  approximator.setFile(SourcePath);
+  std::string key = approximator.getSourceKey();
+  EXPECT_EQ(key, approximator.getSourceKey());
+  EXPECT_FALSE(approximator.isLoaded());
+  // Size differs even if the modification time has a coarse resolution
+  writeSource("second");
+  EXPECT_NE(key, approximator.getSourceKey());
+  std::remove(SourcePath.c_str());
+}
+
+TEST(getSourceKey, binaryModifiedInPlace)
+{
+  writeSource("first");
+  Json::Value v;
+  v["path"] = SourcePath;
+  LazyApproximator approximator, other;
+  approximator.setBinaryFromPath(v, "");
+  other.setBinaryFromPath(v, "");
+  std::string key = approximator.getSourceKey();
+  EXPECT_EQ(key, other.getSourceKey());
+  EXPECT_FALSE(approximator.isLoaded());
+  writeSource("second");
+  EXPECT_NE(key, approximator.getSourceKey());
+  // Different descriptions lead to different keys
+  v["path"] = "other_" + SourcePath;
+  other.setBinaryFromPath(v, "");
+  EXPECT_NE(approximator.getSourceKey(), other.getSourceKey());
+  std::remove(SourcePath.c_str());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <utils/multilinear_table.h>
+
+#include <cmath>
+#include <cstdio>
+
+#define EPSILON std::pow(10, -9)
+
+using namespace csa_mdp;
+
+/// A function which is linear along each dimension
+static double multilinear(const Eigen::VectorXd& x)
+{
+  return 1 + 2 * x(0) - 3 * x(1) + 0.5 * x(0) * x(1);
+}
+
+static MultilinearTable buildTable()
+{
+  Eigen::MatrixXd limits(3, 2);
+  limits << 0, 1, -1, 1, 2, 2;
+  return MultilinearTable(limits, { 5, 9, 1 });
+}
+
+TEST(getValue, exactOnMultilinearFunctions)
+{
+  MultilinearTable table = buildTable();
+  table.fill(multilinear, 2);
+  std::default_random_engine engine;
+  double max_error, mean_error;
+  table.getError(multilinear, 1000, &engine, &max_error, &mean_error);
+  EXPECT_NEAR(0, max_error, EPSILON);
+  // Points outside of the box are projected
+  Eigen::VectorXd point(3), projected(3);
+  point << 2, -3, 2;
+  projected << 1, -1, 2;
+  EXPECT_FALSE(table.contains(point));
+  EXPECT_NEAR(multilinear(projected), table.getValue(point), EPSILON);
+}
+
+TEST(tryLoad, checksGrid)
+{
+  MultilinearTable table = buildTable();
+  table.fill(multilinear, 1);
+  std::string path = "multilinear_table_test.bin";
+  table.save(path);
+  MultilinearTable loaded = buildTable();
+  EXPECT_TRUE(loaded.tryLoad(path));
+  Eigen::VectorXd point(3);
+  point << 0.3, 0.2, 2;
+  EXPECT_EQ(table.getValue(point), loaded.getValue(point));
+  Eigen::MatrixXd limits(3, 2);
+  limits << 0, 1, -1, 1, 2, 2;
+  MultilinearTable other(limits, { 5, 8, 1 });
+  EXPECT_FALSE(other.tryLoad(path));
+  std::remove(path.c_str());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <utils/ode_integrator.h>
+
+#include <cmath>
+
+using namespace csa_mdp;
+
+/// Harmonic oscillator: x'' = -x, solution from (1, 0) is (cos(t), -sin(t))
+static Eigen::Vector2d oscillator(const Eigen::Vector2d& x)
+{
+  return Eigen::Vector2d(x(1), -x(0));
+}
+
+static OdeIntegrator buildIntegrator(const std::string& method, double step, double tol)
+{
+  Json::Value v;
+  v["method"] = method;
+  v["step"] = step;
+  v["abs_tol"] = tol;
+  v["rel_tol"] = tol;
+  OdeIntegrator integrator;
+  integrator.fromJson(v, "");
+  return integrator;
+}
+
+static double getError(const OdeIntegrator& integrator, double duration, int* nb_evaluations)
+{
+  Eigen::Vector2d x = integrator.integrate<2>(Eigen::Vector2d(1, 0), duration, oscillator, nb_evaluations);
+  return (x - Eigen::Vector2d(std::cos(duration), -std::sin(duration))).cwiseAbs().maxCoeff();
+}
+
+TEST(integrate, fixedStepsCoverDuration)
+{
+  int euler_evaluations = 0;
+  int rk4_evaluations = 0;
+  int exact_evaluations = 0;
+  buildIntegrator("euler", 0.3, 1e-6).integrate<2>(Eigen::Vector2d(1, 0), 1.0, oscillator, &euler_evaluations);
+  buildIntegrator("rk4", 0.3, 1e-6).integrate<2>(Eigen::Vector2d(1, 0), 1.0, oscillator, &rk4_evaluations);
+  buildIntegrator("euler", 0.001, 1e-6).integrate<2>(Eigen::Vector2d(1, 0), 0.1, oscillator, &exact_evaluations);
+  EXPECT_EQ(4, euler_evaluations);
+  EXPECT_EQ(16, rk4_evaluations);
+  // No additional step due to rounding errors
+  EXPECT_EQ(100, exact_evaluations);
+}
+
+TEST(integrate, accuracy)
+{
+  int euler_evaluations = 0;
+  int rk4_evaluations = 0;
+  int rk45_evaluations = 0;
+  double euler_error = getError(buildIntegrator("euler", 0.001, 1e-6), 1.0, &euler_evaluations);
+  double rk4_error = getError(buildIntegrator("rk4", 0.05, 1e-6), 1.0, &rk4_evaluations);
+  double rk45_error = getError(buildIntegrator("rk45", 0.001, 1e-8), 1.0, &rk45_evaluations);
+  EXPECT_NEAR(0, euler_error, 1e-3);
+  EXPECT_NEAR(0, rk4_error, 1e-6);
+  EXPECT_NEAR(0, rk45_error, 1e-6);
+  // Higher order methods are both more accurate and cheaper
+  EXPECT_LT(rk4_error, euler_error);
+  EXPECT_LT(rk45_error, euler_error);
+  EXPECT_LT(10 * rk4_evaluations, euler_evaluations);
+  EXPECT_LT(5 * rk45_evaluations, euler_evaluations);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
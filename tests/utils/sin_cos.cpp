@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+#include <utils/sin_cos.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#define EPSILON std::pow(10, -14)
+
+using namespace csa_mdp;
+
+TEST(sinCos, matchesStd)
+{
+  std::default_random_engine engine;
+  // Includes angles handled by the scalar fallback
+  std::vector<double> x = { 0, M_PI / 4, M_PI / 2, -M_PI, 2e5, 1e-300 };
+  for (double max_angle : { 1.0, 10.0, 1e5 })
+  {
+    std::uniform_real_distribution<double> distrib(-max_angle, max_angle);
+    for (int i = 0; i < 1000; i++)
+    {
+      x.push_back(distrib(engine));
+    }
+  }
+  int n = x.size();
+  std::vector<double> sin_x(n), cos_x(n);
+  sinCos(n, x.data(), sin_x.data(), cos_x.data());
+  for (int i = 0; i < n; i++)
+  {
+    EXPECT_NEAR(std::sin(x[i]), sin_x[i], EPSILON);
+    EXPECT_NEAR(std::cos(x[i]), cos_x[i], EPSILON);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
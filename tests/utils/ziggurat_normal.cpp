@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <utils/ziggurat_normal.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace csa_mdp;
+
+/// Number of samples used for the statistical tests
+static const int NbSamples = 1000000;
+
+/// Tolerance of the statistical tests in number of standard errors, tests are
+/// deterministic since engines are seeded
+static const double NbStdErrors = 5;
+
+static std::vector<double> drawSamples(int n)
+{
+  std::default_random_engine engine;
+  std::vector<double> samples(n);
+  ZigguratNormal::fill(samples.data(), n, &engine);
+  return samples;
+}
+
+TEST(fill, sameAsSuccessiveSamples)
+{
+  int n = 10000;
+  std::default_random_engine batch_engine(1), scalar_engine(1);
+  std::vector<double> samples(n);
+  ZigguratNormal::fill(samples.data(), n, &batch_engine);
+  for (int i = 0; i < n; i++)
+  {
+    EXPECT_EQ(ZigguratNormal::sample(&scalar_engine), samples[i]);
+  }
+  // Engines are left in the same state
+  EXPECT_EQ(scalar_engine(), batch_engine());
+}
+
+TEST(sample, moments)
+{
+  std::vector<double> samples = drawSamples(NbSamples);
+  double sum = 0, sum2 = 0, sum3 = 0, sum4 = 0;
+  for (double x : samples)
+  {
+    double x2 = x * x;
+    sum += x;
+    sum2 += x2;
+    sum3 += x2 * x;
+    sum4 += x2 * x2;
+  }
+  double mean = sum / NbSamples;
+  double variance = sum2 / NbSamples - mean * mean;
+  // Standard errors of the empirical moments of N(0,1): sqrt(Var(x^k) / n)
+  double n_sqrt = std::sqrt(NbSamples);
+  EXPECT_NEAR(0, mean, NbStdErrors * 1 / n_sqrt);
+  EXPECT_NEAR(1, variance, NbStdErrors * std::sqrt(2.0) / n_sqrt);
+  EXPECT_NEAR(0, sum3 / NbSamples, NbStdErrors * std::sqrt(15.0) / n_sqrt);
+  EXPECT_NEAR(3, sum4 / NbSamples, NbStdErrors * std::sqrt(96.0) / n_sqrt);
+}
+
+TEST(sample, tails)
+{
+  std::vector<double> samples = drawSamples(NbSamples);
+  // The last threshold is the start of the tail of the ziggurat, samples
+  // beyond it are drawn by a different method
+  std::vector<double> thresholds = { 1, 2, 3, 3.442619855899, 4 };
+  for (double threshold : thresholds)
+  {
+    int nb_above = 0, nb_below = 0;
+    for (double x : samples)
+    {
+      nb_above += x > threshold ? 1 : 0;
+      nb_below += x < -threshold ? 1 : 0;
+    }
+    // P(X > t) = erfc(t / sqrt(2)) / 2
+    double p = std::erfc(threshold / std::sqrt(2.0)) / 2;
+    double tolerance = NbStdErrors * std::sqrt(p * (1 - p) / NbSamples);
+    EXPECT_NEAR(p, nb_above / (double)NbSamples, tolerance) << "threshold: " << threshold;
+    EXPECT_NEAR(p, nb_below / (double)NbSamples, tolerance) << "threshold: -" << threshold;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}